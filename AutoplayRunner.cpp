@@ -0,0 +1,357 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "AutoplayRunner.h"
+#include "HeadlessGame.h"
+#include "LevelLoader.h"
+#include "LevelPack.h"
+#include "Riddle.h"
+#include "Room.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+//////////////////////////////////////////          helpers           //////////////////////////////////////////
+
+static const Action MOVES[] = {Action::MOVE_UP, Action::MOVE_DOWN, Action::MOVE_LEFT, Action::MOVE_RIGHT};
+
+static Action actionFor(Direction dir)
+{
+    switch (dir)
+    {
+    case Direction::UP: return Action::MOVE_UP;
+    case Direction::DOWN: return Action::MOVE_DOWN;
+    case Direction::LEFT: return Action::MOVE_LEFT;
+    case Direction::RIGHT: return Action::MOVE_RIGHT;
+    default: return Action::STAY;
+    }
+}
+
+// The action whose key the player is currently "holding"
+static Action currentAction(const Player &player)
+{
+    Point pos = player.getPosition();
+    if (pos.getDiffX() > 0) return Action::MOVE_RIGHT;
+    if (pos.getDiffX() < 0) return Action::MOVE_LEFT;
+    if (pos.getDiffY() > 0) return Action::MOVE_DOWN;
+    if (pos.getDiffY() < 0) return Action::MOVE_UP;
+    return Action::STAY;
+}
+
+//////////////////////////////////////////         AutoPilot          //////////////////////////////////////////
+
+AutoPilot::AutoPilot(std::mt19937 &random)
+    : rng(random), lastPosition(-1, -1), stuckTicks(0), wanderAction(Action::STAY), wanderTicks(0)
+{
+}
+
+// A random heading, kept for a little while like a person trying a way round
+Action AutoPilot::wander()
+{
+    if (wanderTicks <= 0)
+    {
+        wanderAction = MOVES[rng() % 4];
+        wanderTicks = 5 + static_cast<int>(rng() % 20);
+    }
+    wanderTicks--;
+    return wanderAction;
+}
+
+// The neighbouring step that gets furthest from a lit bomb; STAY when none does
+static Action fleeFrom(Room &room, int x, int y)
+{
+    static const int STEP_X[] = {0, 0, -1, 1};
+    static const int STEP_Y[] = {-1, 1, 0, 0};
+
+    int best = room.distanceTo(NavTarget::BLAST, x, y);
+    Action flee = Action::STAY;
+    for (int d = 0; d < 4; d++)
+    {
+        int around = room.distanceTo(NavTarget::BLAST, x + STEP_X[d], y + STEP_Y[d]);
+        if (around > best)
+        {
+            best = around;
+            flee = MOVES[d];
+        }
+    }
+    return flee;
+}
+
+bool AutoPilot::decide(Room &room, const Player &self, const Player &partner, Action &action)
+{
+    // Mid-launch input only nudges the flight, and a player at the open exit just waits
+    if (!self.isAlive() || self.isLaunched()) return false;
+
+    int x = self.getX(), y = self.getY();
+    Action want = Action::STAY;
+    bool drop = false;
+
+    if (!self.isWaitingAtDoor())
+    {
+        bool moved = x != lastPosition.getX() || y != lastPosition.getY();
+        stuckTicks = (moved || currentAction(self) == Action::STAY) ? 0 : stuckTicks + 1;
+
+        int exitId = room.getNextRoomId();
+        int keysShort = room.isDoorUnlocked(exitId) ? 0
+                        : room.getDoorRequiredKeys(exitId) - self.getKeyCount() - partner.getKeyCount();
+        auto reachable = [&](NavTarget target) { return room.distanceTo(target, x, y) != DistanceField::UNREACHABLE; };
+
+        int blast = room.distanceTo(NavTarget::BLAST, x, y);
+        NavTarget goal = NavTarget::COUNT;
+
+        if (blast != DistanceField::UNREACHABLE)
+        {
+            // A lit bomb: get well clear of it, then wait for the walls it opens
+            want = blast <= FLEE_DISTANCE ? fleeFrom(room, x, y) : Action::STAY;
+        }
+        else if (keysShort > 0 && !self.hasKey() && reachable(NavTarget::KEY))
+        {
+            // One item at a time: whatever else is carried has to go first
+            if (self.hasItem()) drop = true;
+            goal = NavTarget::KEY;
+        }
+        else if (reachable(NavTarget::SWITCH)) goal = NavTarget::SWITCH;
+        else if (reachable(NavTarget::EXIT)) goal = NavTarget::EXIT;
+        else if (self.hasBomb() && reachable(NavTarget::BREAKABLE))
+        {
+            // Nothing left on this side: blow a way through
+            if (room.distanceTo(NavTarget::BREAKABLE, x, y) <= 1) drop = true;
+            goal = NavTarget::BREAKABLE;
+        }
+        else if (!self.hasKey() && reachable(NavTarget::BOMB) && reachable(NavTarget::BREAKABLE))
+        {
+            if (self.hasItem()) drop = true;
+            goal = NavTarget::BOMB;
+        }
+        else if (reachable(NavTarget::OBSTACLE)) goal = NavTarget::OBSTACLE; // walks on into it: a push
+
+        if (drop)
+        {
+            action = Action::DROP_ITEM;
+            lastPosition = self.getPosition();
+            return true;
+        }
+
+        if (goal != NavTarget::COUNT)
+        {
+            if (stuckTicks > 8 || wanderTicks > 0)
+            {
+                if (stuckTicks > 8) stuckTicks = 0;
+                want = wander();
+            }
+            else want = actionFor(room.directionTo(goal, x, y));
+        }
+        else if (blast == DistanceField::UNREACHABLE) want = wander();
+    }
+
+    lastPosition = self.getPosition();
+    if (want == currentAction(self)) return false;
+
+    action = want;
+    return true;
+}
+
+//////////////////////////////////////////        AutoplayGame        //////////////////////////////////////////
+
+// Both players on AutoPilot. Every key it presses and every riddle answer goes into the
+// steps, and the events a result file needs are kept, exactly as NormalGame records them.
+class AutoplayGame : public HeadlessGame
+{
+    std::mt19937 rng;
+    AutoPilot pilot1, pilot2;
+    RecordedSteps steps;
+    int furthestRoom;
+
+protected:
+    void reportScreenChange(int roomId) override
+    {
+        HeadlessGame::reportScreenChange(roomId);
+        furthestRoom = std::max(furthestRoom, roomId);
+    }
+
+    // The answer from the riddle database, recorded the way a typed one is
+    int getRiddleInput(unsigned long cycle) override
+    {
+        const RiddleData *data = aRiddle.riddle != nullptr ? context.riddles.getRiddle(aRiddle.riddle->getRiddleId()) : nullptr;
+        if (data == nullptr) return -1;
+
+        int playerId = aRiddle.player != nullptr ? aRiddle.player->getId() : 1;
+        steps.addAction(ActionRecord(cycle, playerId, data->correctAnswerIndex));
+        return data->correctAnswerIndex;
+    }
+
+public:
+    AutoplayGame(const std::string &dataDir, unsigned int seed)
+        : HeadlessGame(dataDir), rng(seed), pilot1(rng), pilot2(rng), steps(), furthestRoom(0)
+    {
+        steps.setRandomSeed(rng() % 1000000 + 1);
+        for (const std::string &name : LevelLoader::discoverLevelFiles(dataDir)) steps.addScreenName(name);
+    }
+
+    // NormalGame::handleInput with the pilots at the keyboard
+    void handleInput() override
+    {
+        Room *room = getCurrentRoom();
+        if (room == nullptr) return;
+
+        Action action;
+        if (pilot1.decide(*room, player1, player2, action)) press(player1, action, room);
+        if (pilot2.decide(*room, player2, player1, action)) press(player2, action, room);
+    }
+
+    void press(Player &player, Action action, Room *room)
+    {
+        PlayerKeyBinding binding{0, player.getId(), action};
+        steps.addAction(ActionRecord(cycleCount, binding));
+        player.performAction(action, room);
+    }
+
+    // Returns how the game ended
+    std::string play(unsigned long maxCycles)
+    {
+        GameContext::Scope bind(context);
+
+        if (!begin(steps.getRandomSeed())) return "could not load the level files";
+
+        while (currentState == GameState::inGame && cycleCount < maxCycles)
+        {
+            handleInput();
+            update();
+        }
+
+        if (currentState == GameState::victory) return "victory";
+        if (currentState == GameState::gameOver) return "game over";
+
+        reportQuit();
+        return "stopped";
+    }
+
+    const RecordedSteps &getSteps() const { return steps; }
+    int getFurthestRoom() const { return furthestRoom; }
+};
+
+//////////////////////////////////////////        Constructor         //////////////////////////////////////////
+
+AutoplayRunner::AutoplayRunner(const std::string &data, const std::string &out, size_t runCount,
+                               unsigned long cycleCount, size_t threadCount, unsigned int seed)
+    : dataDir(data), outDir(out), runs(runCount), threads(threadCount), cycles(cycleCount),
+      baseSeed(seed), results(), totalWallMs(0.0)
+{
+}
+
+//////////////////////////////////////////           runOne           //////////////////////////////////////////
+
+void AutoplayRunner::runOne(AutoplayRun &run) const
+{
+    AutoplayGame game(dataDir, run.seed);
+    try
+    {
+        run.details = game.play(cycles);
+    }
+    catch (const std::exception &e)
+    {
+        run.details = std::string("exception: ") + e.what();
+    }
+
+    run.ticks = game.getCycleCount();
+    run.actions = game.getSteps().getActionCount();
+    run.furthestRoom = game.getFurthestRoom();
+    run.won = run.details == "victory";
+    run.savedTo = saveRun(run, game.getSteps(), game.getEvents());
+}
+
+//////////////////////////////////////////          saveRun           //////////////////////////////////////////
+
+// A self-contained folder: steps, results, and the level files and riddles they ran against
+std::string AutoplayRunner::saveRun(const AutoplayRun &run, const RecordedSteps &steps,
+                                    const std::vector<GameEvent> &events) const
+{
+    fs::path dir = fs::path(outDir) / ("autoplay-" + std::to_string(run.seed));
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec) return "";
+
+    std::vector<std::string> dataFiles = LevelLoader::discoverLevelFiles(dataDir);
+    dataFiles.push_back("riddle.txt");
+    dataFiles.push_back(LevelPack::FILE_NAME); // if there is one; copied last so it stays newer
+    for (const std::string &name : dataFiles)
+        fs::copy_file(LevelLoader::pathIn(dataDir, name), dir / name, fs::copy_options::overwrite_existing, ec);
+
+    if (steps.saveToFile((dir / "adv-world.steps.txt").string(), RecordingFormat::TEXT) != ErrorCode::NONE) return "";
+    if (saveGameEvents((dir / "adv-world.result.txt").string(), events, RecordingFormat::TEXT) != ErrorCode::NONE) return "";
+
+    return dir.string();
+}
+
+//////////////////////////////////////////            run             //////////////////////////////////////////
+
+void AutoplayRunner::run()
+{
+    std::error_code ec;
+    fs::create_directories(outDir, ec);
+
+    results = std::vector<AutoplayRun>(runs);
+    for (size_t i = 0; i < runs; i++) results[i].seed = baseSeed + static_cast<unsigned int>(i);
+
+    auto start = std::chrono::steady_clock::now();
+
+    WorkStealingPool pool(threads);
+    pool.run(results.size(), [this](size_t i) { runOne(results[i]); });
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    totalWallMs = std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+//////////////////////////////////////////        runFromArgs         //////////////////////////////////////////
+
+int AutoplayRunner::runFromArgs(int argc, char *argv[])
+{
+    size_t runCount = 1;
+    unsigned long cycleCount = 20000;
+    size_t threadCount = 0;
+    unsigned int seed = std::random_device{}();
+    std::string outDir = "autoplay-out";
+
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        std::string arg(argv[i]);
+        if (arg == "-runs") runCount = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "-cycles") cycleCount = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "-threads") threadCount = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "-seed") seed = static_cast<unsigned int>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (arg == "-out") outDir = argv[i + 1];
+    }
+
+    if (LevelLoader::discoverLevelFiles(".").empty())
+    {
+        std::cout << "No level files found in the current directory" << std::endl;
+        return 1;
+    }
+
+    AutoplayRunner runner(".", outDir, runCount, cycleCount, threadCount, seed);
+    runner.run();
+
+    unsigned long ticks = 0;
+    size_t won = 0, broken = 0;
+    for (const AutoplayRun &r : runner.getRuns())
+    {
+        ticks += r.ticks;
+        if (r.won) won++;
+        if (r.savedTo.empty() || r.details.rfind("exception", 0) == 0 || r.details.rfind("could not", 0) == 0) broken++;
+        std::cout << "seed " << r.seed << ": " << r.details << " at cycle " << r.ticks << ", room " << r.furthestRoom
+                  << ", " << r.actions << " actions";
+        if (!r.savedTo.empty()) std::cout << ", saved to " << r.savedTo;
+        std::cout << std::endl;
+    }
+
+    double seconds = runner.getWallMs() / 1000.0;
+    std::cout << runner.getRuns().size() << " runs from seed " << seed << ", " << ticks << " ticks in "
+              << seconds << " s (" << static_cast<unsigned long>(seconds > 0 ? ticks / seconds : 0)
+              << " ticks/s), " << won << " won" << std::endl;
+    return broken == 0 ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Constants.h"
+#include "Point.h"
+#include "Recorder.h"
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+class Player;
+class Room;
+
+//////////////////////////////////////////         AutoPilot          //////////////////////////////////////////
+
+// Plays one player from the room's distance fields: fetch the keys the exit still needs,
+// turn on every switch that is off, then walk to the exit and wait there for the partner.
+// Riddles on the way are entered and answered by the game. When none of that is reachable
+// it carries a bomb to a breakable wall and runs from the blast, or walks into the nearest
+// obstacle to push it; when the player stops moving it wanders for a while.
+class AutoPilot
+{
+    static const int FLEE_DISTANCE = 12; // steps; the blast reaches 5 cells in a straight line
+
+    std::mt19937 &rng;
+    Point lastPosition;
+    int stuckTicks;
+    Action wanderAction;
+    int wanderTicks;
+
+    Action wander();
+
+public:
+    explicit AutoPilot(std::mt19937 &random);
+
+    // The key the player would press this tick; false when none is needed
+    bool decide(Room &room, const Player &self, const Player &partner, Action &action);
+};
+
+//////////////////////////////////////////        AutoplayRun         //////////////////////////////////////////
+
+struct AutoplayRun
+{
+    unsigned int seed;
+    unsigned long ticks;
+    size_t actions;
+    int furthestRoom;
+    bool won;
+    std::string details; // how the game ended
+    std::string savedTo;
+
+    AutoplayRun() : seed(0), ticks(0), actions(0), furthestRoom(0), won(false) {}
+};
+
+//////////////////////////////////////////       AutoplayRunner       //////////////////////////////////////////
+
+// -autoplay [-runs N] [-cycles N] [-threads N] [-seed S] [-out dir]: both players driven by
+// AutoPilot, headless and as fast as the simulation goes, through the level files in the
+// current directory. Every run is saved as out/autoplay-<seed>/, a folder
+// `game -load -silent` replays as is.
+class AutoplayRunner
+{
+    std::string dataDir;
+    std::string outDir;
+    size_t runs;
+    size_t threads;
+    unsigned long cycles;
+    unsigned int baseSeed;
+
+    std::vector<AutoplayRun> results;
+    double totalWallMs;
+
+    void runOne(AutoplayRun &run) const;
+    std::string saveRun(const AutoplayRun &run, const RecordedSteps &steps, const std::vector<GameEvent> &events) const;
+
+public:
+    AutoplayRunner(const std::string &data, const std::string &out, size_t runCount,
+                   unsigned long cycleCount, size_t threadCount, unsigned int seed);
+
+    void run();
+
+    const std::vector<AutoplayRun> &getRuns() const { return results; }
+    double getWallMs() const { return totalWallMs; }
+
+    // Exit status: 0 when every run played out and was saved, whether or not it won;
+    // 1 when one threw, could not load the levels or could not be saved
+    static int runFromArgs(int argc, char *argv[]);
+};
@@ -0,0 +1,225 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "BatchRunner.h"
+#include "LoadedGame.h"
+#include "Recorder.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+//////////////////////////////////////////          helpers           //////////////////////////////////////////
+
+static std::string escapeJson(const std::string &text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\') { escaped += '\\'; escaped += c; }
+        else if (c == '\n') escaped += "\\n";
+        else if (static_cast<unsigned char>(c) < 0x20) escaped += ' ';
+        else escaped += c;
+    }
+    return escaped;
+}
+
+static std::string escapeXml(const std::string &text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '<') escaped += "&lt;";
+        else if (c == '>') escaped += "&gt;";
+        else if (c == '&') escaped += "&amp;";
+        else if (c == '"') escaped += "&quot;";
+        else escaped += c;
+    }
+    return escaped;
+}
+
+//////////////////////////////////////////        Constructor         //////////////////////////////////////////
+
+BatchRunner::BatchRunner(const std::string &dir, size_t threadCount)
+    : rootDir(dir), threads(threadCount), cases(), totalWallMs(0.0)
+{
+}
+
+//////////////////////////////////////////          discover          //////////////////////////////////////////
+
+// A case is any *.steps* file with a matching *.result* file next to it
+void BatchRunner::discover()
+{
+    cases.clear();
+
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(rootDir, ec), end; it != end; it.increment(ec))
+    {
+        if (ec) break;
+        if (!it->is_regular_file()) continue;
+
+        std::string filename = it->path().filename().string();
+        std::string resultName = resultFileFor(filename);
+        if (resultName.empty()) continue;
+
+        fs::path dir = it->path().parent_path();
+        if (!fs::exists(dir / resultName)) continue;
+
+        BatchCase testCase;
+        testCase.dataDir = dir.string();
+        testCase.stepsFile = it->path().string();
+        testCase.resultFile = (dir / resultName).string();
+        testCase.name = it->path().lexically_relative(rootDir).string();
+        cases.push_back(testCase);
+    }
+
+    // Directory order is unspecified; keep reports stable between runs
+    std::sort(cases.begin(), cases.end(),
+              [](const BatchCase &a, const BatchCase &b) { return a.name < b.name; });
+}
+
+//////////////////////////////////////////          runCase           //////////////////////////////////////////
+
+void BatchRunner::runCase(BatchCase &testCase) const
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::ostringstream sink;
+    LoadedGame game(testCase.stepsFile, testCase.resultFile, testCase.dataDir, true);
+    game.setOutput(sink);
+    game.enableStallGuard();
+    game.run();
+
+    testCase.passed = game.hasPassed();
+    testCase.details = game.getFailureDetails();
+    testCase.ticks = game.getCycleCount();
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    testCase.wallMs = std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+//////////////////////////////////////////            run             //////////////////////////////////////////
+
+size_t BatchRunner::run()
+{
+    discover();
+
+    auto start = std::chrono::steady_clock::now();
+
+    WorkStealingPool pool(threads);
+    pool.run(cases.size(), [this](size_t i) { runCase(cases[i]); });
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    totalWallMs = std::chrono::duration<double, std::milli>(elapsed).count();
+
+    return std::count_if(cases.begin(), cases.end(), [](const BatchCase &c) { return !c.passed; });
+}
+
+//////////////////////////////////////////         writeJson          //////////////////////////////////////////
+
+void BatchRunner::writeJson(std::ostream &out) const
+{
+    size_t failed = std::count_if(cases.begin(), cases.end(), [](const BatchCase &c) { return !c.passed; });
+
+    out << "{\n";
+    out << "  \"root\": \"" << escapeJson(rootDir) << "\",\n";
+    out << "  \"total\": " << cases.size() << ",\n";
+    out << "  \"passed\": " << cases.size() - failed << ",\n";
+    out << "  \"failed\": " << failed << ",\n";
+    out << "  \"wall_ms\": " << totalWallMs << ",\n";
+    out << "  \"cases\": [";
+
+    for (size_t i = 0; i < cases.size(); i++)
+    {
+        const BatchCase &c = cases[i];
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    {\"name\": \"" << escapeJson(c.name) << "\", "
+            << "\"passed\": " << (c.passed ? "true" : "false") << ", "
+            << "\"ticks\": " << c.ticks << ", "
+            << "\"wall_ms\": " << c.wallMs << ", "
+            << "\"details\": \"" << escapeJson(c.details) << "\"}";
+    }
+
+    out << "\n  ]\n}\n";
+}
+
+//////////////////////////////////////////         writeJUnit         //////////////////////////////////////////
+
+void BatchRunner::writeJUnit(std::ostream &out) const
+{
+    size_t failed = std::count_if(cases.begin(), cases.end(), [](const BatchCase &c) { return !c.passed; });
+
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    out << "<testsuite name=\"" << escapeXml(rootDir) << "\" tests=\"" << cases.size()
+        << "\" failures=\"" << failed << "\" time=\"" << totalWallMs / 1000.0 << "\">\n";
+
+    for (const BatchCase &c : cases)
+    {
+        out << "  <testcase name=\"" << escapeXml(c.name) << "\" time=\"" << c.wallMs / 1000.0 << "\">";
+        out << "<properties><property name=\"ticks\" value=\"" << c.ticks << "\"/></properties>";
+        if (!c.passed)
+            out << "<failure message=\"" << escapeXml(c.details) << "\"/>";
+        out << "</testcase>\n";
+    }
+
+    out << "</testsuite>\n";
+}
+
+//////////////////////////////////////////        writeReport         //////////////////////////////////////////
+
+// Empty or "-" writes JSON to stdout
+bool BatchRunner::writeReport(const std::string &reportFile) const
+{
+    if (reportFile.empty() || reportFile == "-")
+    {
+        writeJson(std::cout);
+        return true;
+    }
+
+    std::ofstream file(reportFile);
+    if (!file.is_open()) return false;
+
+    bool xml = reportFile.size() >= 4 && reportFile.substr(reportFile.size() - 4) == ".xml";
+    if (xml) writeJUnit(file);
+    else writeJson(file);
+
+    return file.good();
+}
+
+//////////////////////////////////////////        runFromArgs         //////////////////////////////////////////
+
+int BatchRunner::runFromArgs(int argc, char *argv[], int dirIndex)
+{
+    if (dirIndex >= argc)
+    {
+        std::cout << "Usage: game -batch <dir> [-threads N] [-report file.json|file.xml]" << std::endl;
+        return 1;
+    }
+
+    size_t threadCount = 0;
+    std::string reportFile;
+
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        std::string arg(argv[i]);
+        if (arg == "-threads") threadCount = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "-report") reportFile = argv[i + 1];
+    }
+
+    BatchRunner runner(argv[dirIndex], threadCount);
+    size_t failed = runner.run();
+
+    bool written = runner.writeReport(reportFile);
+    if (!written) std::cout << "Could not write " << reportFile << std::endl;
+
+    if (!reportFile.empty() && reportFile != "-")
+        std::cout << runner.getCases().size() - failed << "/" << runner.getCases().size()
+                  << " recordings passed" << std::endl;
+
+    return failed == 0 && written ? 0 : 1;
+}
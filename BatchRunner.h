@@ -0,0 +1,58 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////        BatchCase           //////////////////////////////////////////
+
+// One recorded run: a steps file, its expected results, and the directory
+// holding the screens and riddle.txt it was recorded against
+struct BatchCase
+{
+    std::string name;
+    std::string dataDir;
+    std::string stepsFile;
+    std::string resultFile;
+
+    bool passed;
+    std::string details;
+    unsigned long ticks;
+    double wallMs;
+
+    BatchCase() : passed(false), ticks(0), wallMs(0.0) {}
+};
+
+//////////////////////////////////////////        BatchRunner         //////////////////////////////////////////
+
+// -batch <dir> [-threads N] [-report file]: replays every recording found under dir
+// in parallel and writes a JSON report (JUnit XML when the report file ends in .xml)
+class BatchRunner
+{
+    std::string rootDir;
+    size_t threads;
+    std::vector<BatchCase> cases;
+    double totalWallMs;
+
+    void discover();
+    void runCase(BatchCase &testCase) const;
+
+    void writeJson(std::ostream &out) const;
+    void writeJUnit(std::ostream &out) const;
+
+public:
+    explicit BatchRunner(const std::string &dir, size_t threadCount = 0);
+
+    // Returns the number of failed cases
+    size_t run();
+    bool writeReport(const std::string &reportFile) const;
+
+    const std::vector<BatchCase> &getCases() const { return cases; }
+
+    // Exit status: 0 when every recording passed and the report was written, 1 otherwise
+    // (or on bad usage)
+    static int runFromArgs(int argc, char *argv[], int dirIndex);
+};
@@ -4,6 +4,7 @@
 #include "Room.h"
 #include "Player.h"
 #include "Renderer.h"
+#include "Snapshot.h"
 #include <cmath>
 
 //////////////////////////////////////////        activate           //////////////////////////////////////////
@@ -53,7 +54,7 @@ ExplosionResult Bomb::explode(Player *p1, Player *p2)
     int centerY = getY();
 
     currentRoom->setCharAt(centerX, centerY, ' ');
-    Renderer::printAt(centerX, centerY, ' ');
+    Renderer::printCell(centerX, centerY, ' ');
     explosionCells.push_back(Point(centerX, centerY));
 
     for (int dy = -EXPLOSION_RADIUS; dy <= EXPLOSION_RADIUS; dy++)
@@ -63,7 +64,7 @@ ExplosionResult Bomb::explode(Player *p1, Player *p2)
             int x = centerX + dx;
             int y = centerY + dy;
 
-            if (x < 0 || x >= MAX_X || y < 0 || y >= MAX_Y)
+            if (!currentRoom->isInside(x, y))
                 continue;
 
             double distance = sqrt(dx * dx + dy * dy);
@@ -97,7 +98,7 @@ ExplosionResult Bomb::explode(Player *p1, Player *p2)
                 if (obj->onExplosion())
                 {
                     currentRoom->setCharAt(x, y, ' ');
-                    Renderer::printAt(x, y, ' ');
+                    Renderer::printCell(x, y, ' ');
                     explosionCells.push_back(Point(x, y));
                     obj->setActive(false);
                     result.objectsDestroyed++;
@@ -106,7 +107,7 @@ ExplosionResult Bomb::explode(Player *p1, Player *p2)
             else if (type == ObjectType::BREAKABLE_WALL)
             {
                 currentRoom->setCharAt(x, y, ' ');
-                Renderer::printAt(x, y, ' ');
+                Renderer::printCell(x, y, ' ');
                 explosionCells.push_back(Point(x, y));
                 result.objectsDestroyed++;
             }
@@ -114,7 +115,7 @@ ExplosionResult Bomb::explode(Player *p1, Player *p2)
             else if (type != ObjectType::WALL)
             {
                 currentRoom->setCharAt(x, y, ' ');
-                Renderer::printAt(x, y, ' ');
+                Renderer::printCell(x, y, ' ');
                 explosionCells.push_back(Point(x, y));
                 result.objectsDestroyed++;
             }
@@ -131,12 +132,14 @@ ExplosionResult Bomb::explode(Player *p1, Player *p2)
 
 void Bomb::draw() const
 {
+    if (!Renderer::shouldRender()) return;
+
     if (!active || state == BombState::IN_INVENTORY) return;
 
     if (state == BombState::PLACED && currentRoom 
         && !currentRoom->isVisible(getX(), getY())) return;
 
-    Renderer::gotoxy(getX(), getY());
+    if (!Renderer::gotoCell(getX(), getY())) return;
 
     if (state == BombState::TICKING)
     {
@@ -164,3 +167,23 @@ void Bomb::draw() const
 //////////////////////////////////////////       isPickable          //////////////////////////////////////////
 
 bool Bomb::isPickable() const { return (state == BombState::PLACED); }
+
+//////////////////////////////////////////    saveState / loadState    //////////////////////////////////////////
+
+void Bomb::saveState(StateWriter &out) const
+{
+    GameObject::saveState(out);
+    out.writeEnum(state);
+    out.writeInt(fuseTimer);
+    out.writeInt(blinkCounter);
+}
+
+// Only activate() sets the room, so a restored TICKING bomb is re-attached by the Room holding it
+void Bomb::loadState(StateReader &in)
+{
+    GameObject::loadState(in);
+    state = in.readEnum<BombState>();
+    fuseTimer = static_cast<int>(in.readInt());
+    blinkCounter = static_cast<int>(in.readInt());
+    currentRoom = nullptr;
+}
@@ -78,4 +78,9 @@ public:
     using GameObject::update;
     ExplosionResult update(Player *p1, Player *p2);
     BombState getState() const { return state; }
+
+    // The room pointer is not serialized: the owning Room re-attaches ticking bombs
+    void saveState(StateWriter &out) const override;
+    void loadState(StateReader &in) override;
+    void attachRoom(Room *room) { currentRoom = room; }
 };
\ No newline at end of file
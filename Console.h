@@ -25,19 +25,25 @@
 #include <cstdlib>
 #include <sys/select.h>
 #include <cstdio>
+#include <mutex>
 #endif
 
 // Unix terminal management
+// There is one terminal per process, so this state is shared (inline, not one copy
+// per translation unit) and reference counted across games that initialize it.
 #ifdef PLATFORM_UNIX
 namespace ConsoleInternal
 {
-    static struct termios orig_termios;
-    static bool terminal_initialized = false;
-    static bool terminal_saved = false;
+    inline struct termios orig_termios;
+    inline bool terminal_initialized = false;
+    inline bool terminal_saved = false;
+    inline int terminal_users = 0;
+    inline std::mutex terminal_mutex;
 }
 
 inline void restore_terminal()
 {
+    std::lock_guard<std::mutex> lock(ConsoleInternal::terminal_mutex);
     if (ConsoleInternal::terminal_initialized && ConsoleInternal::terminal_saved)
     {
         tcsetattr(STDIN_FILENO, TCSANOW, &ConsoleInternal::orig_termios);
@@ -50,10 +56,12 @@ inline void restore_terminal()
 
 inline void init_terminal()
 {
+    std::lock_guard<std::mutex> lock(ConsoleInternal::terminal_mutex);
+    ConsoleInternal::terminal_users++;
     if (!ConsoleInternal::terminal_initialized)
     {
-        // Save original terminal settings
-        if (tcgetattr(STDIN_FILENO, &ConsoleInternal::orig_termios) == 0)
+        // Save original terminal settings (once per process)
+        if (!ConsoleInternal::terminal_saved && tcgetattr(STDIN_FILENO, &ConsoleInternal::orig_termios) == 0)
         {
             ConsoleInternal::terminal_saved = true;
             atexit(restore_terminal);
@@ -77,13 +85,14 @@ inline void init_terminal()
 #endif
 
 // Clear screen
-inline void clrscr()
+inline void clrscr(std::ostream &out = std::cout)
 {
 #ifdef PLATFORM_WINDOWS
+    (void)out;
     system("cls");
 #else
-    std::cout << "\033[2J\033[H";
-    std::cout.flush();
+    out << "\033[2J\033[H";
+    out.flush();
 #endif
 }
 
@@ -118,9 +127,10 @@ inline void showCursor()
 }
 
 // Move cursor to position
-inline void gotoxy(int x, int y)
+inline void gotoxy(int x, int y, std::ostream &out = std::cout)
 {
 #ifdef PLATFORM_WINDOWS
+    (void)out;
 
     HANDLE hConsoleOutput;
     COORD dwCursorPosition;
@@ -130,7 +140,7 @@ inline void gotoxy(int x, int y)
     SetConsoleCursorPosition(hConsoleOutput, dwCursorPosition);
 #else
 
-    std::cout << "\033[" << (y + 1) << ";" << (x + 1) << "H";
+    out << "\033[" << (y + 1) << ";" << (x + 1) << "H";
 #endif
 }
 
@@ -209,10 +219,15 @@ inline void init_console()
 #endif
 }
 
-// Cleanup console
+// Cleanup console (the terminal is restored once its last user is done)
 inline void cleanup_console()
 {
 #ifdef PLATFORM_UNIX
+    {
+        std::lock_guard<std::mutex> lock(ConsoleInternal::terminal_mutex);
+        if (ConsoleInternal::terminal_users > 0) ConsoleInternal::terminal_users--;
+        if (ConsoleInternal::terminal_users > 0) return;
+    }
     restore_terminal();
 #endif
 }
@@ -238,14 +253,16 @@ enum class Color
     BrightWhite
 };
 
-// Forward declaration for OOP color mode access
-class Game;
-
-// Declared in Game.cpp, allows Console functions to query color state
+// Defined in GameContext.cpp: color mode and output sink of the game bound to this thread
 bool isGameColorEnabled();
+std::ostream &gameOutput();
 
 inline void set_color(Color color)
 {
+#ifdef HEADLESS_BUILD
+    (void)color;
+    return;
+#endif
     if (!isGameColorEnabled()) return;
 #ifdef PLATFORM_WINDOWS
     HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
@@ -256,12 +273,15 @@ inline void set_color(Color color)
         "\033[31m", "\033[35m", "\033[33m", "\033[37m",
         "\033[90m", "\033[94m", "\033[92m", "\033[96m",
         "\033[91m", "\033[95m", "\033[93m", "\033[97m"};
-    std::cout << colors[static_cast<int>(color)];
+    gameOutput() << colors[static_cast<int>(color)];
 #endif
 }
 
 inline void reset_color()
 {
+#ifdef HEADLESS_BUILD
+    return;
+#endif
     if (!isGameColorEnabled()) return;
     set_color(Color::White);
 }
@@ -3,12 +3,23 @@
 #include <string_view>
 //////////////////////////////////////////      SCREEN DIMENSIONS       /////////////////////////////////////////////
 
+// The console: menus fill it, and rooms are seen through a view of this size.
+// Rooms themselves may be larger (see Screen and Room)
 enum ScreenSize
 {
   MAX_X = 80,
   MAX_Y = 25,
 };
 
+// Rooms keep their per-cell state in CHUNK_SIZE x CHUNK_SIZE tiles. Each tick only
+// the chunks within ACTIVE_MARGIN cells of a view around either player simulate
+enum RoomTiling
+{
+  CHUNK_SIZE = 16,
+  ACTIVE_MARGIN = 16,
+  MAX_ROOM_SIZE = 4096
+};
+
 //////////////////////////////////////////         GAME STATES       /////////////////////////////////////////////
 
 enum class GameState
@@ -169,5 +180,6 @@ enum class ErrorCode
   NO_SCREENS_FOUND,
   MISSING_RANDOM_SEED,
   SCREEN_MISMATCH,
-  RESULT_MISMATCH
+  RESULT_MISMATCH,
+  BAD_KEYFRAME
 };
@@ -0,0 +1,146 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "DistanceField.h"
+#include <algorithm>
+#include <utility>
+
+static const int STEP_X[] = {0, 0, -1, 1};
+static const int STEP_Y[] = {-1, 1, 0, 0};
+static const Direction STEP_DIR[] = {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT};
+
+//////////////////////////////////////////          compute           //////////////////////////////////////////
+
+void DistanceField::compute(int roomWidth, int roomHeight, const std::vector<Point> &sources, const Passable &passable)
+{
+    width = roomWidth;
+    height = roomHeight;
+    distance.assign(static_cast<size_t>(width) * height, UNREACHABLE);
+    valid = true;
+
+    std::vector<Point> frontier;
+    for (const Point &source : sources)
+    {
+        int x = source.getX(), y = source.getY();
+        if (x < 0 || x >= width || y < 0 || y >= height) continue;
+
+        int &cell = distance[static_cast<size_t>(y) * width + x];
+        if (cell == 0) continue;
+        cell = 0;
+        frontier.push_back(source);
+    }
+
+    spread(frontier, passable);
+}
+
+//////////////////////////////////////////          openCell          //////////////////////////////////////////
+
+void DistanceField::openCell(int x, int y, const Passable &passable)
+{
+    if (!valid || x < 0 || x >= width || y < 0 || y >= height) return;
+
+    int &cell = distance[static_cast<size_t>(y) * width + x];
+    int best = cell;
+    for (int d = 0; d < 4; d++)
+    {
+        int around = at(x + STEP_X[d], y + STEP_Y[d]);
+        if (around != UNREACHABLE && (best == UNREACHABLE || around + 1 < best)) best = around + 1;
+    }
+    if (best == cell) return;
+
+    cell = best;
+    std::vector<Point> frontier{Point(x, y)};
+    spread(frontier, passable);
+}
+
+//////////////////////////////////////////         closeCell          //////////////////////////////////////////
+
+void DistanceField::closeCell(int x, int y, const Passable &passable)
+{
+    if (!valid || x < 0 || x >= width || y < 0 || y >= height) return;
+
+    int &blocked = distance[static_cast<size_t>(y) * width + x];
+    if (blocked == UNREACHABLE) return;
+    if (blocked == 0)
+    {
+        valid = false;
+        return;
+    }
+
+    // Cleared in BFS order, so a cell one step further only counts as supported by a
+    // neighbour whose distance still holds
+    std::vector<std::pair<Point, int>> cleared{{Point(x, y), blocked}};
+    blocked = UNREACHABLE;
+    for (size_t i = 0; i < cleared.size(); i++)
+    {
+        int cx = cleared[i].first.getX(), cy = cleared[i].first.getY();
+        int next = cleared[i].second + 1;
+
+        for (int d = 0; d < 4; d++)
+        {
+            int nx = cx + STEP_X[d], ny = cy + STEP_Y[d];
+            if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+
+            int &cell = distance[static_cast<size_t>(ny) * width + nx];
+            if (cell != next) continue;
+
+            bool supported = false;
+            for (int s = 0; s < 4 && !supported; s++) supported = at(nx + STEP_X[s], ny + STEP_Y[s]) == next - 1;
+            if (supported) continue;
+
+            cleared.push_back({Point(nx, ny), cell});
+            cell = UNREACHABLE;
+        }
+    }
+
+    std::vector<Point> frontier;
+    for (const std::pair<Point, int> &entry : cleared)
+        for (int d = 0; d < 4; d++)
+        {
+            int nx = entry.first.getX() + STEP_X[d], ny = entry.first.getY() + STEP_Y[d];
+            if (at(nx, ny) != UNREACHABLE) frontier.push_back(Point(nx, ny));
+        }
+
+    std::sort(frontier.begin(), frontier.end(), [this](const Point &a, const Point &b)
+              { return at(a.getX(), a.getY()) < at(b.getX(), b.getY()); });
+    spread(frontier, passable);
+}
+
+//////////////////////////////////////////           spread           //////////////////////////////////////////
+
+// BFS from cells whose distance is already final; only ever lowers distances
+void DistanceField::spread(std::vector<Point> &frontier, const Passable &passable)
+{
+    for (size_t i = 0; i < frontier.size(); i++)
+    {
+        int x = frontier[i].getX(), y = frontier[i].getY();
+        int next = distance[static_cast<size_t>(y) * width + x] + 1;
+
+        for (int d = 0; d < 4; d++)
+        {
+            int nx = x + STEP_X[d], ny = y + STEP_Y[d];
+            if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+
+            int &cell = distance[static_cast<size_t>(ny) * width + nx];
+            if (cell != UNREACHABLE && cell <= next) continue;
+            if (!passable(nx, ny)) continue;
+
+            cell = next;
+            frontier.push_back(Point(nx, ny));
+        }
+    }
+}
+
+//////////////////////////////////////////          stepFrom          //////////////////////////////////////////
+
+Direction DistanceField::stepFrom(int x, int y) const
+{
+    int here = at(x, y);
+    if (here == UNREACHABLE || here == 0) return Direction::STAY;
+
+    for (int d = 0; d < 4; d++)
+    {
+        int around = at(x + STEP_X[d], y + STEP_Y[d]);
+        if (around != UNREACHABLE && around < here) return STEP_DIR[d];
+    }
+    return Direction::STAY;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Constants.h"
+#include "Point.h"
+#include <functional>
+#include <vector>
+
+//////////////////////////////////////////         NavTarget          //////////////////////////////////////////
+
+// What a room's distance fields measure the way to
+enum class NavTarget
+{
+    DOOR,
+    KEY,
+    SWITCH, // switches still off
+    SPAWN,
+    EXIT,   // doors leading on, not back to the previous room
+    BOMB,   // bombs lying ready to pick up
+    BREAKABLE,
+    OBSTACLE,
+    BLAST,  // bombs already ticking
+    COUNT
+};
+
+//////////////////////////////////////////       DistanceField        //////////////////////////////////////////
+
+// Steps from every cell of a room to the nearest of a set of source cells, by BFS over
+// the cells a player can walk on. Sources count even when they cannot be walked on
+// (doors); the search just never continues through them.
+class DistanceField
+{
+public:
+    using Passable = std::function<bool(int, int)>;
+    static constexpr int UNREACHABLE = -1;
+
+private:
+    int width, height;
+    std::vector<int> distance;
+    bool valid;
+
+    void spread(std::vector<Point> &frontier, const Passable &passable);
+
+public:
+    DistanceField() : width(0), height(0), distance(), valid(false) {}
+
+    bool isValid() const { return valid; }
+    void invalidate() { valid = false; }
+
+    void compute(int roomWidth, int roomHeight, const std::vector<Point> &sources, const Passable &passable);
+
+    // (x, y) became walkable: distances can only shrink, so spread from it alone
+    void openCell(int x, int y, const Passable &passable);
+
+    // (x, y) stopped being walkable (and is no source): only the cells whose every
+    // shortest path went through it are cleared and reached again from around them
+    void closeCell(int x, int y, const Passable &passable);
+
+    int at(int x, int y) const
+    {
+        if (!valid || x < 0 || x >= width || y < 0 || y >= height) return UNREACHABLE;
+        return distance[static_cast<size_t>(y) * width + x];
+    }
+
+    // The neighbouring step that gets closer; STAY on a source or where nothing is reachable
+    Direction stepFrom(int x, int y) const;
+};
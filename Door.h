@@ -52,6 +52,9 @@ public:
     void setRequiredSwitches(int switches) { requiredSwitches = switches; }
     void setIsOpen(bool open) { isOpen = open; }
     void setTargetRoomId(int target) { targetRoomId = target; }
+
+    void saveState(StateWriter &out) const override;
+    void loadState(StateReader &in) override;
     bool canOpen(int keysAvailable, int switchesOn) const
     {
         bool keysOk = (keysAvailable >= requiredKeys * 2);
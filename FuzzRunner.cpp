@@ -0,0 +1,345 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "FuzzRunner.h"
+#include "HeadlessGame.h"
+#include "LevelLoader.h"
+#include "LevelPack.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+//////////////////////////////////////////          helpers           //////////////////////////////////////////
+
+static const Action FUZZ_ACTIONS[] = {Action::MOVE_UP, Action::MOVE_DOWN, Action::MOVE_LEFT,
+                                      Action::MOVE_RIGHT, Action::STAY, Action::DROP_ITEM};
+
+static ActionRecord randomAction(unsigned long cycle, int playerId, std::mt19937 &rng)
+{
+    PlayerKeyBinding binding{0, playerId, FUZZ_ACTIONS[rng() % 6]};
+    return ActionRecord(cycle, binding);
+}
+
+// Steps header and actions of source, with the answers given during the run merged in
+static RecordedSteps withAnswers(const RecordedSteps &source, const std::vector<ActionRecord> &answers)
+{
+    RecordedSteps merged;
+    merged.setRandomSeed(source.getRandomSeed());
+    merged.setColorMode(source.getColorMode());
+    for (const std::string &name : source.getScreenNames()) merged.addScreenName(name);
+
+    size_t a = 0;
+    for (size_t i = 0; i < source.getActionCount(); i++)
+    {
+        ActionRecord action = source.getActionAt(i);
+        while (a < answers.size() && answers[a].cycle < action.cycle) merged.addAction(answers[a++]);
+        merged.addAction(action);
+    }
+    while (a < answers.size()) merged.addAction(answers[a++]);
+
+    return merged;
+}
+
+//////////////////////////////////////////         FuzzGame           //////////////////////////////////////////
+
+// Plays one action stream the way LoadedGame replays it, minus the verification, and
+// records the events a result file needs. Riddles the stream does not answer get a
+// random answer, which is added to the steps so the saved input replays identically.
+class FuzzGame : public HeadlessGame
+{
+    const RecordedSteps &steps;
+    std::mt19937 answerRng;
+    std::vector<ActionRecord> answers;
+    std::string pendingFile;
+
+protected:
+    int getRiddleInput(unsigned long cycle) override
+    {
+        for (const ActionRecord &action : steps.getActionsForCycle(cycle))
+            if (action.action == Action::ANSWER_RIDDLE) return action.answer;
+
+        int playerId = aRiddle.player != nullptr ? aRiddle.player->getId() : 1;
+        ActionRecord answer(cycle, playerId, static_cast<int>(answerRng() % 4));
+        answers.push_back(answer);
+
+        // Riddles are rare; keep the crash copy complete
+        if (!pendingFile.empty()) withAnswers(steps, answers).saveToFile(pendingFile, RecordingFormat::TEXT);
+        return answer.answer;
+    }
+
+public:
+    FuzzGame(const RecordedSteps &input, const std::string &dataDir, unsigned int answerSeed,
+             const std::string &pending)
+        : HeadlessGame(dataDir), steps(input), answerRng(answerSeed), pendingFile(pending)
+    {
+    }
+
+    void handleInput() override
+    {
+        for (const ActionRecord &action : steps.getActionsForCycle(cycleCount))
+        {
+            if (action.action == Action::ANSWER_RIDDLE) continue;
+            Player &player = (action.playerId == 1) ? player1 : player2;
+            player.performAction(action.action, getCurrentRoom());
+        }
+    }
+
+    // Returns what broke, "" when the run reached maxCycles or the game ended cleanly
+    std::string play(unsigned long maxCycles)
+    {
+        GameContext::Scope bind(context);
+
+        if (!begin(steps.getRandomSeed())) return "Could not load the level files";
+
+        std::string broken;
+        while (currentState == GameState::inGame && cycleCount < maxCycles && broken.empty())
+        {
+            handleInput();
+            update();
+
+            broken = checkInvariants();
+            if (!broken.empty()) broken = "cycle " + std::to_string(cycleCount) + ": " + broken;
+        }
+
+        // A paused game is a riddle nobody answered; replays quit there as well
+        if (currentState == GameState::inGame || currentState == GameState::paused) reportQuit();
+        return broken;
+    }
+
+    RecordedSteps getPlayedSteps() const { return withAnswers(steps, answers); }
+};
+
+//////////////////////////////////////////        Constructor         //////////////////////////////////////////
+
+FuzzRunner::FuzzRunner(const std::string &data, const std::string &out, size_t runCount,
+                       unsigned long cycleCount, size_t threadCount, unsigned int seed)
+    : dataDir(data), outDir(out), runs(runCount), threads(threadCount), cycles(cycleCount),
+      baseSeed(seed), corpus(), cases(), totalWallMs(0.0)
+{
+}
+
+//////////////////////////////////////////         generate           //////////////////////////////////////////
+
+// Bursts of input separated by idle stretches, like a player would give
+RecordedSteps FuzzRunner::generate(std::mt19937 &rng) const
+{
+    RecordedSteps steps;
+    steps.setRandomSeed(rng() % 1000000 + 1);
+
+    int density = 2 + static_cast<int>(rng() % 30);
+    for (unsigned long cycle = 0; cycle < cycles; cycle++)
+    {
+        for (int playerId = 1; playerId <= 2; playerId++)
+            if (static_cast<int>(rng() % 100) < density) steps.addAction(randomAction(cycle, playerId, rng));
+    }
+    return steps;
+}
+
+//////////////////////////////////////////          mutate            //////////////////////////////////////////
+
+// A few edits to a recorded stream: drop a window, replay a window elsewhere, retarget
+// single actions, or add a burst of random input
+RecordedSteps FuzzRunner::mutate(const RecordedSteps &source, std::mt19937 &rng) const
+{
+    std::vector<ActionRecord> actions;
+    for (size_t i = 0; i < source.getActionCount(); i++) actions.push_back(source.getActionAt(i));
+
+    int edits = 1 + static_cast<int>(rng() % 4);
+    for (int e = 0; e < edits; e++)
+    {
+        unsigned long start = rng() % cycles;
+        unsigned long length = 1 + rng() % 500;
+
+        switch (rng() % 4)
+        {
+        case 0:
+            actions.erase(std::remove_if(actions.begin(), actions.end(), [&](const ActionRecord &a) {
+                              return a.cycle >= start && a.cycle < start + length;
+                          }), actions.end());
+            break;
+
+        case 1:
+        {
+            unsigned long target = rng() % cycles;
+            std::vector<ActionRecord> copied;
+            for (const ActionRecord &a : actions)
+            {
+                if (a.cycle < start || a.cycle >= start + length) continue;
+                ActionRecord moved = a;
+                moved.cycle = a.cycle - start + target;
+                copied.push_back(moved);
+            }
+            actions.insert(actions.end(), copied.begin(), copied.end());
+            break;
+        }
+
+        case 2:
+            for (ActionRecord &a : actions)
+                if (a.action != Action::ANSWER_RIDDLE && rng() % 20 == 0) a = randomAction(a.cycle, a.playerId, rng);
+            break;
+
+        default:
+            for (unsigned long cycle = start; cycle < start + length && cycle < cycles; cycle++)
+                if (rng() % 4 == 0) actions.push_back(randomAction(cycle, 1 + static_cast<int>(rng() % 2), rng));
+            break;
+        }
+    }
+
+    std::stable_sort(actions.begin(), actions.end(),
+                     [](const ActionRecord &a, const ActionRecord &b) { return a.cycle < b.cycle; });
+
+    RecordedSteps steps;
+    steps.setRandomSeed(source.getRandomSeed());
+    for (const ActionRecord &a : actions)
+        if (a.cycle < cycles) steps.addAction(a);
+    return steps;
+}
+
+//////////////////////////////////////////        loadCorpus          //////////////////////////////////////////
+
+void FuzzRunner::loadCorpus(const std::string &corpusDir)
+{
+    corpus.clear();
+    if (corpusDir.empty()) return;
+
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(corpusDir, ec), end; it != end; it.increment(ec))
+    {
+        if (ec) break;
+        if (!it->is_regular_file() || it->path().filename().string().find(".steps") == std::string::npos) continue;
+
+        RecordedSteps steps;
+        if (steps.loadFromFile(it->path().string()) == ErrorCode::NONE && steps.getRandomSeed() != 0)
+            corpus.push_back(steps);
+    }
+}
+
+//////////////////////////////////////////          runCase           //////////////////////////////////////////
+
+void FuzzRunner::runCase(FuzzCase &fuzzCase) const
+{
+    std::mt19937 rng(fuzzCase.seed);
+
+    RecordedSteps steps = (corpus.empty() || rng() % 4 == 0) ? generate(rng)
+                                                             : mutate(corpus[rng() % corpus.size()], rng);
+    for (const std::string &name : LevelLoader::discoverLevelFiles(dataDir)) steps.addScreenName(name);
+
+    std::string pending = LevelLoader::pathIn(outDir, "fuzz-" + std::to_string(fuzzCase.seed) + ".pending.steps.txt");
+    steps.saveToFile(pending, RecordingFormat::TEXT);
+
+    FuzzGame game(steps, dataDir, rng(), pending);
+    try
+    {
+        fuzzCase.details = game.play(cycles);
+    }
+    catch (const std::exception &e)
+    {
+        fuzzCase.details = std::string("exception: ") + e.what();
+    }
+
+    fuzzCase.ticks = game.getCycleCount();
+    fuzzCase.failed = !fuzzCase.details.empty();
+    if (fuzzCase.failed) fuzzCase.savedTo = saveFailure(fuzzCase, game.getPlayedSteps(), game.getEvents());
+
+    std::error_code ec;
+    fs::remove(pending, ec);
+}
+
+//////////////////////////////////////////        saveFailure         //////////////////////////////////////////
+
+// A self-contained folder: steps, results, and the level files and riddles they ran against
+std::string FuzzRunner::saveFailure(const FuzzCase &fuzzCase, const RecordedSteps &steps,
+                                    const std::vector<GameEvent> &events) const
+{
+    fs::path dir = fs::path(outDir) / ("fuzz-" + std::to_string(fuzzCase.seed));
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec) return "";
+
+    std::vector<std::string> dataFiles = LevelLoader::discoverLevelFiles(dataDir);
+    dataFiles.push_back("riddle.txt");
+    dataFiles.push_back(LevelPack::FILE_NAME); // if there is one; copied last so it stays newer
+    for (const std::string &name : dataFiles)
+        fs::copy_file(LevelLoader::pathIn(dataDir, name), dir / name, fs::copy_options::overwrite_existing, ec);
+
+    if (steps.saveToFile((dir / "adv-world.steps.txt").string(), RecordingFormat::TEXT) != ErrorCode::NONE) return "";
+    if (saveGameEvents((dir / "adv-world.result.txt").string(), events, RecordingFormat::TEXT) != ErrorCode::NONE) return "";
+
+    return dir.string();
+}
+
+//////////////////////////////////////////            run             //////////////////////////////////////////
+
+size_t FuzzRunner::run(const std::string &corpusDir)
+{
+    loadCorpus(corpusDir);
+
+    std::error_code ec;
+    fs::create_directories(outDir, ec);
+
+    cases = std::vector<FuzzCase>(runs);
+    for (size_t i = 0; i < runs; i++) cases[i].seed = baseSeed + static_cast<unsigned int>(i);
+
+    auto start = std::chrono::steady_clock::now();
+
+    WorkStealingPool pool(threads);
+    pool.run(cases.size(), [this](size_t i) { runCase(cases[i]); });
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    totalWallMs = std::chrono::duration<double, std::milli>(elapsed).count();
+
+    return std::count_if(cases.begin(), cases.end(), [](const FuzzCase &c) { return c.failed; });
+}
+
+//////////////////////////////////////////        runFromArgs         //////////////////////////////////////////
+
+int FuzzRunner::runFromArgs(int argc, char *argv[])
+{
+    size_t runCount = 100;
+    unsigned long cycleCount = 5000;
+    size_t threadCount = 0;
+    unsigned int seed = std::random_device{}();
+    std::string corpusDir;
+    std::string outDir = "fuzz-out";
+
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        std::string arg(argv[i]);
+        if (arg == "-runs") runCount = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "-cycles") cycleCount = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "-threads") threadCount = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "-seed") seed = static_cast<unsigned int>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (arg == "-corpus") corpusDir = argv[i + 1];
+        else if (arg == "-out") outDir = argv[i + 1];
+    }
+
+    if (LevelLoader::discoverLevelFiles(".").empty())
+    {
+        std::cout << "No level files found in the current directory" << std::endl;
+        return 1;
+    }
+
+    FuzzRunner runner(".", outDir, runCount, cycleCount, threadCount, seed);
+    size_t failed = runner.run(corpusDir);
+
+    unsigned long ticks = 0;
+    for (const FuzzCase &c : runner.getCases())
+    {
+        ticks += c.ticks;
+        if (!c.failed) continue;
+
+        std::cout << "seed " << c.seed << " failed at " << c.details << std::endl;
+        if (!c.savedTo.empty()) std::cout << "  saved to " << c.savedTo << std::endl;
+    }
+
+    double seconds = runner.getWallMs() / 1000.0;
+    std::cout << runner.getCases().size() << " runs from seed " << seed << ", " << ticks << " ticks in "
+              << seconds << " s (" << static_cast<unsigned long>(seconds > 0 ? ticks / seconds : 0)
+              << " ticks/s), " << failed << " failed" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
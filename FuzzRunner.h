@@ -0,0 +1,65 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Recorder.h"
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////         FuzzCase           //////////////////////////////////////////
+
+// One fuzz run: the seed its input was generated from, and what broke (if anything)
+struct FuzzCase
+{
+    unsigned int seed;
+    bool failed;
+    std::string details;
+    unsigned long ticks;
+    std::string savedTo;
+
+    FuzzCase() : seed(0), failed(false), ticks(0) {}
+};
+
+//////////////////////////////////////////        FuzzRunner          //////////////////////////////////////////
+
+// -fuzz [-runs N] [-cycles N] [-threads N] [-seed S] [-corpus dir] [-out dir]: plays random
+// action streams (or mutations of the recordings under -corpus) headless against the
+// level files in the current directory, checking Game::checkInvariants every tick.
+// Each failing input is saved as out/fuzz-<seed>/, a folder `game -load -silent -check`
+// replays as is. A run's steps are written to out/ before it starts, so an input that
+// crashes the process is left behind as fuzz-<seed>.pending.steps.txt.
+class FuzzRunner
+{
+    std::string dataDir;
+    std::string outDir;
+    size_t runs;
+    size_t threads;
+    unsigned long cycles;
+    unsigned int baseSeed;
+
+    std::vector<RecordedSteps> corpus;
+    std::vector<FuzzCase> cases;
+    double totalWallMs;
+
+    RecordedSteps generate(std::mt19937 &rng) const;
+    RecordedSteps mutate(const RecordedSteps &source, std::mt19937 &rng) const;
+    void loadCorpus(const std::string &corpusDir);
+    void runCase(FuzzCase &fuzzCase) const;
+    std::string saveFailure(const FuzzCase &fuzzCase, const RecordedSteps &steps,
+                            const std::vector<GameEvent> &events) const;
+
+public:
+    FuzzRunner(const std::string &data, const std::string &out, size_t runCount,
+               unsigned long cycleCount, size_t threadCount, unsigned int seed);
+
+    // Returns the number of failed runs
+    size_t run(const std::string &corpusDir = "");
+
+    const std::vector<FuzzCase> &getCases() const { return cases; }
+    double getWallMs() const { return totalWallMs; }
+
+    // Exit status: 0 when every run held up, 1 otherwise (or without level files)
+    static int runFromArgs(int argc, char *argv[]);
+};
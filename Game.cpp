@@ -1,16 +1,27 @@
 //////////////////////////////////////       INCLUDES & FORWARDS       /////////////////////////////////////////////
 
 #include "Game.h"
+#include "AutoplayRunner.h"
+#include "BatchRunner.h"
+#include "FuzzRunner.h"
+#include "GameHost.h"
 #include "NormalGame.h"
 #include "LoadedGame.h"
 #include "Console.h"
 #include "Constants.h"
 #include "Layouts.h"
 #include "LevelLoader.h"
+#include "LevelPack.h"
+#include "Minimizer.h"
+#include "ObservationServer.h"
 #include "Obstacle.h"
+#include "PuzzleSolver.h"
 #include "Riddle.h"
+#include "Snapshot.h"
 #include "Spring.h"
 #include "Spring.h"
+#include "ThreadPool.h"
+#include <iostream>
 #include <string>
 #include <numeric>
 #include <algorithm>
@@ -20,31 +31,25 @@ class Constants;
 
 //////////////////////////////////////////     Game Constructor       /////////////////////////////////////////////
 
-Game* Game::currentInstance = nullptr;
-
 Game::Game()
-    : silentMode(false), consoleInitialized(false), initErrorMessage(ErrorCode::NONE), initErrorRoomId(-1), 
+    : context(), consoleInitialized(false), initErrorMessage(ErrorCode::NONE), initErrorRoomId(-1), 
       gameOverMessege(GameOverMessege::NONE), cycleCount(0), currentState(GameState::mainMenu), 
-      currentRoomId(-1), gameInitialized(false), colorMode(false)
+      currentRoomId(-1), gameInitialized(false), useClock(0), residentLimit(0), prefetchEnabled(false)
 {
-  currentInstance = this;
-  Renderer::setSilentMode(silentMode);
 }
 
-// Free function used by Console.h to check color mode in OOP way
-bool isGameColorEnabled() { return Game::isColorEnabled(); }
-
 //////////////////////////////////////////      Game Destructor       /////////////////////////////////////////////
 
 Game::~Game()
 {
+  waitForPrefetch();
   for (Screen *s : loadedScreens) delete s;
   loadedScreens.clear();
 
   if (consoleInitialized)
   {
     showCursor();
-    if (!silentMode){
+    if (!context.silent){
       clrscr();
       cleanup_console();
     }
@@ -52,14 +57,86 @@ Game::~Game()
   }
 }
 
+//////////////////////////////////////////   runConversion             /////////////////////////////////////////////
+
+// -convert <in> <out>: rewrites a steps/result file in the other format, no game is started.
+// Returns the exit status: 0 once converted, 1 otherwise.
+static int runConversion(const std::string &inFile, const std::string &outFile)
+{
+  size_t records = 0;
+  ErrorCode err = convertRecording(inFile, outFile, &records);
+
+  if (err == ErrorCode::NONE)
+    std::cout << "Converted " << records << " records: " << inFile << " -> " << outFile << std::endl;
+  else if (err == ErrorCode::FILE_NOT_FOUND)
+    std::cout << "Could not open " << inFile << std::endl;
+  else if (err == ErrorCode::WRITE_ERROR)
+    std::cout << "Could not write " << outFile << std::endl;
+  else
+    std::cout << "Malformed recording file: " << inFile << std::endl;
+
+  return err == ErrorCode::NONE ? 0 : 1;
+}
+
 //////////////////////////////////////////   createFromArgs (Factory)    /////////////////////////////////////////////
 
-Game* Game::createFromArgs(int argc, char* argv[])
+Game* Game::createFromArgs(int argc, char* argv[], int& exitStatus)
 {
+  exitStatus = 0;
   for (int i = 1; i < argc; i++)
   {
     std::string arg(argv[i]);
     if (arg == "-load") return new LoadedGame(argc, argv);
+    if (arg == "-convert")
+    {
+      if (i + 2 < argc) exitStatus = runConversion(argv[i + 1], argv[i + 2]);
+      else
+      {
+        std::cout << "Usage: game -convert <input> <output>" << std::endl;
+        exitStatus = 1;
+      }
+      return nullptr;
+    }
+    if (arg == "-batch")
+    {
+      exitStatus = BatchRunner::runFromArgs(argc, argv, i + 1);
+      return nullptr;
+    }
+    if (arg == "-minimize")
+    {
+      exitStatus = Minimizer::runFromArgs(argc, argv, i + 1);
+      return nullptr;
+    }
+    if (arg == "-fuzz")
+    {
+      exitStatus = FuzzRunner::runFromArgs(argc, argv);
+      return nullptr;
+    }
+    if (arg == "-autoplay")
+    {
+      exitStatus = AutoplayRunner::runFromArgs(argc, argv);
+      return nullptr;
+    }
+    if (arg == "-solve")
+    {
+      exitStatus = PuzzleSolver::runFromArgs(argc, argv);
+      return nullptr;
+    }
+    if (arg == "-host")
+    {
+      exitStatus = GameHost::runFromArgs(argc, argv);
+      return nullptr;
+    }
+    if (arg == "-shm")
+    {
+      exitStatus = ObservationServer::runFromArgs(argc, argv);
+      return nullptr;
+    }
+    if (arg == "-compile-levels")
+    {
+      exitStatus = LevelPack::runFromArgs(argc, argv, i + 1);
+      return nullptr;
+    }
   }
 
   return new NormalGame(argc, argv);
@@ -74,10 +151,11 @@ ErrorCode Game::validateLegendPlacement(Room &room)
 {
   if (room.getBaseLayout() == nullptr) return ErrorCode::NONE;
 
+  const Screen *layout = room.getBaseLayout();
   std::vector<Point> lMarkers;
-  for (int y = 0; y < MAX_Y; y++)
-    for (int x = 0; x < MAX_X; x++)
-      if (room.getBaseLayout()->getCharAt(x, y) == 'L') lMarkers.push_back(Point(x, y));
+  for (int y = 0; y < layout->getHeight(); y++)
+    for (int x = 0; x < layout->getWidth(); x++)
+      if (layout->getCharAt(x, y) == 'L') lMarkers.push_back(Point(x, y));
 
   if (lMarkers.empty()) return ErrorCode::L_NOT_FOUND;
 
@@ -88,8 +166,8 @@ ErrorCode Game::validateLegendPlacement(Room &room)
   int topLeftY = lPos.getY() - 1;
   int width = 22;
   int height = 5;
-  if (topLeftX < 0 || topLeftY < 0 || topLeftX + width > MAX_X ||
-      topLeftY + height > MAX_Y) return ErrorCode::L_OUT_OF_BOUNDS;
+  if (topLeftX < 0 || topLeftY < 0 || topLeftX + width > layout->getWidth() ||
+      topLeftY + height > layout->getHeight()) return ErrorCode::L_OUT_OF_BOUNDS;
 
   for (int y = topLeftY; y < topLeftY + height; y++)
   {
@@ -135,6 +213,8 @@ void Game::startNewGame()
   
   if (rooms.empty()) return;
 
+  roomDigests.assign(rooms.size(), StateDigest());
+  enterRoom(0);
   rooms[0].setActive(true);
   Point startPos1 = rooms[0].getSpawnPoint(1);
   Point startPos2 = rooms[0].getSpawnPoint(2);
@@ -144,7 +224,9 @@ void Game::startNewGame()
 
   currentRoomId = 0;
   rooms[0].setActive(true);
+  followCamera(&rooms[0]);
   gameInitialized = true;
+  prefetchNeighbors(0);
 }
 
 //////////////////////////////////////////         gameLoop           /////////////////////////////////////////////
@@ -248,6 +330,8 @@ void Game::update()
   if (room == nullptr) return;
 
   room->resetAllObstaclePushStates();
+  room->updateActiveArea(&player1, &player2);
+  if (followCamera(room)) redrawCurrentRoom();
 
   player1.move(room, &aRiddle.riddle, &aRiddle.player, &player2, this);
   player2.move(room, &aRiddle.riddle, &aRiddle.player, &player1, this);
@@ -309,6 +393,23 @@ void Game::redrawCurrentRoom()
   if (aRiddle.isActive()) aRiddle.riddle->draw();
 }
 
+//////////////////////////////////////////        followCamera        /////////////////////////////////////////////
+
+// Points the view at the players in rooms larger than the console; true if it moved
+bool Game::followCamera(Room *room)
+{
+  if (room == nullptr) return false;
+
+  Point camera = room->cameraFor(&player1, &player2);
+  // The context Renderer draws through, which is bound to this thread
+  GameContext &bound = GameContext::current();
+  if (camera.getX() == bound.cameraX && camera.getY() == bound.cameraY) return false;
+
+  bound.cameraX = camera.getX();
+  bound.cameraY = camera.getY();
+  return true;
+}
+
 /////////////////////////////////////////    canPassThroughDoor       /////////////////////////////////////////////
 
 bool Game::canPassThroughDoor(Room *room, int doorId)
@@ -554,6 +655,10 @@ void Game::showErrorScreen()
     Renderer::gotoxy(20, 10);
     Renderer::print("Error: Simulation mismatch detected.\n");
     break;
+  case ErrorCode::BAD_KEYFRAME:
+    Renderer::gotoxy(21, 10);
+    Renderer::print("Error: Corrupt keyframe in steps file.\n");
+    break;
   default:
     Renderer::gotoxy(34, 10);
     Renderer::print("Unknown error\n");
@@ -563,47 +668,64 @@ void Game::showErrorScreen()
 
 //////////////////////////////////////////      initializeRooms       /////////////////////////////////////////////
 
-// Seed handling implemented with AI
 void Game::initializeRooms(unsigned int seed)
 {
+  LevelSet levels = loadLevels(seed);
+  adoptLevels(levels);
+}
 
-  rooms.clear();
-  loadedScreens.clear();
+//////////////////////////////////////////        loadLevels          /////////////////////////////////////////////
+
+// Seed handling implemented with AI
+LevelSet Game::loadLevels(unsigned int seed, size_t threads)
+{
+  LevelSet levels;
 
-  int riddlesLoaded = LevelLoader::loadRiddleFile();
-  (void)riddlesLoaded;
+  int riddlesLoaded = LevelLoader::loadRiddleFile(context.riddles, context.dataDir);
 
-  std::vector<Screen *> screens;
-  std::vector<RoomMetadata> metadatas;
-  std::vector<std::string> levelFiles = LevelLoader::discoverLevelFiles();
+  levels.pack = LevelPack::openCurrent(context.dataDir);
+  const LevelPack *pack = levels.pack.get();
+
+  std::vector<std::string> levelFiles = pack != nullptr ? pack->getRoomNames() : LevelLoader::discoverLevelFiles(context.dataDir);
 
   if (levelFiles.empty())
   {
-    initErrorMessage = ErrorCode::NO_SCREENS_FOUND;
-    currentState = GameState::error;
-    return;
+    levels.failed = true;
+    levels.error = ErrorCode::NO_SCREENS_FOUND;
+    return levels;
   }
 
-  for (const std::string &filename : levelFiles)
-  {
-    RoomMetadata metadata;
-    Screen *screen = LevelLoader::loadScreenFile(filename, metadata);
+  // No more workers than level files
+  size_t workers = threads != 0 ? threads : std::thread::hardware_concurrency();
+  WorkStealingPool pool(std::max<size_t>(1, std::min(workers, levelFiles.size())));
 
-    if (screen == nullptr) continue;
+  std::vector<Screen *> parsed(levelFiles.size(), nullptr);
+  std::vector<RoomMetadata> parsedMetadata(levelFiles.size());
+  pool.run(levelFiles.size(), [&](size_t i) {
+    if (pack != nullptr)
+    {
+      parsed[i] = pack->buildScreen(i);
+      parsedMetadata[i] = pack->getMetadata(i);
+    }
+    else parsed[i] = LevelLoader::loadScreenFile(LevelLoader::pathIn(context.dataDir, levelFiles[i]), parsedMetadata[i]);
+  });
 
-    screens.push_back(screen);
-    metadatas.push_back(metadata);
+  std::vector<RoomMetadata> metadatas;
+  for (size_t i = 0; i < parsed.size(); i++)
+  {
+    if (parsed[i] == nullptr) continue;
+
+    levels.screens.push_back(parsed[i]);
+    levels.names.push_back(levelFiles[i]);
+    metadatas.push_back(parsedMetadata[i]);
   }
 
-  if (screens.empty())
+  if (levels.screens.empty())
   {
-    currentState = GameState::error;
-    return;
+    levels.failed = true;
+    return levels;
   }
 
-  rooms.reserve(screens.size());
-  loadedScreens.reserve(screens.size());
-
   std::vector<int> riddleIds(riddlesLoaded);
   std::iota(riddleIds.begin(), riddleIds.end(), 0);
   
@@ -619,41 +741,289 @@ void Game::initializeRooms(unsigned int seed)
 
   std::shuffle(riddleIds.begin(), riddleIds.end(), g);
 
+  // Riddles are dealt in room order, so each room's first riddle is known up front
+  // from the '?' count of the rooms before it, and rooms can be built in any order
+  // (and whenever they are first entered) with the same riddles
+  std::vector<int> firstRiddle(levels.screens.size(), 0);
   int riddleIndex = 0;
-  for (size_t i = 0; i < screens.size(); i++)
+  for (size_t i = 0; i < levels.screens.size(); i++)
   {
-    loadedScreens.push_back(screens[i]);
-    rooms.push_back(Room(static_cast<int>(i)));
-
-    Room &room = rooms.back();
-    room.initFromLayout(screens[i], &riddleIds, &riddleIndex);
-    room.setSpawnPoint(metadatas[i].spawnPoint);
-    room.setSpawnPointFromNext(metadatas[i].spawnPointFromNext);
-    room.setNextRoomId(metadatas[i].nextRoomId);
-    room.setPrevRoomId(metadatas[i].prevRoomId);
-
-    for (const auto &doorConfig : metadatas[i].doorConfigs)
+    firstRiddle[i] = std::min(riddleIndex, riddlesLoaded);
+    if (pack != nullptr)
     {
-      room.setDoorRequirements(std::get<0>(doorConfig), std::get<1>(doorConfig),
-                               std::get<2>(doorConfig), std::get<3>(doorConfig));
+      riddleIndex += pack->getRiddleCount(i);
+      continue;
     }
+    for (int y = 0; y < levels.screens[i]->getHeight(); y++)
+      for (int x = 0; x < levels.screens[i]->getWidth(); x++)
+        if (levels.screens[i]->getCharAt(x, y) == '?') riddleIndex++;
+  }
+
+  levels.rooms.reserve(levels.screens.size());
+  for (size_t i = 0; i < levels.screens.size(); i++) levels.rooms.emplace_back(static_cast<int>(i));
 
-    for (const auto &dz : metadatas[i].darkZones)
-      room.addDarkZone(dz.x1, dz.y1, dz.x2, dz.y2);
+  // Only the shells here: layout, metadata and legend. Objects come from buildRoom
+  std::vector<ErrorCode> validation(levels.screens.size(), ErrorCode::NONE);
+  pool.run(levels.screens.size(), [&](size_t i) {
+    Room &room = levels.rooms[i];
+    room.setBaseLayout(levels.screens[i]);
+    applyMetadata(room, metadatas[i]);
     
-    ErrorCode validationResult = validateLegendPlacement(room);
-    if (validationResult != ErrorCode::NONE)
+    // Packed rooms passed the legend check when they were compiled
+    if (pack != nullptr)
     {
-      initErrorMessage = validationResult;
-      initErrorRoomId = i + 1;
-      currentState = GameState::error;
-      return;
+      Point legend = pack->getLegendPoint(i);
+      room.setLegendPoint(legend.getX(), legend.getY());
     }
+    else validation[i] = validateLegendPlacement(room);
+  });
+
+  levels.riddleOrder = std::move(riddleIds);
+  levels.firstRiddle = std::move(firstRiddle);
+
+  for (size_t i = 0; i < validation.size(); i++)
+  {
+    if (validation[i] == ErrorCode::NONE) continue;
+
+    levels.failed = true;
+    levels.error = validation[i];
+    levels.errorRoomId = static_cast<int>(i) + 1;
+    break;
+  }
+
+  return levels;
+}
+
+//////////////////////////////////////////        adoptLevels         /////////////////////////////////////////////
+
+void Game::adoptLevels(LevelSet &levels)
+{
+  clearRooms();
+  for (Screen *s : loadedScreens) delete s;
+  loadedScreens.clear();
+
+  rooms = std::move(levels.rooms);
+  loadedScreens = std::move(levels.screens);
+  levels.screens.clear();
+  levelPack = std::move(levels.pack);
+  levelNames = std::move(levels.names);
+  riddleOrder = std::move(levels.riddleOrder);
+  firstRiddle = std::move(levels.firstRiddle);
+  residency.assign(rooms.size(), Residency::SHELL);
+  roomEntered.assign(rooms.size(), 0);
+  roomDigests.assign(rooms.size(), StateDigest());
+  roomImages.assign(rooms.size(), RoomImage());
+  roomLastUse.assign(rooms.size(), 0);
+  roomLocks.reset(new std::mutex[rooms.size()]);
+
+  if (levels.failed)
+  {
+    clearRooms();
+    if (levels.error != ErrorCode::NONE) initErrorMessage = levels.error;
+    if (levels.errorRoomId >= 0) initErrorRoomId = levels.errorRoomId;
+    currentState = GameState::error;
+    return;
   }
 
   finalRoomId = static_cast<int>(rooms.size()) - 1;
 }
 
+//////////////////////////////////////////        clearRooms          /////////////////////////////////////////////
+
+void Game::clearRooms()
+{
+  waitForPrefetch();
+  rooms.clear();
+  residency.clear();
+  roomEntered.clear();
+  roomDigests.clear();
+  roomImages.clear();
+  roomLastUse.clear();
+  roomLocks.reset();
+}
+
+//////////////////////////////////////////         buildRoom          /////////////////////////////////////////////
+
+// Objects, springs and obstacles of a room shell, dealt the riddles loadLevels set aside
+void Game::buildRoom(size_t i)
+{
+  Room &room = rooms[i];
+  int riddleIndex = firstRiddle[i];
+
+  if (levelPack != nullptr)
+    room.initFromCells(room.getBaseLayout(), levelPack->getObjectCells(i), levelPack->getSpringGroups(i),
+                       levelPack->getObstacleGroups(i), &riddleOrder, &riddleIndex);
+  else room.initFromLayout(room.getBaseLayout(), &riddleOrder, &riddleIndex);
+}
+
+//////////////////////////////////////////         ensureRoom         /////////////////////////////////////////////
+
+// Makes a room live: built the first time, restored from its image after an eviction
+void Game::ensureRoom(int roomId)
+{
+  if (roomId < 0 || roomId >= static_cast<int>(rooms.size())) return;
+
+  std::lock_guard<std::mutex> lock(roomLocks[roomId]);
+  roomLastUse[roomId] = ++useClock;
+
+  if (residency[roomId] == Residency::SHELL) buildRoom(static_cast<size_t>(roomId));
+  else if (residency[roomId] == Residency::EVICTED)
+  {
+    rooms[roomId].loadImage(roomImages[roomId]);
+    roomImages[roomId] = RoomImage();
+  }
+  residency[roomId] = Residency::LIVE;
+}
+
+//////////////////////////////////////////         evictRoom          /////////////////////////////////////////////
+
+void Game::evictRoom(size_t i)
+{
+  std::lock_guard<std::mutex> lock(roomLocks[i]);
+  if (residency[i] != Residency::LIVE) return;
+
+  roomImages[i] = rooms[i].saveImage();
+  rooms[i].release();
+  residency[i] = Residency::EVICTED;
+}
+
+//////////////////////////////////////////       trimResidency        /////////////////////////////////////////////
+
+// Keeps the current room and the most recently entered others, residentLimit in all
+void Game::trimResidency()
+{
+  if (residentLimit == 0) return;
+
+  std::vector<std::pair<unsigned long, size_t>> others;
+  for (size_t i = 0; i < rooms.size(); i++)
+  {
+    if (static_cast<int>(i) == currentRoomId) continue;
+
+    std::lock_guard<std::mutex> lock(roomLocks[i]);
+    if (residency[i] == Residency::LIVE) others.push_back({roomLastUse[i], i});
+  }
+
+  size_t kept = currentRoomId >= 0 ? residentLimit - 1 : residentLimit;
+  if (others.size() <= kept) return;
+
+  std::sort(others.begin(), others.end());
+  for (size_t k = 0; k < others.size() - kept; k++) evictRoom(others[k].second);
+}
+
+// From here on the room's state is its own, not what buildRoom would make
+void Game::enterRoom(int roomId)
+{
+  ensureRoom(roomId);
+  roomEntered[roomId] = 1;
+}
+
+//////////////////////////////////////////     prefetchNeighbors      /////////////////////////////////////////////
+
+// Builds the rooms the doors of roomId lead to on a background thread, so walking
+// through one rarely waits for its objects
+void Game::prefetchNeighbors(int roomId)
+{
+  if (!prefetchEnabled || roomId < 0 || roomId >= static_cast<int>(rooms.size())) return;
+
+  const Room &room = rooms[roomId];
+  std::vector<int> neighbors = {room.getNextRoomId(), room.getPrevRoomId()};
+  for (size_t door = 0; door < room.getDoorReqsCount(); door++)
+    neighbors.push_back(room.getDoorTargetRoomId(static_cast<int>(door)));
+
+  waitForPrefetch();
+  prefetchTask = std::async(std::launch::async, [this, neighbors]() {
+    GameContext::Scope bind(context);
+    for (int id : neighbors) ensureRoom(id);
+  });
+}
+
+void Game::waitForPrefetch()
+{
+  if (prefetchTask.valid()) prefetchTask.get();
+}
+
+//////////////////////////////////////////       applyMetadata        /////////////////////////////////////////////
+
+void Game::applyMetadata(Room &room, const RoomMetadata &metadata)
+{
+  room.setSpawnPoint(metadata.spawnPoint);
+  room.setSpawnPointFromNext(metadata.spawnPointFromNext);
+  room.setNextRoomId(metadata.nextRoomId);
+  room.setPrevRoomId(metadata.prevRoomId);
+
+  for (const auto &doorConfig : metadata.doorConfigs)
+  {
+    room.setDoorRequirements(std::get<0>(doorConfig), std::get<1>(doorConfig),
+                             std::get<2>(doorConfig), std::get<3>(doorConfig));
+  }
+
+  for (const auto &dz : metadata.darkZones)
+    room.addDarkZone(dz.x1, dz.y1, dz.x2, dz.y2);
+}
+
+//////////////////////////////////////////        reloadLevel         /////////////////////////////////////////////
+
+// Rebuilds one room from its edited level file, dealing it the same riddles as before.
+// The old room stays when the file no longer parses or fails the legend check.
+ErrorCode Game::reloadLevel(const std::string &fileName)
+{
+  auto found = std::find(levelNames.begin(), levelNames.end(), fileName);
+  if (found == levelNames.end()) return ErrorCode::FILE_NOT_FOUND;
+  size_t i = static_cast<size_t>(found - levelNames.begin());
+  if (i >= rooms.size()) return ErrorCode::FILE_NOT_FOUND;
+
+  RoomMetadata metadata;
+  Screen *screen = LevelLoader::loadScreenFile(LevelLoader::pathIn(context.dataDir, fileName), metadata);
+  if (screen == nullptr) return ErrorCode::INVALID_FORMAT;
+
+  // Checked on a scratch room first, so a bad edit leaves the live one untouched
+  Room probe(static_cast<int>(i));
+  probe.setBaseLayout(screen);
+  applyMetadata(probe, metadata);
+
+  ErrorCode legend = validateLegendPlacement(probe);
+  if (legend != ErrorCode::NONE)
+  {
+    delete screen;
+    return legend;
+  }
+
+  // Built from the text either way: the level pack still holds the old cells
+  std::lock_guard<std::mutex> lock(roomLocks[i]);
+  Room &room = rooms[i];
+  int riddleIndex = firstRiddle[i];
+  room.clearDoorRequirements();
+  room.clearDarkZones();
+  room.initFromLayout(screen, &riddleOrder, &riddleIndex);
+  applyMetadata(room, metadata);
+  validateLegendPlacement(room);
+  residency[i] = Residency::LIVE;
+  roomEntered[i] = 1;
+  roomDigests[i] = StateDigest();
+  roomImages[i] = RoomImage();
+  roomLastUse[i] = ++useClock;
+
+  delete loadedScreens[i];
+  loadedScreens[i] = screen;
+
+  // Players keep everything but a position the edit walled in
+  if (static_cast<int>(i) == currentRoomId)
+  {
+    for (Player *player : {&player1, &player2})
+    {
+      if (!room.isBlocked(player->getX(), player->getY())) continue;
+
+      Point spawn = room.getSpawnPoint(player->getId());
+      if (player->getId() == 2) spawn.setY(spawn.getY() + 1);
+      player->setPosition(spawn.getX(), spawn.getY());
+      player->stopMovement();
+      player->getSpringMomentum().resetMomentum();
+    }
+  }
+
+  return ErrorCode::NONE;
+}
+
 //////////////////////////////////////////        changeRoom          /////////////////////////////////////////////
 
 void Game::changeRoom(int newRoomId, bool goingForward)
@@ -668,7 +1038,12 @@ void Game::changeRoom(int newRoomId, bool goingForward)
 
   if (newRoomId < 0 || newRoomId >= static_cast<int>(rooms.size())) return;
 
-  if (currentRoomId >= 0) rooms[currentRoomId].setActive(false);
+  enterRoom(newRoomId);
+  if (currentRoomId >= 0)
+  {
+    rooms[currentRoomId].setActive(false);
+    roomDigests[currentRoomId] = StateDigest();
+  }
 
   currentRoomId = newRoomId;
   rooms[newRoomId].setActive(true);
@@ -696,6 +1071,7 @@ void Game::changeRoom(int newRoomId, bool goingForward)
   player2.setAtDoor(false);
   player1.setWaitingAtDoor(false);
   player2.setWaitingAtDoor(false);
+  followCamera(&rooms[newRoomId]);
 
   Renderer::clrscr();
   if (getCurrentRoom())
@@ -703,6 +1079,9 @@ void Game::changeRoom(int newRoomId, bool goingForward)
     getCurrentRoom()->draw();
     getCurrentRoom()->drawLegend(&player1, &player2);
   }
+
+  trimResidency();
+  prefetchNeighbors(newRoomId);
 }
 
 //////////////////////////////////////////       checkGameOver        /////////////////////////////////////////////
@@ -739,3 +1118,143 @@ bool Game::checkGameOver(const ExplosionResult &result)
 
   return false;
 }
+
+//////////////////////////////////////////   captureKeyframe          /////////////////////////////////////////////
+
+// Bumped whenever a saveState layout changes; older keyframes are then refused, not misread
+static const unsigned long KEYFRAME_FORMAT = 3;
+
+std::string Game::captureKeyframe()
+{
+  StateWriter out;
+  out.writeUInt(KEYFRAME_FORMAT);
+  out.writeUInt(cycleCount);
+  out.writeInt(currentRoomId);
+  out.writeEnum(gameOverMessege);
+
+  player1.saveState(out);
+  player2.saveState(out);
+
+  out.writeUInt(rooms.size());
+  for (size_t i = 0; i < rooms.size(); i++)
+  {
+    // Untouched rooms are one flag, rebuilt by buildRoom when first entered
+    out.writeBool(roomEntered[i] != 0);
+    if (!roomEntered[i]) continue;
+
+    std::lock_guard<std::mutex> lock(roomLocks[i]);
+    if (residency[i] != Residency::EVICTED)
+    {
+      rooms[i].saveState(out);
+      continue;
+    }
+
+    // An image holds the same three sections saveState writes
+    out.writeBytes(roomImages[i].progress);
+    out.writeBytes(roomImages[i].objects);
+    out.writeBytes(roomImages[i].grid);
+  }
+
+  return out.data();
+}
+
+//////////////////////////////////////////   digestState              /////////////////////////////////////////////
+
+// Same sections as a keyframe, hashed one subsystem at a time; rooms out of play
+// reuse the parts hashed since they were left
+StateDigest Game::digestState()
+{
+  StateDigest digest;
+
+  StateWriter game;
+  game.writeInt(currentRoomId);
+  game.writeEnum(gameOverMessege);
+  digest.add("game", game);
+
+  StateWriter p1, p2;
+  player1.saveState(p1);
+  player2.saveState(p2);
+  digest.add("player1", p1);
+  digest.add("player2", p2);
+
+  for (size_t i = 0; i < rooms.size(); i++)
+  {
+    StateDigest &room = roomDigests[i];
+    if (static_cast<int>(i) == currentRoomId || room.parts.empty())
+    {
+      std::lock_guard<std::mutex> lock(roomLocks[i]);
+      std::string prefix = "room" + std::to_string(i);
+
+      room = StateDigest();
+      if (!roomEntered[i]) Room::digestUntouched(room, prefix);
+      else if (residency[i] == Residency::EVICTED) Room::digestImage(roomImages[i], room, prefix);
+      else rooms[i].digestState(room, prefix);
+    }
+    digest.add(room);
+  }
+
+  return digest;
+}
+
+//////////////////////////////////////////   checkInvariants          /////////////////////////////////////////////
+
+std::string Game::checkInvariants() const
+{
+  if (currentRoomId < 0 || currentRoomId >= static_cast<int>(rooms.size())) return "";
+  const Room &room = rooms[currentRoomId];
+
+  for (const Player *player : {&player1, &player2})
+  {
+    if (!player->isAlive() || player->isWaitingAtDoor()) continue;
+
+    int x = player->getX();
+    int y = player->getY();
+    std::string who = "Player " + std::to_string(player->getId()) + " at (" + std::to_string(x) + "," + std::to_string(y) + ")";
+
+    if (!room.isInside(x, y)) return who + " is out of bounds";
+
+    const GameObject *obj = room.getObjectAt(x, y);
+    if (obj != nullptr && obj->isBlocking()) return who + " is inside " + obj->getName();
+  }
+
+  return room.checkInvariants();
+}
+
+//////////////////////////////////////////   restoreKeyframe          /////////////////////////////////////////////
+
+bool Game::restoreKeyframe(const std::string &state)
+{
+  StateReader in(state);
+  if (in.readUInt() != KEYFRAME_FORMAT) return false;
+
+  cycleCount = in.readUInt();
+  currentRoomId = static_cast<int>(in.readInt());
+  gameOverMessege = in.readEnum<GameOverMessege>();
+
+  if (!player1.loadState(in) || !player2.loadState(in)) return false;
+
+  if (in.readCount() != rooms.size()) return false;
+  for (size_t i = 0; i < rooms.size(); i++)
+  {
+    std::lock_guard<std::mutex> lock(roomLocks[i]);
+    roomEntered[i] = in.readBool() ? 1 : 0;
+    roomImages[i] = RoomImage();
+    roomDigests[i] = StateDigest();
+
+    // Back to a shell; buildRoom makes it again on entry
+    if (!roomEntered[i])
+    {
+      if (residency[i] != Residency::SHELL) rooms[i].resetToShell();
+      residency[i] = Residency::SHELL;
+      continue;
+    }
+
+    if (!rooms[i].loadState(in)) return false;
+    residency[i] = Residency::LIVE;
+    roomLastUse[i] = ++useClock;
+  }
+  trimResidency();
+
+  aRiddle.reset();
+  return in.ok() && in.atEnd();
+}
@@ -3,13 +3,24 @@
 //////////////////////////////////////////       INCLUDES & FORWARDS       /////////////////////////////////////////////
 
 #include "Constants.h"
+#include "GameContext.h"
 #include "Player.h"
 #include "Room.h"
 #include "Screen.h"
 #include "Renderer.h"
+#include "Snapshot.h"
+#include <atomic>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
 #include <vector>
 
+class LevelPack;
 class Riddle;
+struct RoomMetadata;
 
 //////////////////////////////////////////           Game       /////////////////////////////////////////////
 
@@ -21,11 +32,33 @@ enum class GameOverMessege
   VALUABLE_DESTROYED
 };
 
+// Rooms parsed from the level files of a data directory, not yet part of a game: each
+// has its layout, metadata and legend, while its objects wait for Game::ensureRoom.
+// Owns the parsed screens (and the level pack they may point into) until
+// Game::adoptLevels takes them over.
+struct LevelSet
+{
+  std::vector<Room> rooms;
+  std::vector<Screen *> screens;
+  std::shared_ptr<const LevelPack> pack;
+  std::vector<std::string> names;  // level file of each room
+  std::vector<int> riddleOrder;    // shuffled riddle ids, dealt in room order
+  std::vector<int> firstRiddle;    // each room's first index into riddleOrder
+  bool failed = false;
+  ErrorCode error = ErrorCode::NONE;
+  int errorRoomId = -1;
+
+  LevelSet() = default;
+  LevelSet(LevelSet &&) = default;
+  LevelSet &operator=(LevelSet &&) = default;
+  ~LevelSet() { for (Screen *s : screens) delete s; }
+};
+
 // Base class for all games - abstract
 class Game
 {
 protected:
-  bool silentMode;
+  GameContext context;
   bool consoleInitialized;
   ErrorCode initErrorMessage;
   int initErrorRoomId;
@@ -38,9 +71,6 @@ protected:
   Player player1;
   Player player2;
   bool gameInitialized;
-  bool colorMode;
-
-  static Game* currentInstance;
 
   Game();
 
@@ -62,15 +92,51 @@ protected:
 
   ActiveRiddle aRiddle;
   std::vector<Screen *> loadedScreens;
+  std::shared_ptr<const LevelPack> levelPack;
+  std::vector<std::string> levelNames;
+  std::vector<int> riddleOrder;
+  std::vector<int> firstRiddle;
+
+  // Rooms get their objects on first entry. Past residentLimit live rooms (0 = no
+  // limit) the least recently entered ones are released to a RoomImage and restored
+  // on their next entry. roomLocks[i] guards room i's entries while a background task
+  // prefetches the rooms next to the current one. A room never entered still plays
+  // as buildRoom makes it, so keyframes and digests mark it untouched instead of building it.
+  enum class Residency : char { SHELL, LIVE, EVICTED };
+  std::vector<Residency> residency;
+  std::vector<char> roomEntered;
+
+  // Only the current room plays, so a room's digest holds from the moment it is left
+  // until it is entered, restored or reloaded again; empty = hash it next time
+  std::vector<StateDigest> roomDigests;
+  std::vector<RoomImage> roomImages;
+  std::vector<unsigned long> roomLastUse;
+  std::atomic<unsigned long> useClock;
+  std::unique_ptr<std::mutex[]> roomLocks;
+  size_t residentLimit;
+  bool prefetchEnabled;
+  std::future<void> prefetchTask;
+
+  static void applyMetadata(Room &room, const RoomMetadata &metadata);
 
   void setGameOverMessege(GameOverMessege messege) { gameOverMessege = messege; }
 
   void updateCycleCount() { if (currentState == GameState::inGame) cycleCount++; }
 
+  void buildRoom(size_t i);
+  void ensureRoom(int roomId);
+  void evictRoom(size_t i);
+  void trimResidency();
+  void enterRoom(int roomId);
+  void prefetchNeighbors(int roomId);
+  void waitForPrefetch();
+  void clearRooms();
+
 public:
   virtual ~Game();
 
-  static Game* createFromArgs(int argc, char* argv[]);
+  // Tool modes (-batch, ...) run here and return nullptr; exitStatus is what main returns
+  static Game* createFromArgs(int argc, char* argv[], int& exitStatus);
 
   virtual void run() = 0;
 
@@ -85,7 +151,6 @@ public:
   const std::vector<Room>& getRooms() const { return rooms; }
   size_t getRoomsCount() const { return rooms.size(); }
 
-  static bool isColorEnabled() { return currentInstance && currentInstance->colorMode; }
 
   void setCurrentState(GameState newState) { currentState = newState; }
   void setGameInitialized(bool value) { gameInitialized = value; }
@@ -103,6 +168,13 @@ public:
 
   // Game logic
   void initializeRooms(unsigned int seed = 0);
+  // Parses and checks the level files (or maps a current levels.pack) on `threads`
+  // workers (0 = all cores); the rooms' objects are built later, on first entry.
+  // Touches only the riddle database, so it can run while the game thread shows a menu.
+  LevelSet loadLevels(unsigned int seed, size_t threads = 1);
+  void adoptLevels(LevelSet &levels);
+  // -dev: rebuilds the room of one edited level file in place
+  ErrorCode reloadLevel(const std::string &fileName);
   virtual void startNewGame();
   virtual void gameLoop() = 0;
   virtual void handleInput() = 0;
@@ -113,18 +185,32 @@ public:
   Room *getCurrentRoom();
   void checkRoomTransitions();
   void redrawCurrentRoom();
+  bool followCamera(Room *room);
   bool canPassThroughDoor(Room *room, int doorId);
-  ErrorCode validateLegendPlacement(Room &room);
+  static ErrorCode validateLegendPlacement(Room &room);
   bool checkGameOver(const ExplosionResult &result);
 
   // Accessors for event recording
   unsigned long getCycleCount() const { return cycleCount; }
   int getCurrentRoomId() const { return currentRoomId; }
 
+  // Keyframes: the whole simulation at the top of a tick, before that tick's input.
+  // Restoring expects rooms already built by initializeRooms from the same seed and levels.
+  // Both cover every room; ones not entered yet are marked untouched, not built.
+  std::string captureKeyframe();
+  bool restoreKeyframe(const std::string &state);
+
+  // Per-subsystem state hashes, written to result files as HASH events. Sampled, not
+  // running: each call serializes the players and the current room again.
+  StateDigest digestState();
+
+  // Invariants checked every tick by -fuzz and -load -check; "" when all hold
+  std::string checkInvariants() const;
+
   // Event reporting methods (pure virtual)
   virtual void reportScreenChange(int roomId) = 0;
   virtual void reportLifeLost(int playerId) = 0;
-  virtual void onRiddleAttempt(const std::string& question, int answer, bool correct) = 0;
+  virtual void onRiddleAttempt(std::string_view question, int answer, bool correct) = 0;
   virtual void reportQuit() = 0;
 
   // Riddle interaction methods
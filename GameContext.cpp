@@ -0,0 +1,27 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       /////////////////////////////////////////////
+
+#include "GameContext.h"
+#include "Console.h"
+
+//////////////////////////////////////////        Thread Binding          //////////////////////////////////////////
+
+static thread_local GameContext *boundContext = nullptr;
+
+GameContext &GameContext::current()
+{
+    if (boundContext != nullptr) return *boundContext;
+
+    static thread_local GameContext fallback;
+    return fallback;
+}
+
+GameContext::Scope::Scope(GameContext &context) : previous(boundContext) { boundContext = &context; }
+
+GameContext::Scope::~Scope() { boundContext = previous; }
+
+//////////////////////////////////////////       Console Hooks        //////////////////////////////////////////
+
+// Used by Console.h so set_color follows the color mode and sink of the bound game
+bool isGameColorEnabled() { return GameContext::current().colorMode; }
+
+std::ostream &gameOutput() { return *GameContext::current().out; }
@@ -0,0 +1,45 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "RiddleDatabase.h"
+#include <iostream>
+#include <string>
+
+//////////////////////////////////////////        GameContext         //////////////////////////////////////////
+
+// Everything that used to be process-wide per game: render flags, render sink,
+// the riddle set and the directory its level/riddle files are read from. Each Game
+// owns one; code below Game (Renderer, set_color, Riddle) reaches it through the
+// context bound to the running thread, so separate games can run side by side on
+// separate threads.
+struct GameContext
+{
+    bool silent;
+    bool colorMode;
+    std::ostream *out;
+    RiddleDatabase riddles;
+    std::string dataDir;
+    int cameraX, cameraY; // room cell shown at the console's top-left
+
+    GameContext() : silent(false), colorMode(false), out(&std::cout), dataDir("."), cameraX(0), cameraY(0) {}
+
+    GameContext(const GameContext &) = delete;
+    GameContext &operator=(const GameContext &) = delete;
+
+    // Context bound to this thread, or a default (not silent, no color, std::cout)
+    static GameContext &current();
+
+    // Binds a context to this thread for the lifetime of the scope; nests
+    class Scope
+    {
+        GameContext *previous;
+
+    public:
+        explicit Scope(GameContext &context);
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+};
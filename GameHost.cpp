@@ -0,0 +1,606 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "GameHost.h"
+#include "Console.h"
+#include "LevelLoader.h"
+#include "RiddleDatabase.h"
+#include "Room.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+
+#ifdef PLATFORM_UNIX
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const int FRAME_ROWS = MAX_Y + 2; // the room view, a status line and a message line
+    const char SPRITES[2] = {PlayerSprites::PLAYER1, PlayerSprites::PLAYER2};
+
+    volatile std::sig_atomic_t stopRequested = 0;
+
+    void requestStop(int signal)
+    {
+        (void)signal;
+        stopRequested = 1;
+    }
+
+    void fitLine(std::string &frame, int row, const std::string &text)
+    {
+        frame.replace(static_cast<size_t>(row) * MAX_X, std::min<size_t>(text.size(), MAX_X), text, 0, MAX_X);
+    }
+
+    // The whole frame, for a client that has nothing on screen yet
+    std::string fullFrame(const std::string &frame)
+    {
+        std::string out = "\x1b[?25l\x1b[2J";
+        for (int row = 0; row < FRAME_ROWS && !frame.empty(); row++)
+        {
+            out += "\x1b[" + std::to_string(row + 1) + ";1H";
+            out.append(frame, static_cast<size_t>(row) * MAX_X, MAX_X);
+        }
+        return out;
+    }
+
+    // The cells of `to` that differ from `from`, as runs of text after a cursor move.
+    // Changes a few cells apart share a run: reprinting them is cheaper than another escape.
+    void appendDiff(const std::string &from, const std::string &to, std::string &out)
+    {
+        const int MAX_GAP = 4;
+
+        for (int row = 0; row < FRAME_ROWS; row++)
+        {
+            const size_t base = static_cast<size_t>(row) * MAX_X;
+            int x = 0;
+            while (x < MAX_X)
+            {
+                if (from[base + x] == to[base + x])
+                {
+                    x++;
+                    continue;
+                }
+
+                int start = x, end = x + 1;
+                for (x++; x < MAX_X && x - end < MAX_GAP; x++)
+                    if (from[base + x] != to[base + x]) end = x + 1;
+
+                out += "\x1b[" + std::to_string(row + 1) + ";" + std::to_string(start + 1) + "H";
+                out.append(to, base + start, static_cast<size_t>(end - start));
+            }
+        }
+    }
+
+    // The view the console would show (dark cells blank), the players, then two text lines
+    void renderFrame(const HostSession &session, std::string &frame)
+    {
+        frame.assign(static_cast<size_t>(MAX_X) * FRAME_ROWS, ' ');
+
+        const Observation &view = session.simulation->getObservation();
+        const Room *room = session.simulation->getCurrentRoom();
+        if (room != nullptr && !view.grid.empty())
+        {
+            for (int y = 0; y < MAX_Y && view.viewY + y < view.height; y++)
+            {
+                for (int x = 0; x < MAX_X && view.viewX + x < view.width; x++)
+                {
+                    int rx = view.viewX + x, ry = view.viewY + y;
+                    if (room->isInDarkZone(rx, ry) && !room->isVisible(rx, ry)) continue;
+                    frame[static_cast<size_t>(y) * MAX_X + x] = view.grid[static_cast<size_t>(ry) * view.width + rx];
+                }
+            }
+
+            // The legend box is left blank: its numbers are on the status line
+            const Point &legend = room->getLegendTopLeft();
+            if (legend.getX() >= 0 && legend.getY() >= 0)
+            {
+                for (int y = legend.getY() - 1; y < legend.getY() + 4; y++)
+                    for (int x = legend.getX() - 1; x < legend.getX() + 21; x++)
+                    {
+                        int fx = x - view.viewX, fy = y - view.viewY;
+                        if (fx >= 0 && fx < MAX_X && fy >= 0 && fy < MAX_Y) frame[static_cast<size_t>(fy) * MAX_X + fx] = ' ';
+                    }
+            }
+
+            for (int i = 0; i < 2; i++)
+            {
+                const PlayerObservation &p = view.players[i];
+                int x = p.x - view.viewX, y = p.y - view.viewY;
+                if (p.alive && x >= 0 && x < MAX_X && y >= 0 && y < MAX_Y)
+                    frame[static_cast<size_t>(y) * MAX_X + x] = SPRITES[i];
+            }
+        }
+
+        std::string status = "S" + std::to_string(session.id) + " room " + std::to_string(view.roomId + 1) + "/" +
+                             std::to_string(session.simulation->getRoomCount());
+        for (int i = 0; i < 2; i++)
+        {
+            const PlayerObservation &p = view.players[i];
+            status += " | P" + std::to_string(i + 1) + "(" + std::string(1, SPRITES[i]) + ") ";
+            if (session.seats[i] < 0) status += "waiting for a player";
+            else
+                status += "lives " + std::to_string(p.lives) + " keys " + std::to_string(p.keys) + " score " +
+                          std::to_string(p.score);
+        }
+        fitLine(frame, MAX_Y, status);
+
+        if (view.state == GameState::victory) fitLine(frame, MAX_Y + 1, "VICTORY! Press any key for a new game");
+        else if (view.state == GameState::gameOver) fitLine(frame, MAX_Y + 1, "GAME OVER. Press any key for a new game");
+        else fitLine(frame, MAX_Y + 1, session.message);
+    }
+}
+
+//////////////////////////////////////////        HostSession         //////////////////////////////////////////
+
+HostSession::HostSession(int sessionId)
+    : id(sessionId), simulation(), starting(false), seats{-1, -1}, inputs(), pendingAnswer{-1, -1}, message(), shown(),
+      diff(), gamesStarted(0)
+{
+}
+
+HostSession::~HostSession() = default;
+
+bool HostSession::isRunning() const
+{
+    return simulation != nullptr && isSeated() && !simulation->isOver();
+}
+
+//////////////////////////////////////////        Constructor         //////////////////////////////////////////
+
+GameHost::GameHost(const std::string &socket, int tcpPort, size_t sessionCount, size_t threadCount,
+                   int tickMs, unsigned int randomSeed)
+    : socketPath(socket), port(tcpPort), tickPeriod(std::max(1, tickMs)), baseSeed(randomSeed), listenFd(-1),
+      sessions(), clients(), pool(threadCount), ticks(0), sessionTicks(0), tickWallMs(0.0)
+{
+    for (size_t i = 0; i < sessionCount; i++)
+        sessions.push_back(std::make_unique<HostSession>(static_cast<int>(i + 1)));
+}
+
+GameHost::~GameHost()
+{
+#ifdef PLATFORM_UNIX
+    for (size_t i = 0; i < clients.size(); i++)
+        if (clients[i].fd >= 0) drop(i);
+    if (listenFd >= 0)
+    {
+        close(listenFd);
+        if (port <= 0) unlink(socketPath.c_str());
+    }
+#endif
+}
+
+//////////////////////////////////////////         startGame          //////////////////////////////////////////
+
+// Runs on the pool. A new game for everyone seated, each of whom is sent the whole first frame.
+void GameHost::startGame(HostSession &session)
+{
+    if (session.simulation == nullptr)
+    {
+        session.simulation = std::make_unique<Simulation>();
+
+        // Nobody can be waited for inside a tick: a riddle is answered with the digit its
+        // player pressed before stepping in, and escaped (its question shown) when there is none
+        HostSession *owner = &session;
+        session.simulation->setRiddleAnswerer([owner](const RiddleData &riddle, int playerId) {
+            int seat = playerId - 1;
+            if (seat < 0 || seat > 1) return -1;
+
+            int answer = owner->pendingAnswer[seat];
+            owner->pendingAnswer[seat] = -1;
+            if (answer >= 0) return answer;
+
+            owner->message = "P" + std::to_string(playerId) + ": " + std::string(riddle.question);
+            for (int i = 0; i < 4; i++) owner->message += "  " + std::to_string(i + 1) + ") " + std::string(riddle.options[i]);
+            owner->message += "  (press 1-4, step in again)";
+            return -1;
+        });
+    }
+
+    session.starting = false;
+    session.inputs.clear();
+    session.pendingAnswer[0] = session.pendingAnswer[1] = -1;
+    session.message.clear();
+
+    // Every game of the host gets its own seed
+    unsigned long game = session.gamesStarted * sessions.size() + static_cast<unsigned long>(session.id - 1);
+    if (session.simulation->reset(baseSeed + static_cast<unsigned int>(game)))
+    {
+        session.gamesStarted++;
+        renderFrame(session, session.shown);
+    }
+    else
+    {
+        session.shown.assign(static_cast<size_t>(MAX_X) * FRAME_ROWS, ' ');
+        fitLine(session.shown, 0, "The level files could not be loaded. Press any key to try again");
+    }
+
+    session.diff = fullFrame(session.shown);
+}
+
+//////////////////////////////////////////          stepGame          //////////////////////////////////////////
+
+// Runs on the pool: one step with each player's next key, then the frame and its diff.
+// Either player's keys move the client's own player; digits are kept for the next riddle.
+void GameHost::stepGame(HostSession &session)
+{
+    std::optional<Action> actions[2];
+    std::vector<HostSession::Input> later;
+
+    for (const HostSession::Input &input : session.inputs)
+    {
+        if (input.key >= '1' && input.key <= '4')
+        {
+            session.pendingAnswer[input.seat] = input.key - '1';
+            continue;
+        }
+        if (actions[input.seat])
+        {
+            later.push_back(input);
+            continue;
+        }
+
+        for (int i = 0; i < NUM_KEY_BINDINGS; i++)
+        {
+            if (keyBindings[i].key != input.key || keyBindings[i].action == Action::ESC) continue;
+            actions[input.seat] = keyBindings[i].action;
+            break;
+        }
+    }
+    session.inputs.swap(later);
+
+    const Observation &observation = session.simulation->step(actions[0], actions[1]);
+    for (const GameEvent &event : observation.events)
+    {
+        if (event.type == GameEventType::LIFE_LOST) session.message = "P" + std::to_string(event.playerId) + " lost a life";
+        else if (event.type == GameEventType::RIDDLE_ANSWERED)
+            session.message = "Answer " + std::to_string(event.answerGiven + 1) + (event.wasCorrect ? ": correct!" : ": wrong");
+    }
+
+    std::string frame;
+    renderFrame(session, frame);
+    session.diff.clear();
+    appendDiff(session.shown, frame, session.diff);
+    session.shown.swap(frame);
+}
+
+//////////////////////////////////////////            seat            //////////////////////////////////////////
+
+// Into the first session waiting for a partner, else the first empty one
+void GameHost::seat(size_t clientIndex)
+{
+    HostSession *target = nullptr;
+    for (const std::unique_ptr<HostSession> &s : sessions)
+        if (s->isSeated() && (s->seats[0] < 0 || s->seats[1] < 0) && !target) target = s.get();
+    for (const std::unique_ptr<HostSession> &s : sessions)
+        if (!s->isSeated() && !target) target = s.get();
+
+    Client &client = clients[clientIndex];
+    if (target == nullptr)
+    {
+        client.outbox = "All sessions are taken, try again later\r\n";
+        send(client);
+        drop(clientIndex);
+        return;
+    }
+
+    client.session = target->id - 1;
+    client.seat = target->seats[0] < 0 ? 0 : 1;
+    target->seats[client.seat] = static_cast<int>(clientIndex);
+
+    // The first frame follows once the game has loaded
+    if (target->simulation == nullptr) target->starting = true;
+    else client.outbox += fullFrame(target->shown);
+}
+
+#ifdef PLATFORM_UNIX
+
+//////////////////////////////////////////           listen           //////////////////////////////////////////
+
+bool GameHost::listen()
+{
+    if (port > 0)
+    {
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        if (listenFd < 0) return false;
+
+        int yes = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) return false;
+    }
+    else
+    {
+        sockaddr_un address{};
+        if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) return false;
+
+        // Only a socket left behind by an earlier host is replaced
+        struct stat existing;
+        if (lstat(socketPath.c_str(), &existing) == 0)
+        {
+            if (!S_ISSOCK(existing.st_mode)) return false;
+            unlink(socketPath.c_str());
+        }
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0) return false;
+
+        address.sun_family = AF_UNIX;
+        socketPath.copy(address.sun_path, socketPath.size());
+        if (bind(listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) return false;
+    }
+
+    fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL, 0) | O_NONBLOCK);
+    return ::listen(listenFd, 64) == 0;
+}
+
+//////////////////////////////////////////           accept           //////////////////////////////////////////
+
+void GameHost::accept()
+{
+    while (true)
+    {
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) return;
+
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        if (port > 0)
+        {
+            int yes = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        }
+
+        // Slots of departed clients are reused, so the sessions' seat indices stay valid
+        size_t index = 0;
+        while (index < clients.size() && clients[index].fd >= 0) index++;
+        if (index == clients.size()) clients.push_back(Client());
+        clients[index] = Client{fd, -1, -1, std::string()};
+
+        seat(index);
+        if (clients[index].fd >= 0) send(clients[index]);
+    }
+}
+
+//////////////////////////////////////////          receive           //////////////////////////////////////////
+
+void GameHost::receive(Client &client)
+{
+    const size_t index = static_cast<size_t>(&client - clients.data());
+    char buffer[256];
+
+    while (true)
+    {
+        ssize_t received = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+        {
+            drop(index);
+            return;
+        }
+        if (received < 0) return;
+
+        HostSession &session = *sessions[client.session];
+        for (ssize_t i = 0; i < received; i++)
+        {
+            if (session.isRunning())
+            {
+                if (session.inputs.size() < MAX_QUEUED_KEYS) session.inputs.push_back(HostSession::Input{client.seat, buffer[i]});
+            }
+            // The game is over (or never loaded): any key starts the next one
+            else session.starting = true;
+        }
+    }
+}
+
+//////////////////////////////////////////            send            //////////////////////////////////////////
+
+void GameHost::send(Client &client)
+{
+    while (!client.outbox.empty())
+    {
+        ssize_t sent = ::send(client.fd, client.outbox.data(), client.outbox.size(), 0);
+        if (sent < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) break;
+            drop(static_cast<size_t>(&client - clients.data()));
+            return;
+        }
+        client.outbox.erase(0, static_cast<size_t>(sent));
+    }
+
+    if (client.outbox.size() > MAX_OUTBOX) drop(static_cast<size_t>(&client - clients.data()));
+}
+
+//////////////////////////////////////////            drop            //////////////////////////////////////////
+
+// Closes the client; a session left empty releases its game
+void GameHost::drop(size_t clientIndex)
+{
+    Client &client = clients[clientIndex];
+    if (client.fd < 0) return;
+
+    close(client.fd);
+    client.fd = -1;
+    client.outbox.clear();
+
+    if (client.session < 0) return;
+    HostSession &session = *sessions[client.session];
+    session.seats[client.seat] = -1;
+    client.session = -1;
+
+    if (!session.isSeated())
+    {
+        session.simulation.reset();
+        session.starting = false;
+        session.inputs.clear();
+        session.message.clear();
+        session.shown.clear();
+        session.diff.clear();
+    }
+}
+
+#else
+
+bool GameHost::listen() { return false; }
+void GameHost::accept() {}
+void GameHost::receive(Client &client) { (void)client; }
+void GameHost::send(Client &client) { (void)client; }
+void GameHost::drop(size_t clientIndex) { (void)clientIndex; }
+
+#endif
+
+//////////////////////////////////////////            tick            //////////////////////////////////////////
+
+// One tick of the shared timer: the running sessions are stepped and the new games loaded
+// on the pool, then each seated client is sent its session's diff. Idle sessions are not
+// even looked at by the workers.
+void GameHost::tick()
+{
+    std::vector<HostSession *> due;
+    for (const std::unique_ptr<HostSession> &s : sessions)
+        if (s->isDue()) due.push_back(s.get());
+    if (due.empty()) return;
+
+    auto start = std::chrono::steady_clock::now();
+
+    pool.run(due.size(), [&](size_t i)
+    {
+        HostSession &session = *due[i];
+        if (session.starting) startGame(session);
+        else stepGame(session);
+    });
+
+    for (HostSession *session : due)
+    {
+        if (session->diff.empty()) continue;
+        for (int seat : session->seats)
+        {
+            if (seat < 0) continue;
+            clients[seat].outbox += session->diff;
+            send(clients[seat]);
+        }
+    }
+
+    ticks++;
+    sessionTicks += due.size();
+    tickWallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+//////////////////////////////////////////            run             //////////////////////////////////////////
+
+bool GameHost::run()
+{
+#ifdef PLATFORM_UNIX
+    if (!listen()) return false;
+
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point nextTick = Clock::now() + tickPeriod;
+    std::vector<pollfd> polled;
+
+    while (!stopRequested)
+    {
+        bool anyDue = std::any_of(sessions.begin(), sessions.end(),
+                                  [](const std::unique_ptr<HostSession> &s) { return s->isDue(); });
+
+        // With nothing running or loading the timer is off: the host sleeps until a client speaks
+        int timeout = -1;
+        if (anyDue)
+        {
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(nextTick - Clock::now()).count();
+            timeout = static_cast<int>(std::max<long long>(0, wait));
+        }
+
+        polled.clear();
+        polled.push_back(pollfd{listenFd, POLLIN, 0});
+        for (const Client &c : clients)
+            polled.push_back(pollfd{c.fd, static_cast<short>(POLLIN | (c.outbox.empty() ? 0 : POLLOUT)), 0});
+
+        if (poll(polled.data(), polled.size(), timeout) < 0 && errno != EINTR) break;
+
+        for (size_t i = 0; i < clients.size(); i++)
+        {
+            short events = polled[i + 1].revents;
+            if (clients[i].fd < 0 || events == 0) continue;
+            if (events & (POLLIN | POLLHUP | POLLERR)) receive(clients[i]);
+            if (clients[i].fd >= 0 && (events & POLLOUT)) send(clients[i]);
+        }
+        if (polled[0].revents & POLLIN) accept();
+
+        if (!anyDue) nextTick = Clock::now() + tickPeriod;
+        else if (Clock::now() >= nextTick)
+        {
+            tick();
+            // A host that falls behind skips ticks rather than bursting to catch up
+            nextTick = std::max(nextTick + tickPeriod, Clock::now());
+        }
+    }
+
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    return true;
+#else
+    return false;
+#endif
+}
+
+//////////////////////////////////////////        runFromArgs         //////////////////////////////////////////
+
+int GameHost::runFromArgs(int argc, char *argv[])
+{
+    size_t sessionCount = 16;
+    size_t threadCount = 0;
+    std::string socketPath = "game.sock";
+    int port = 0;
+    int tickMs = 100;
+    unsigned int seed = 1;
+
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        std::string arg(argv[i]);
+        if (arg == "-sessions") sessionCount = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "-threads") threadCount = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "-socket") socketPath = argv[i + 1];
+        else if (arg == "-port") port = std::atoi(argv[i + 1]);
+        else if (arg == "-tick") tickMs = std::atoi(argv[i + 1]);
+        else if (arg == "-seed") seed = static_cast<unsigned int>(std::strtoul(argv[i + 1], nullptr, 10));
+    }
+
+    if (LevelLoader::discoverLevelFiles(".").empty())
+    {
+        std::cout << "No level files found in the current directory" << std::endl;
+        return 1;
+    }
+
+    GameHost host(socketPath, port, std::max<size_t>(1, sessionCount), threadCount, tickMs, seed);
+    std::string where = port > 0 ? "127.0.0.1:" + std::to_string(port) : socketPath;
+    std::cout << "Hosting " << std::max<size_t>(1, sessionCount) << " sessions on " << where << ", tick " << tickMs
+              << " ms, " << host.pool.getWorkerCount() << " workers (Ctrl-C stops)" << std::endl;
+
+    if (!host.run())
+    {
+        std::cout << "Could not listen on " << where << std::endl;
+        return 1;
+    }
+
+    std::cout << "Host stopped after " << host.ticks << " ticks, " << host.sessionTicks << " session ticks";
+    if (host.ticks > 0) std::cout << ", " << host.tickWallMs / host.ticks << " ms per tick";
+    std::cout << std::endl;
+    return 0;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "ThreadPool.h"
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Simulation;
+
+//////////////////////////////////////////        HostSession         //////////////////////////////////////////
+
+// One dungeon and the (up to) two clients playing it, on a Simulation. The game exists only
+// while someone is seated; a session without clients, or whose game has ended, is never
+// ticked. A new game is loaded on the pool at the next tick, not by the thread polling.
+struct HostSession
+{
+    struct Input
+    {
+        int seat; // 0 or 1: the player the key is for
+        char key;
+    };
+
+    int id;
+    std::unique_ptr<Simulation> simulation;
+    bool starting;             // a new game is due at the next tick
+    int seats[2];              // client slots (index into GameHost::clients), -1 when free
+    std::vector<Input> inputs; // keys not yet played, in order: one per player per tick
+    int pendingAnswer[2];      // digit pressed for the next riddle, -1 when none
+    std::string message;       // the frame's last line
+    std::string shown;         // last frame sent, MAX_X x FRAME_ROWS
+    std::string diff;          // terminal output of the last tick, for every seated client
+    unsigned long gamesStarted;
+
+    explicit HostSession(int sessionId);
+    ~HostSession();
+
+    bool isSeated() const { return seats[0] >= 0 || seats[1] >= 0; }
+    bool isRunning() const;
+    bool isDue() const { return isRunning() || (starting && isSeated()); }
+};
+
+//////////////////////////////////////////          GameHost          //////////////////////////////////////////
+
+// -host [-sessions N] [-threads N] [-socket path | -port P] [-tick ms] [-seed S]: runs up to
+// N independent two-player games of the level files in the current directory on one fixed
+// WorkStealingPool. Clients connect to a Unix domain socket (or 127.0.0.1:P) and are seated
+// two to a session; each tick of the shared timer steps the running sessions (and loads the
+// new games) on the pool, renders every one into its frame and sends each client the cells
+// that changed as terminal escapes, so `socat -,raw,echo=0 UNIX-CONNECT:game.sock` is a
+// client. Keys are player 1's or player 2's, for the client's own player; 1-4 answer the
+// open riddle. The host runs until interrupted.
+class GameHost
+{
+    struct Client
+    {
+        int fd;
+        int session; // -1 once disconnected
+        int seat;
+        std::string outbox; // not yet accepted by the socket
+    };
+
+    std::string socketPath;
+    int port;
+    std::chrono::milliseconds tickPeriod;
+    unsigned int baseSeed;
+
+    int listenFd;
+    std::vector<std::unique_ptr<HostSession>> sessions;
+    std::vector<Client> clients;
+    WorkStealingPool pool;
+
+    unsigned long ticks;
+    unsigned long sessionTicks;
+    double tickWallMs;
+
+    bool listen();
+    void accept();
+    void receive(Client &client);
+    void send(Client &client);
+    void drop(size_t clientIndex);
+    void seat(size_t clientIndex);
+    void startGame(HostSession &session);
+    void stepGame(HostSession &session);
+    void tick();
+
+public:
+    static const size_t MAX_OUTBOX = 1 << 20; // a client this far behind is dropped
+    static const size_t MAX_QUEUED_KEYS = 8;   // keys past these, per session, are ignored
+
+    GameHost(const std::string &socket, int tcpPort, size_t sessionCount, size_t threadCount,
+             int tickMs, unsigned int randomSeed);
+    ~GameHost();
+
+    // Serves until SIGINT/SIGTERM; false when the socket could not be opened
+    bool run();
+
+    // Exit status: 0 after serving until interrupted, 1 when there was nothing to host or
+    // the socket could not be opened
+    static int runFromArgs(int argc, char *argv[]);
+};
@@ -4,9 +4,14 @@
 #include "Bomb.h"
 #include "Door.h"
 #include "Items.h"
+#include "Obstacle.h"
 #include "Riddle.h"
+#include "Snapshot.h"
+#include "SpringLink.h"
 #include "StaticObjects.h"
 #include "Switch.h"
+#include <atomic>
+#include <typeinfo>
 
 class Player;
 
@@ -16,7 +21,7 @@ GameObject *createObjectFromChar(char ch, int x, int y, int riddleId)
 {
   Point pos(x, y, 0, 0, ch);
 
-  static int nextRiddleId = 0;
+  static std::atomic<int> nextRiddleId(0);
 
   switch (ch)
   {
@@ -60,6 +65,8 @@ GameObject *createObjectFromChar(char ch, int x, int y, int riddleId)
 
 void GameObject::draw() const
 {
+    if (!Renderer::shouldRender()) return;
+
     if (!active || position.getX() < 0 || position.getY() < 0) return;
 
     switch (type)
@@ -94,6 +101,134 @@ void GameObject::draw() const
         break;
     }
 
-    Renderer::printAt(position.getX(), position.getY(), sprite);
+    Renderer::printCell(position.getX(), position.getY(), sprite);
     reset_color();
 }
+
+//////////////////////////////////////////     saveState / loadState     //////////////////////////////////////////
+
+void GameObject::saveState(StateWriter &out) const
+{
+    out.writePoint(position);
+    out.writeChar(sprite);
+    out.writeChar(static_cast<char>(type));
+    out.writeBool(active);
+}
+
+void GameObject::loadState(StateReader &in)
+{
+    position = in.readPoint();
+    sprite = in.readChar();
+    type = static_cast<ObjectType>(in.readChar());
+    active = in.readBool();
+}
+
+void InteractableObject::saveState(StateWriter &out) const
+{
+    GameObject::saveState(out);
+    out.writeInt(linkedDoorId);
+}
+
+void InteractableObject::loadState(StateReader &in)
+{
+    GameObject::loadState(in);
+    linkedDoorId = static_cast<int>(in.readInt());
+}
+
+void SwitchWall::saveState(StateWriter &out) const
+{
+    GameObject::saveState(out);
+    out.writeBool(removedBySwitch);
+}
+
+void SwitchWall::loadState(StateReader &in)
+{
+    GameObject::loadState(in);
+    removedBySwitch = in.readBool();
+}
+
+void Door::saveState(StateWriter &out) const
+{
+    InteractableObject::saveState(out);
+    out.writeInt(doorId);
+    out.writeInt(requiredKeys);
+    out.writeInt(requiredSwitches);
+    out.writeBool(isOpen);
+    out.writeInt(targetRoomId);
+}
+
+void Door::loadState(StateReader &in)
+{
+    InteractableObject::loadState(in);
+    doorId = static_cast<int>(in.readInt());
+    requiredKeys = static_cast<int>(in.readInt());
+    requiredSwitches = static_cast<int>(in.readInt());
+    isOpen = in.readBool();
+    targetRoomId = static_cast<int>(in.readInt());
+}
+
+//////////////////////////////////////////     writeObject / readObject    /////////////////////////////////////////////
+
+// Tags are part of the keyframe format: append new classes, never renumber
+enum class ObjectTag : unsigned char
+{
+  WALL, BREAKABLE_WALL, SWITCH_WALL, AIR, KEY, TORCH, BOMB,
+  SWITCH, DOOR, RIDDLE, SPRING_LINK, OBSTACLE_BLOCK, UNKNOWN
+};
+
+static ObjectTag tagOf(const GameObject &obj)
+{
+  const std::type_info &t = typeid(obj);
+  if (t == typeid(Wall)) return ObjectTag::WALL;
+  if (t == typeid(BreakableWall)) return ObjectTag::BREAKABLE_WALL;
+  if (t == typeid(SwitchWall)) return ObjectTag::SWITCH_WALL;
+  if (t == typeid(Air)) return ObjectTag::AIR;
+  if (t == typeid(Key)) return ObjectTag::KEY;
+  if (t == typeid(Torch)) return ObjectTag::TORCH;
+  if (t == typeid(Bomb)) return ObjectTag::BOMB;
+  if (t == typeid(Switch)) return ObjectTag::SWITCH;
+  if (t == typeid(Door)) return ObjectTag::DOOR;
+  if (t == typeid(Riddle)) return ObjectTag::RIDDLE;
+  if (t == typeid(SpringLink)) return ObjectTag::SPRING_LINK;
+  if (t == typeid(ObstacleBlock)) return ObjectTag::OBSTACLE_BLOCK;
+  return ObjectTag::UNKNOWN;
+}
+
+static GameObject *createObjectForTag(ObjectTag tag)
+{
+  switch (tag)
+  {
+  case ObjectTag::WALL: return new Wall();
+  case ObjectTag::BREAKABLE_WALL: return new BreakableWall();
+  case ObjectTag::SWITCH_WALL: return new SwitchWall();
+  case ObjectTag::AIR: return new Air();
+  case ObjectTag::KEY: return new Key();
+  case ObjectTag::TORCH: return new Torch();
+  case ObjectTag::BOMB: return new Bomb();
+  case ObjectTag::SWITCH: return new Switch();
+  case ObjectTag::DOOR: return new Door();
+  case ObjectTag::RIDDLE: return new Riddle();
+  case ObjectTag::SPRING_LINK: return new SpringLink();
+  case ObjectTag::OBSTACLE_BLOCK: return new ObstacleBlock();
+  default: return nullptr;
+  }
+}
+
+void writeObject(StateWriter &out, const GameObject &obj)
+{
+  out.writeChar(static_cast<char>(tagOf(obj)));
+  obj.saveState(out);
+}
+
+GameObject *readObject(StateReader &in)
+{
+  GameObject *obj = createObjectForTag(static_cast<ObjectTag>(in.readChar()));
+  if (obj == nullptr)
+  {
+    in.fail();
+    return nullptr;
+  }
+
+  obj->loadState(in);
+  return obj;
+}
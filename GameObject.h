@@ -7,6 +7,7 @@
 #include "Point.h"
 #include "Renderer.h"
 #include <iostream>
+#include <unordered_map>
 
 class Player;
 class Room;
@@ -20,6 +21,8 @@ class BreakableWall;
 class SwitchWall;
 class Spring;
 class Riddle;
+class StateWriter;
+class StateReader;
 
 //////////////////////////////////////////         GameObject       /////////////////////////////////////////////
 
@@ -62,6 +65,10 @@ public:
 
   virtual void update() {}
 
+  // Keyframe serialization; subclasses append their own fields after the base ones
+  virtual void saveState(StateWriter &out) const;
+  virtual void loadState(StateReader &in);
+
   //////////////////////////////////////////         Getters         /////////////////////////////////////////////
 
   Point getPosition() const { return position; }
@@ -87,3 +94,13 @@ public:
 //////////////////////////////////////////    createObjectFromChar       /////////////////////////////////////////////
 
 GameObject *createObjectFromChar(char ch, int x, int y, int riddleId = -1);
+
+//////////////////////////////////////////     writeObject / readObject    /////////////////////////////////////////////
+
+// Class tag followed by the object's saveState(); readObject returns nullptr on a bad tag.
+// SpringLink / ObstacleBlock come back without a parent, the owning Room relinks them.
+void writeObject(StateWriter &out, const GameObject &obj);
+GameObject *readObject(StateReader &in);
+
+// Position of every object in its room's object list, used to save links between objects
+using ObjectIndex = std::unordered_map<const GameObject *, long>;
@@ -0,0 +1,57 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "HeadlessGame.h"
+
+//////////////////////////////////////////        Constructor         //////////////////////////////////////////
+
+HeadlessGame::HeadlessGame(const std::string &dataDir, bool record) : Game(), recording(record), events()
+{
+    context.silent = true;
+    context.dataDir = dataDir;
+}
+
+//////////////////////////////////////////           Events           //////////////////////////////////////////
+
+void HeadlessGame::reportScreenChange(int roomId)
+{
+    if (recording) events.push_back(GameEvent(cycleCount, roomId));
+}
+
+void HeadlessGame::reportLifeLost(int playerId)
+{
+    if (recording) events.push_back(GameEvent(cycleCount, currentRoomId, playerId));
+}
+
+void HeadlessGame::onRiddleAttempt(std::string_view question, int answer, bool correct)
+{
+    if (recording) events.push_back(GameEvent(cycleCount, currentRoomId, question, answer, correct));
+}
+
+void HeadlessGame::reportQuit()
+{
+    if (recording) events.push_back(GameEvent(cycleCount, currentRoomId, GameEventType::QUIT));
+}
+
+//////////////////////////////////////////         changeRoom         //////////////////////////////////////////
+
+void HeadlessGame::changeRoom(int newRoomId, bool goingForward)
+{
+    Game::changeRoom(newRoomId, goingForward);
+    if (newRoomId >= 0 && newRoomId < static_cast<int>(rooms.size())) reportScreenChange(newRoomId);
+}
+
+//////////////////////////////////////////           begin            //////////////////////////////////////////
+
+bool HeadlessGame::begin(unsigned int seed)
+{
+    GameContext::Scope bind(context);
+
+    events.clear();
+    initializeRooms(seed);
+    if (currentState == GameState::error) return false;
+
+    currentState = GameState::inGame;
+    startNewGame();
+    reportScreenChange(0);
+    return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Game.h"
+#include "Recorder.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+//////////////////////////////////////////        HeadlessGame        //////////////////////////////////////////
+
+// Base of the games nobody watches: -fuzz, -autoplay and -solve's games, -shadow's replica and
+// Simulation (so -host and -shm). Silent, with no loop or keyboard of its own. While recording,
+// it keeps the events NormalGame would write to a result file, rooms entered included.
+class HeadlessGame : public Game
+{
+protected:
+    bool recording;
+    std::vector<GameEvent> events;
+
+    void reportScreenChange(int roomId) override;
+    void reportLifeLost(int playerId) override;
+    void onRiddleAttempt(std::string_view question, int answer, bool correct) override;
+    void reportQuit() override;
+    void reportRiddleAnswer(int answer) override { (void)answer; }
+
+    explicit HeadlessGame(const std::string &dataDir, bool record = true);
+
+public:
+    void run() override {}
+    void gameLoop() override {}
+    void handleInput() override {}
+
+    void changeRoom(int newRoomId, bool goingForward) override;
+
+    // Loads the levels and starts play in the game's own context; false when they did not
+    // load (getInitError())
+    bool begin(unsigned int seed);
+
+    ErrorCode getInitError() const { return initErrorMessage; }
+    const std::vector<GameEvent> &getEvents() const { return events; }
+};
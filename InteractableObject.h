@@ -22,4 +22,7 @@ public:
 
     int getLinkedDoorId() const { return linkedDoorId; }
     void setLinkedDoorId(int id) { linkedDoorId = id; }
+
+    void saveState(StateWriter &out) const override;
+    void loadState(StateReader &in) override;
 };
\ No newline at end of file
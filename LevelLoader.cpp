@@ -1,21 +1,32 @@
 //////////////////////////////////////       INCLUDES & FORWARDS       /////////////////////////////////////////////
 
 #include "LevelLoader.h"
+#include "LevelPack.h"
 #include <algorithm>
 #include <filesystem>
 #include <iostream>
+#include <sstream>
 
 namespace fs = std::filesystem;
 
 //////////////////////////////////////////     discoverLevelFiles     /////////////////////////////////////////////
 
+// A current levels.pack stands in for the text files it was compiled from
+std::vector<std::string> LevelLoader::discoverLevelFiles(const std::string &dir)
+{
+  std::shared_ptr<const LevelPack> pack = LevelPack::openCurrent(dir);
+  if (pack != nullptr) return pack->getRoomNames();
+
+  return discoverTextLevelFiles(dir);
+}
+
 // Made with AI
-std::vector<std::string> LevelLoader::discoverLevelFiles()
+std::vector<std::string> LevelLoader::discoverTextLevelFiles(const std::string &dir)
 {
   std::vector<std::string> files;
   
   std::error_code ec;
-  for (const auto& entry : fs::directory_iterator(".", ec))
+  for (const auto& entry : fs::directory_iterator(dir, ec))
   {
       if (entry.is_regular_file())
       {
@@ -33,20 +44,53 @@ std::vector<std::string> LevelLoader::discoverLevelFiles()
   return files;
 }
 
+//////////////////////////////////////////          pathIn           /////////////////////////////////////////////
+
+std::string LevelLoader::pathIn(const std::string &dir, const std::string &filename)
+{
+  if (dir.empty() || dir == ".") return filename;
+  return (fs::path(dir) / filename).string();
+}
+
 //////////////////////////////////////////      loadScreenFile       /////////////////////////////////////////////
 
 Screen *LevelLoader::loadScreenFile(const std::string& filename, RoomMetadata &metadata)
+{
+  std::vector<std::string> layout;
+  if (!readScreenFile(filename, layout, metadata)) return nullptr;
+
+  return new Screen(layout);
+}
+
+//////////////////////////////////////////      readScreenFile       /////////////////////////////////////////////
+
+bool LevelLoader::readScreenFile(const std::string& filename, std::vector<std::string> &layout, RoomMetadata &metadata)
 {
   std::ifstream file(filename);
 
-  if (!file.is_open()) return nullptr;
+  if (!file.is_open()) return false;
+
+  int width = MAX_X;
+  int height = MAX_Y;
+  std::string line;
+  bool haveLine = static_cast<bool>(std::getline(file, line));
 
-  std::string layout[MAX_Y];
-  for (int y = 0; y < MAX_Y; y++)
+  if (haveLine && line.compare(0, 5, "SIZE ") == 0)
   {
-    if (!std::getline(file, layout[y])) layout[y] = std::string(MAX_X, ' ');
+    std::istringstream size(line.substr(5));
+    if (!(size >> width >> height)) return false;
+    if (width < MAX_X || height < MAX_Y || width > MAX_ROOM_SIZE || height > MAX_ROOM_SIZE) return false;
+    haveLine = static_cast<bool>(std::getline(file, line));
+  }
 
-    while (layout[y].length() < static_cast<size_t>(MAX_X)) layout[y] += ' ';
+  layout.assign(height, std::string());
+  for (int y = 0; y < height; y++)
+  {
+    if (y > 0) haveLine = static_cast<bool>(std::getline(file, line));
+    layout[y] = haveLine ? line : std::string(width, ' ');
+
+    if (layout[y].length() > static_cast<size_t>(width)) layout[y].resize(width);
+    while (layout[y].length() < static_cast<size_t>(width)) layout[y] += ' ';
   }
 
   std::string key;
@@ -56,7 +100,7 @@ Screen *LevelLoader::loadScreenFile(const std::string& filename, RoomMetadata &m
     {
       int x, y;
       file >> x >> y;
-      if (x < 0 || x >= MAX_X || y < 0 || y >= MAX_Y) return nullptr;
+      if (x < 0 || x >= width || y < 0 || y >= height) return false;
 
       metadata.spawnPoint = Point(x, y);
     }
@@ -64,7 +108,7 @@ Screen *LevelLoader::loadScreenFile(const std::string& filename, RoomMetadata &m
     {
       int x, y;
       file >> x >> y;
-      if (x < 0 || x >= MAX_X || y < 0 || y >= MAX_Y) return nullptr;
+      if (x < 0 || x >= width || y < 0 || y >= height) return false;
       
       metadata.spawnPointFromNext = Point(x, y);
     }
@@ -89,50 +133,24 @@ Screen *LevelLoader::loadScreenFile(const std::string& filename, RoomMetadata &m
     {
       int x1, y1, x2, y2;
       file >> x1 >> y1 >> x2 >> y2;
-      if (x1 < 0 || x1 >= MAX_X || y1 < 0 || y1 >= MAX_Y || x2 < 0 || x2 >= MAX_X || y2 < 0 || y2 >= MAX_Y)
-       return nullptr;
+      if (x1 < 0 || x1 >= width || y1 < 0 || y1 >= height || x2 < 0 || x2 >= width || y2 < 0 || y2 >= height)
+       return false;
       
       metadata.darkZones.push_back(DarkZone(x1, y1, x2, y2));
     }
   }
 
   file.close();
-  return new Screen(layout);
+  return true;
 }
 
 //////////////////////////////////////////       loadRiddleFile       /////////////////////////////////////////////
 
-int LevelLoader::loadRiddleFile()
+int LevelLoader::loadRiddleFile(RiddleDatabase &database, const std::string &dir)
 {
-  std::ifstream file("riddle.txt");
-  if (!file.is_open()) return 0;
-
-  RiddleDatabase::clearRiddles();
-
-  int count = 0;
-  std::string line;
-
-  while (std::getline(file, line))
-  {
-    if (line.find("---RIDDLE---") != std::string::npos)
-    {
-      std::string question;
-      std::string options[4];
-      int answer;
-
-      std::getline(file, question);
-
-      for (int i = 0; i < 4; i++) std::getline(file, options[i]);
-
-      file >> answer;
-      file.ignore();
+  std::string path = pathIn(dir, "riddle.txt");
+  database.setSourceFile(path);
 
-      RiddleDatabase::addRiddle(
-          RiddleData(count, question, options, answer - 1));
-      count++;
-    }
-  }
-
-  file.close();
-  return count;
+  int count = database.load(path);
+  return count < 0 ? 0 : count;
 }
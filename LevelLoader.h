@@ -34,8 +34,16 @@ class LevelLoader
 {
 public:
   static Screen *loadScreenFile(const std::string& filename, RoomMetadata &metadata);
+  // Rows padded to the room width, as loadScreenFile hands them to its Screen. A file
+  // is an 80x25 map, or a first line "SIZE <width> <height>" and a map that size
+  static bool readScreenFile(const std::string& filename, std::vector<std::string> &layout, RoomMetadata &metadata);
 
-  static int loadRiddleFile();
+  static int loadRiddleFile(RiddleDatabase &database, const std::string &dir = ".");
 
-  static std::vector<std::string> discoverLevelFiles();
+  // Level names in room order: the rooms of a current levels.pack, else the text files
+  static std::vector<std::string> discoverLevelFiles(const std::string &dir = ".");
+  static std::vector<std::string> discoverTextLevelFiles(const std::string &dir = ".");
+
+  // Joins a data directory and a file name found in it
+  static std::string pathIn(const std::string &dir, const std::string &filename);
 };
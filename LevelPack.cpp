@@ -0,0 +1,472 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "LevelPack.h"
+#include "Game.h"
+#include "GameContext.h"
+#include "Room.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+const char *const LevelPack::FILE_NAME = "levels.pack";
+
+//////////////////////////////////////////          helpers           //////////////////////////////////////////
+
+static const char PACK_MAGIC[4] = {'A', 'D', 'V', 'P'};
+static const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+static const char *legendProblem(ErrorCode code)
+{
+    switch (code)
+    {
+    case ErrorCode::L_NOT_FOUND: return "no 'L' legend marker";
+    case ErrorCode::MULTIPLE_L: return "more than one 'L' legend marker";
+    case ErrorCode::L_OUT_OF_BOUNDS: return "the legend does not fit on the screen";
+    case ErrorCode::LEGEND_OBSCURES_OBJECTS: return "the legend covers objects";
+    case ErrorCode::LEGEND_OBSCURES_SPAWN: return "the legend covers a spawn point";
+    default: return "invalid legend placement";
+    }
+}
+
+//////////////////////////////////////////     Constructor / Dtor     //////////////////////////////////////////
+
+LevelPack::LevelPack() : data(nullptr), size(0), copy(), header(nullptr), rooms(nullptr) {}
+
+LevelPack::~LevelPack() { close(); }
+
+//////////////////////////////////////////        open / close        //////////////////////////////////////////
+
+bool LevelPack::open(const std::string &path)
+{
+    close();
+
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void *mapped = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return false;
+
+    data = static_cast<const char *>(mapped);
+    size = static_cast<std::size_t>(info.st_size);
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    copy.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (copy.empty()) return false;
+
+    data = copy.data();
+    size = copy.size();
+#endif
+
+    if (size < sizeof(PackHeader))
+    {
+        close();
+        return false;
+    }
+
+    header = reinterpret_cast<const PackHeader *>(data);
+    rooms = reinterpret_cast<const PackRoom *>(data + sizeof(PackHeader));
+
+    if (!validate())
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void LevelPack::close()
+{
+#ifndef _WIN32
+    if (data != nullptr && copy.empty()) munmap(const_cast<char *>(data), size);
+#endif
+    copy.clear();
+    data = nullptr;
+    size = 0;
+    header = nullptr;
+    rooms = nullptr;
+}
+
+//////////////////////////////////////////          validate          //////////////////////////////////////////
+
+bool LevelPack::sectionFits(const PackSection &section, std::size_t itemSize) const
+{
+    if (section.count == 0) return true;
+    if (section.offset % 4 != 0 || section.offset > size) return false;
+    return section.count <= (size - section.offset) / itemSize;
+}
+
+// Checked once at open, so room building can index the mapping without bounds checks
+bool LevelPack::validate() const
+{
+    if (std::memcmp(header->magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0) return false;
+    if (header->version != VERSION || header->byteOrder != BYTE_ORDER_MARK) return false;
+    if (header->fileSize != size || header->roomCount == 0) return false;
+    if (header->roomCount > (size - sizeof(PackHeader)) / sizeof(PackRoom)) return false;
+
+    for (std::size_t i = 0; i < header->roomCount; i++)
+    {
+        const PackRoom &room = rooms[i];
+
+        if (std::memchr(room.name, '\0', sizeof(room.name)) == nullptr) return false;
+
+        if (room.width < MAX_X || room.height < MAX_Y || room.width > MAX_ROOM_SIZE || room.height > MAX_ROOM_SIZE) return false;
+        if (!sectionFits(room.rows, sizeof(std::uint32_t)) || room.rows.count != static_cast<std::uint32_t>(room.height)) return false;
+
+        const std::uint32_t *rowOffsets = reinterpret_cast<const std::uint32_t *>(data + room.rows.offset);
+        const std::size_t width = static_cast<std::size_t>(room.width);
+        for (std::uint32_t y = 0; y < room.rows.count; y++)
+        {
+            if (rowOffsets[y] >= size || size - rowOffsets[y] <= width) return false;
+            if (std::memchr(data + rowOffsets[y], '\0', width + 1) != data + rowOffsets[y] + width) return false;
+        }
+
+        if (!sectionFits(room.doors, sizeof(PackDoor)) || !sectionFits(room.darkZones, sizeof(PackZone)) ||
+            !sectionFits(room.objectCells, sizeof(PackCell)) || !sectionFits(room.springSizes, sizeof(std::uint32_t)) ||
+            !sectionFits(room.springCells, sizeof(PackCell)) || !sectionFits(room.obstacleSizes, sizeof(std::uint32_t)) ||
+            !sectionFits(room.obstacleCells, sizeof(PackCell)))
+            return false;
+
+        const PackSection *cellSections[] = {&room.objectCells, &room.springCells, &room.obstacleCells};
+        for (const PackSection *section : cellSections)
+        {
+            const PackCell *cells = reinterpret_cast<const PackCell *>(data + section->offset);
+            for (std::uint32_t c = 0; c < section->count; c++)
+                if (cells[c].x < 0 || cells[c].x >= room.width || cells[c].y < 0 || cells[c].y >= room.height) return false;
+        }
+
+        const PackSection *groupSections[][2] = {{&room.springSizes, &room.springCells},
+                                                 {&room.obstacleSizes, &room.obstacleCells}};
+        for (const auto &groups : groupSections)
+        {
+            const std::uint32_t *sizes = reinterpret_cast<const std::uint32_t *>(data + groups[0]->offset);
+            std::uint64_t total = 0;
+            for (std::uint32_t g = 0; g < groups[0]->count; g++) total += sizes[g];
+            if (total != groups[1]->count) return false;
+        }
+    }
+    return true;
+}
+
+//////////////////////////////////////////        openCurrent         //////////////////////////////////////////
+
+// A level file newer than the pack only makes it stale if its contents changed; copies
+// and checkouts touch modification times without touching the levels
+std::shared_ptr<const LevelPack> LevelPack::openCurrent(const std::string &dir)
+{
+    std::string path = LevelLoader::pathIn(dir, FILE_NAME);
+
+    std::error_code ec;
+    if (!fs::is_regular_file(path, ec)) return nullptr;
+
+    std::shared_ptr<LevelPack> pack = std::make_shared<LevelPack>();
+    if (!pack->open(path)) return nullptr;
+
+    std::vector<std::string> textFiles = LevelLoader::discoverTextLevelFiles(dir);
+    if (textFiles.empty()) return pack;
+    if (textFiles != pack->getRoomNames()) return nullptr;
+
+    fs::file_time_type packTime = fs::last_write_time(path, ec);
+    if (ec) return nullptr;
+
+    for (std::size_t i = 0; i < textFiles.size(); i++)
+    {
+        std::string textPath = LevelLoader::pathIn(dir, textFiles[i]);
+        fs::file_time_type textTime = fs::last_write_time(textPath, ec);
+        if (!ec && textTime <= packTime) continue;
+
+        if (hashFile(textPath) != pack->getContentHash(i)) return nullptr;
+    }
+    return pack;
+}
+
+//////////////////////////////////////////          getters           //////////////////////////////////////////
+
+std::vector<std::string> LevelPack::getRoomNames() const
+{
+    std::vector<std::string> names;
+    for (std::size_t i = 0; i < getRoomCount(); i++) names.push_back(rooms[i].name);
+    return names;
+}
+
+std::uint64_t LevelPack::getContentHash(std::size_t i) const
+{
+    return (static_cast<std::uint64_t>(rooms[i].hashHigh) << 32) | rooms[i].hashLow;
+}
+
+Screen *LevelPack::buildScreen(std::size_t i) const
+{
+    const std::uint32_t *rowOffsets = reinterpret_cast<const std::uint32_t *>(data + rooms[i].rows.offset);
+
+    std::vector<const char *> rows;
+    for (std::uint32_t y = 0; y < rooms[i].rows.count; y++) rows.push_back(data + rowOffsets[y]);
+    return new Screen(rows, rooms[i].width);
+}
+
+RoomMetadata LevelPack::getMetadata(std::size_t i) const
+{
+    const PackRoom &room = rooms[i];
+
+    RoomMetadata metadata;
+    metadata.spawnPoint = Point(room.spawnX, room.spawnY);
+    metadata.spawnPointFromNext = Point(room.spawnNextX, room.spawnNextY);
+    metadata.nextRoomId = room.nextRoomId;
+    metadata.prevRoomId = room.prevRoomId;
+
+    const PackDoor *doors = reinterpret_cast<const PackDoor *>(data + room.doors.offset);
+    for (std::uint32_t d = 0; d < room.doors.count; d++)
+        metadata.doorConfigs.push_back(std::make_tuple(doors[d].id, doors[d].keys, doors[d].switches, doors[d].targetRoom));
+
+    const PackZone *zones = reinterpret_cast<const PackZone *>(data + room.darkZones.offset);
+    for (std::uint32_t z = 0; z < room.darkZones.count; z++)
+        metadata.darkZones.push_back(DarkZone(zones[z].x1, zones[z].y1, zones[z].x2, zones[z].y2));
+
+    return metadata;
+}
+
+std::vector<Point> LevelPack::cellsOf(const PackSection &section) const
+{
+    const PackCell *cells = reinterpret_cast<const PackCell *>(data + section.offset);
+
+    std::vector<Point> points;
+    points.reserve(section.count);
+    for (std::uint32_t c = 0; c < section.count; c++) points.push_back(Point(cells[c].x, cells[c].y));
+    return points;
+}
+
+std::vector<std::vector<Point>> LevelPack::groupsOf(const PackSection &sizes, const PackSection &cells) const
+{
+    const std::uint32_t *groupSizes = reinterpret_cast<const std::uint32_t *>(data + sizes.offset);
+    std::vector<Point> points = cellsOf(cells);
+
+    std::vector<std::vector<Point>> groups;
+    std::size_t next = 0;
+    for (std::uint32_t g = 0; g < sizes.count; g++)
+    {
+        groups.push_back(std::vector<Point>(points.begin() + next, points.begin() + next + groupSizes[g]));
+        next += groupSizes[g];
+    }
+    return groups;
+}
+
+std::vector<std::vector<Point>> LevelPack::getSpringGroups(std::size_t i) const
+{
+    return groupsOf(rooms[i].springSizes, rooms[i].springCells);
+}
+
+std::vector<std::vector<Point>> LevelPack::getObstacleGroups(std::size_t i) const
+{
+    return groupsOf(rooms[i].obstacleSizes, rooms[i].obstacleCells);
+}
+
+//////////////////////////////////////////          hashFile          //////////////////////////////////////////
+
+// FNV-1a over the raw file bytes; 0 when it cannot be read
+std::uint64_t LevelPack::hashFile(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return 0;
+
+    std::uint64_t hash = 14695981039346656037ULL;
+    char buffer[4096];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+    {
+        for (std::streamsize b = 0; b < file.gcount(); b++)
+        {
+            hash ^= static_cast<unsigned char>(buffer[b]);
+            hash *= 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+//////////////////////////////////////////          compile           //////////////////////////////////////////
+
+ErrorCode LevelPack::compile(const std::string &dir, const std::string &outFile, std::ostream &report)
+{
+    std::vector<std::string> files = LevelLoader::discoverTextLevelFiles(dir);
+    if (files.empty())
+    {
+        report << "No .screen files found in " << dir << std::endl;
+        return ErrorCode::NO_SCREENS_FOUND;
+    }
+
+    // Rooms are built once here to run the same legend check the game runs
+    GameContext context;
+    context.silent = true;
+    GameContext::Scope bind(context);
+
+    std::vector<PackRoom> packRooms(files.size());
+    std::string blob;
+    const std::size_t base = sizeof(PackHeader) + files.size() * sizeof(PackRoom);
+
+    auto append = [&](const void *bytes, std::size_t length) {
+        while (blob.size() % 4 != 0) blob += '\0';
+        std::uint32_t offset = static_cast<std::uint32_t>(base + blob.size());
+        blob.append(static_cast<const char *>(bytes), length);
+        return offset;
+    };
+    auto appendCells = [&](const std::vector<Point> &points) {
+        std::vector<PackCell> cells;
+        for (const Point &p : points)
+            cells.push_back(PackCell{static_cast<std::int16_t>(p.getX()), static_cast<std::int16_t>(p.getY())});
+        return PackSection{append(cells.data(), cells.size() * sizeof(PackCell)), static_cast<std::uint32_t>(cells.size())};
+    };
+    auto appendGroups = [&](const std::vector<std::vector<Point>> &groups, PackSection &sizes, PackSection &cells) {
+        std::vector<std::uint32_t> groupSizes;
+        std::vector<Point> flat;
+        for (const std::vector<Point> &group : groups)
+        {
+            groupSizes.push_back(static_cast<std::uint32_t>(group.size()));
+            flat.insert(flat.end(), group.begin(), group.end());
+        }
+        sizes = PackSection{append(groupSizes.data(), groupSizes.size() * sizeof(std::uint32_t)),
+                            static_cast<std::uint32_t>(groupSizes.size())};
+        cells = appendCells(flat);
+    };
+
+    for (std::size_t i = 0; i < files.size(); i++)
+    {
+        const std::string &name = files[i];
+        std::string path = LevelLoader::pathIn(dir, name);
+
+        if (name.size() >= sizeof(PackRoom::name))
+        {
+            report << name << ": file name too long for the pack" << std::endl;
+            return ErrorCode::INVALID_FORMAT;
+        }
+
+        std::vector<std::string> layout;
+        RoomMetadata metadata;
+        if (!LevelLoader::readScreenFile(path, layout, metadata))
+        {
+            report << name << ": could not be parsed" << std::endl;
+            return ErrorCode::INVALID_FORMAT;
+        }
+
+        Screen screen(layout);
+        Room room(static_cast<int>(i));
+        room.initFromLayout(&screen);
+        room.setSpawnPoint(metadata.spawnPoint);
+        room.setSpawnPointFromNext(metadata.spawnPointFromNext);
+
+        ErrorCode legend = Game::validateLegendPlacement(room);
+        if (legend != ErrorCode::NONE)
+        {
+            report << name << ": " << legendProblem(legend) << std::endl;
+            return legend;
+        }
+
+        PackRoom &packed = packRooms[i];
+        std::memset(&packed, 0, sizeof(packed));
+        std::memcpy(packed.name, name.c_str(), name.size() + 1);
+
+        std::uint64_t hash = hashFile(path);
+        packed.hashLow = static_cast<std::uint32_t>(hash);
+        packed.hashHigh = static_cast<std::uint32_t>(hash >> 32);
+
+        packed.spawnX = metadata.spawnPoint.getX();
+        packed.spawnY = metadata.spawnPoint.getY();
+        packed.spawnNextX = metadata.spawnPointFromNext.getX();
+        packed.spawnNextY = metadata.spawnPointFromNext.getY();
+        packed.nextRoomId = metadata.nextRoomId;
+        packed.prevRoomId = metadata.prevRoomId;
+        packed.legendX = room.getLegendTopLeft().getX();
+        packed.legendY = room.getLegendTopLeft().getY();
+
+        packed.width = screen.getWidth();
+        packed.height = screen.getHeight();
+        std::vector<std::uint32_t> rowOffsets;
+        for (const std::string &row : layout) rowOffsets.push_back(append(row.c_str(), row.size() + 1));
+        packed.rows = PackSection{append(rowOffsets.data(), rowOffsets.size() * sizeof(std::uint32_t)),
+                                  static_cast<std::uint32_t>(rowOffsets.size())};
+
+        std::vector<PackDoor> doors;
+        for (const auto &door : metadata.doorConfigs)
+            doors.push_back(PackDoor{std::get<0>(door), std::get<1>(door), std::get<2>(door), std::get<3>(door)});
+        packed.doors = PackSection{append(doors.data(), doors.size() * sizeof(PackDoor)), static_cast<std::uint32_t>(doors.size())};
+
+        std::vector<PackZone> zones;
+        for (const DarkZone &zone : metadata.darkZones) zones.push_back(PackZone{zone.x1, zone.y1, zone.x2, zone.y2});
+        packed.darkZones = PackSection{append(zones.data(), zones.size() * sizeof(PackZone)), static_cast<std::uint32_t>(zones.size())};
+
+        // The same split Room::loadObjects makes while scanning
+        std::vector<Point> objectCells, springCells, obstacleCells;
+        for (int y = 0; y < screen.getHeight(); y++)
+        {
+            for (int x = 0; x < screen.getWidth(); x++)
+            {
+                char ch = screen.getCharAt(x, y);
+                if (ch == '#') springCells.push_back(Point(x, y));
+                else if (ch == '*') obstacleCells.push_back(Point(x, y));
+                else if (ch != ' ' && ch != 'W') objectCells.push_back(Point(x, y));
+
+                if (ch == '?') packed.riddleCount++;
+            }
+        }
+
+        packed.objectCells = appendCells(objectCells);
+        appendGroups(Room::groupCells(&screen, springCells), packed.springSizes, packed.springCells);
+        appendGroups(Room::groupCells(&screen, obstacleCells), packed.obstacleSizes, packed.obstacleCells);
+
+        report << "  " << name << "  " << std::hex << hash << std::dec << std::endl;
+    }
+
+    while (blob.size() % 4 != 0) blob += '\0';
+
+    PackHeader header;
+    std::memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.roomCount = static_cast<std::uint32_t>(files.size());
+    header.fileSize = static_cast<std::uint32_t>(base + blob.size());
+
+    std::ofstream out(outFile, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return ErrorCode::WRITE_ERROR;
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(packRooms.data()), packRooms.size() * sizeof(PackRoom));
+    out.write(blob.data(), blob.size());
+    if (!out) return ErrorCode::WRITE_ERROR;
+
+    report << "Packed " << files.size() << " rooms into " << outFile << " (" << header.fileSize << " bytes)" << std::endl;
+    return ErrorCode::NONE;
+}
+
+//////////////////////////////////////////        runFromArgs         //////////////////////////////////////////
+
+int LevelPack::runFromArgs(int argc, char *argv[], int dirIndex)
+{
+    std::string dir = (dirIndex < argc && argv[dirIndex][0] != '-') ? argv[dirIndex] : ".";
+    std::string outFile;
+
+    for (int i = 1; i + 1 < argc; i++)
+        if (std::string(argv[i]) == "-out") outFile = argv[i + 1];
+
+    if (outFile.empty()) outFile = LevelLoader::pathIn(dir, FILE_NAME);
+
+    ErrorCode err = compile(dir, outFile, std::cout);
+    if (err == ErrorCode::WRITE_ERROR) std::cout << "Could not write " << outFile << std::endl;
+    else if (err != ErrorCode::NONE) std::cout << "No pack written" << std::endl;
+    return err == ErrorCode::NONE ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Constants.h"
+#include "LevelLoader.h"
+#include "Point.h"
+#include "Screen.h"
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////       Pack records         //////////////////////////////////////////
+
+// levels.pack: a PackHeader, a PackRoom per level file in discovery order, then the
+// rows and cell lists the rooms point into. Every field is 32 bits (cells are two 16-bit
+// coordinates) in the byte order of the machine that compiled it, every section starts
+// on a 4-byte boundary, and offsets count from the start of the file, so a mapped pack
+// is read in place.
+struct PackHeader
+{
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t roomCount;
+    std::uint32_t fileSize;
+};
+
+struct PackSection
+{
+    std::uint32_t offset;
+    std::uint32_t count;
+};
+
+struct PackCell
+{
+    std::int16_t x;
+    std::int16_t y;
+};
+
+struct PackDoor
+{
+    std::int32_t id, keys, switches, targetRoom;
+};
+
+struct PackZone
+{
+    std::int32_t x1, y1, x2, y2;
+};
+
+struct PackRoom
+{
+    char name[64];
+    std::uint32_t hashLow, hashHigh;   // FNV-1a of the source file
+    std::int32_t spawnX, spawnY, spawnNextX, spawnNextY;
+    std::int32_t nextRoomId, prevRoomId;
+    std::int32_t legendX, legendY;
+    std::uint32_t riddleCount;         // '?' cells
+    std::int32_t width, height;
+    PackSection rows;                  // uint32 offset per row; NUL-terminated, width chars
+    PackSection doors;                 // PackDoor
+    PackSection darkZones;             // PackZone
+    PackSection objectCells;           // PackCell, scan order
+    PackSection springSizes;           // uint32 per group
+    PackSection springCells;           // PackCell, BFS order within each group
+    PackSection obstacleSizes;
+    PackSection obstacleCells;
+};
+
+//////////////////////////////////////////         LevelPack          //////////////////////////////////////////
+
+// The level files of a data directory compiled by -compile-levels: grids, metadata and
+// the spring/obstacle groups Room would otherwise find by scanning. Opening maps the
+// file and checks its bounds once; rooms are then built straight from the mapping.
+class LevelPack
+{
+    const char *data;
+    std::size_t size;
+    std::vector<char> copy; // the file contents where mmap is not available
+
+    const PackHeader *header;
+    const PackRoom *rooms;
+
+    bool validate() const;
+    bool sectionFits(const PackSection &section, std::size_t itemSize) const;
+    std::vector<Point> cellsOf(const PackSection &section) const;
+    std::vector<std::vector<Point>> groupsOf(const PackSection &sizes, const PackSection &cells) const;
+
+public:
+    static const char *const FILE_NAME;
+    static const std::uint32_t VERSION = 2;
+
+    LevelPack();
+    ~LevelPack();
+    LevelPack(const LevelPack &) = delete;
+    LevelPack &operator=(const LevelPack &) = delete;
+
+    bool open(const std::string &path);
+    void close();
+
+    // The pack in dir, if it exists and matches the level files next to it (none at all
+    // is fine: a pack may ship alone); null otherwise
+    static std::shared_ptr<const LevelPack> openCurrent(const std::string &dir);
+
+    std::size_t getRoomCount() const { return header == nullptr ? 0 : header->roomCount; }
+    std::vector<std::string> getRoomNames() const;
+    std::uint64_t getContentHash(std::size_t i) const;
+    int getRiddleCount(std::size_t i) const { return static_cast<int>(rooms[i].riddleCount); }
+    Point getLegendPoint(std::size_t i) const { return Point(rooms[i].legendX, rooms[i].legendY); }
+
+    // A Screen whose rows point into the pack; valid while the pack is open
+    Screen *buildScreen(std::size_t i) const;
+    RoomMetadata getMetadata(std::size_t i) const;
+    std::vector<Point> getObjectCells(std::size_t i) const { return cellsOf(rooms[i].objectCells); }
+    std::vector<std::vector<Point>> getSpringGroups(std::size_t i) const;
+    std::vector<std::vector<Point>> getObstacleGroups(std::size_t i) const;
+
+    static std::uint64_t hashFile(const std::string &path);
+
+    // Compiles the text level files of dir into outFile; progress and problems go to report
+    static ErrorCode compile(const std::string &dir, const std::string &outFile, std::ostream &report);
+
+    // -compile-levels [dir] [-out file]. Exit status: 0 when the pack was written, 1 otherwise
+    static int runFromArgs(int argc, char *argv[], int dirIndex);
+};
@@ -0,0 +1,115 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "LevelWatcher.h"
+#include "LevelLoader.h"
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+//////////////////////////////////////////          helpers           //////////////////////////////////////////
+
+// The names discoverTextLevelFiles picks up
+static bool isLevelFileName(const std::string &name)
+{
+    auto endsWith = [&name](const std::string &suffix) {
+        return name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+    return endsWith(".screen") || endsWith(".screen.txt");
+}
+
+//////////////////////////////////////////     Constructor / Dtor     //////////////////////////////////////////
+
+LevelWatcher::LevelWatcher() : dir(), inotifyFd(-1), stamps() {}
+
+LevelWatcher::~LevelWatcher() { stop(); }
+
+//////////////////////////////////////////        start / stop        //////////////////////////////////////////
+
+bool LevelWatcher::start(const std::string &dataDir)
+{
+    stop();
+
+    std::error_code ec;
+    if (!fs::is_directory(dataDir, ec)) return false;
+    dir = dataDir;
+
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd >= 0 && inotify_add_watch(inotifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) >= 0) return true;
+
+    if (inotifyFd >= 0) close(inotifyFd);
+    inotifyFd = -1;
+#endif
+
+    for (const std::string &name : LevelLoader::discoverTextLevelFiles(dir))
+        stamps[name] = fs::last_write_time(LevelLoader::pathIn(dir, name), ec);
+    return true;
+}
+
+void LevelWatcher::stop()
+{
+#ifdef __linux__
+    if (inotifyFd >= 0) close(inotifyFd);
+#endif
+    inotifyFd = -1;
+    stamps.clear();
+    dir.clear();
+}
+
+//////////////////////////////////////////            poll            //////////////////////////////////////////
+
+std::vector<std::string> LevelWatcher::poll()
+{
+    if (!isWatching()) return {};
+    if (inotifyFd < 0) return pollTimes();
+
+    std::vector<std::string> changed;
+
+#ifdef __linux__
+    alignas(struct inotify_event) char buffer[4096];
+
+    while (true)
+    {
+        ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) break;
+
+        for (ssize_t offset = 0; offset < length;)
+        {
+            const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(buffer + offset);
+            offset += sizeof(struct inotify_event) + event->len;
+
+            if (event->len == 0) continue;
+            std::string name(event->name);
+            if (isLevelFileName(name)) changed.push_back(name);
+        }
+    }
+#endif
+
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    return changed;
+}
+
+std::vector<std::string> LevelWatcher::pollTimes()
+{
+    std::vector<std::string> changed;
+    std::error_code ec;
+
+    for (const std::string &name : LevelLoader::discoverTextLevelFiles(dir))
+    {
+        fs::file_time_type stamp = fs::last_write_time(LevelLoader::pathIn(dir, name), ec);
+        if (ec) continue;
+
+        auto known = stamps.find(name);
+        if (known != stamps.end() && known->second == stamp) continue;
+
+        stamps[name] = stamp;
+        changed.push_back(name);
+    }
+    return changed;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////        LevelWatcher        //////////////////////////////////////////
+
+// -dev: reports level files saved in the data directory while the game runs. On Linux
+// it reads inotify events (files closed after writing, or renamed into place the way
+// most editors save); elsewhere it compares modification times on every poll.
+class LevelWatcher
+{
+    std::string dir;
+    int inotifyFd;
+    std::map<std::string, std::filesystem::file_time_type> stamps;
+
+    std::vector<std::string> pollTimes();
+
+public:
+    LevelWatcher();
+    ~LevelWatcher();
+    LevelWatcher(const LevelWatcher &) = delete;
+    LevelWatcher &operator=(const LevelWatcher &) = delete;
+
+    bool start(const std::string &dataDir);
+    void stop();
+    bool isWatching() const { return !dir.empty(); }
+
+    // Level files changed since the last poll, each once, in name order; never blocks
+    std::vector<std::string> poll();
+};
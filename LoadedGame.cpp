@@ -9,83 +9,87 @@
 #include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <cstdlib>
+#include <iterator>
 
 using namespace std;
 
 ///////////////////////////////////////////    CONSTRUCTORS    /////////////////////////////////////////////
 
-LoadedGame::LoadedGame(const string& filename, bool silent) : Game(), steps(),
-    expectedEventIndex(0), testPassed(true), quitCycle(-1)
+LoadedGame::LoadedGame(const string& stepsFile, const string& resultFile, const string& dataDir, bool silent)
+    : Game(), steps(), expectedEventIndex(0), testPassed(true), quitCycle(-1), cycleLimit(0), seekCycle(0), invariantChecks(false), firstHashIndex(0)
 {
-    silentMode = silent;
-    Renderer::setSilentMode(silentMode);
+    GameContext::Scope bind(context);
+    context.silent = silent || Renderer::isHeadless();
+    context.dataDir = dataDir;
 
-    initErrorMessage = loadActions(filename);
-    if (initErrorMessage != ErrorCode::NONE) {
-        currentState = GameState::error;
-        return;
-    }
-    
-    colorMode = steps.getColorMode();
-    
-    unsigned int seed = steps.getRandomSeed();
-    if (seed == 0) {
-        initErrorMessage = ErrorCode::MISSING_RANDOM_SEED;
-        currentState = GameState::error;
-        return;
-    }
-    
-    if (validateScreenNames() != ErrorCode::NONE) {
-        initErrorMessage = ErrorCode::SCREEN_MISMATCH;
-        currentState = GameState::error;
-        return;
-    }
-    
-    initializeRooms(seed);
-    currentState = GameState::inGame;
+    loadRecording(stepsFile, resultFile);
+}
 
-    if (currentState == GameState::inGame)
-    {
-        ErrorCode resultError = loadExpectedResults("adv-world.result.txt");
-        if (resultError != ErrorCode::NONE)
-        {
-            initErrorMessage = resultError;
-            currentState = GameState::error;
-        }
-    }
+LoadedGame::LoadedGame(const RecordedSteps& recorded, const string& resultFile, const string& dataDir)
+    : Game(), steps(recorded), expectedEventIndex(0), testPassed(true), quitCycle(-1), cycleLimit(0), seekCycle(0), invariantChecks(false), firstHashIndex(0)
+{
+    GameContext::Scope bind(context);
+    context.silent = true;
+    context.dataDir = dataDir;
+
+    steps.seekToCycle(0);
+    prepareReplay(resultFile);
 }
 
 LoadedGame::LoadedGame(int argc, char* argv[]) : Game(), steps(),
-    expectedEventIndex(0), testPassed(true), quitCycle(-1)
+    expectedEventIndex(0), testPassed(true), quitCycle(-1), cycleLimit(0), seekCycle(0), invariantChecks(false), firstHashIndex(0)
 {
-    bool silent = false;
+    GameContext::Scope bind(context);
+
+    // The headless build has no renderer, so it always verifies silently
+    bool silent = Renderer::isHeadless();
+    bool stallGuard = false;
 
     for (int i = 1; i < argc; i++)
     {
         std::string arg(argv[i]);
 
         if (arg == "-silent") silent = true;
+        else if (arg == "-seek" && i + 1 < argc) seekCycle = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "-check") invariantChecks = true;
+        else if (arg == "-stall-guard") stallGuard = true;
+        else if (arg == "-resident" && i + 1 < argc) residentLimit = std::strtoul(argv[++i], nullptr, 10);
     }
 
-    silentMode = silent;
-    Renderer::setSilentMode(silentMode);
+    context.silent = silent;
 
-    if (!silentMode)
+    if (!context.silent)
     {
        init_console();
        hideCursor();
        clrscr();
        consoleInitialized = true; 
     }
-    
 
-    initErrorMessage = loadActions("adv-world.steps.txt");
+    loadRecording("adv-world.steps.txt", "adv-world.result.txt");
+    if (stallGuard && currentState != GameState::error) enableStallGuard();
+}
+
+///////////////////////////////////////////    loadRecording    /////////////////////////////////////////////
+
+void LoadedGame::loadRecording(const string& stepsFile, const string& resultFile)
+{
+    initErrorMessage = loadActions(stepsFile);
     if (initErrorMessage != ErrorCode::NONE) {
         currentState = GameState::error;
         return;
     }
-    
-    colorMode = steps.getColorMode();
+
+    prepareReplay(resultFile);
+}
+
+///////////////////////////////////////////    prepareReplay    /////////////////////////////////////////////
+
+// Builds the rooms and expected events for the steps already in place
+void LoadedGame::prepareReplay(const string& resultFile)
+{
+    context.colorMode = steps.getColorMode();
     
     unsigned int seed = steps.getRandomSeed();
     if (seed == 0) {
@@ -101,16 +105,92 @@ LoadedGame::LoadedGame(int argc, char* argv[]) : Game(), steps(),
     }
     
     initializeRooms(seed);
-    setCurrentState(GameState::inGame);
+    if (currentState == GameState::error) return;
+    currentState = GameState::inGame;
+
+    ErrorCode resultError = loadExpectedResults(resultFile);
+    if (resultError != ErrorCode::NONE)
+    {
+        initErrorMessage = resultError;
+        currentState = GameState::error;
+    }
+}
+
+///////////////////////////////////////////    enableStallGuard    /////////////////////////////////////////////
+
+// A recording cut short (no QUIT, no game end) would otherwise replay forever
+void LoadedGame::enableStallGuard()
+{
+    unsigned long lastCycle = 0;
+    if (steps.getActionCount() > 0) lastCycle = steps.getActionAt(steps.getActionCount() - 1).cycle;
+    if (!expectedEvents.empty()) lastCycle = std::max(lastCycle, expectedEvents.back().cycle);
+
+    cycleLimit = lastCycle + STALL_GRACE_CYCLES;
+}
+
+///////////////////////////////////////////    seekTo    /////////////////////////////////////////////
 
-    if (currentState == GameState::inGame)
+bool LoadedGame::seekTo(unsigned long cycle)
+{
+    if (cycle <= cycleCount) return cycle == cycleCount;
+
+    const Keyframe* keyframe = steps.findKeyframe(cycle);
+
+    if (keyframe != nullptr && keyframe->cycle > cycleCount)
     {
-        ErrorCode resultError = loadExpectedResults("adv-world.result.txt");
-        if (resultError != ErrorCode::NONE)
+        if (!restoreKeyframe(keyframe->state))
         {
-            initErrorMessage = resultError;
+            initErrorMessage = ErrorCode::BAD_KEYFRAME;
             currentState = GameState::error;
+            return false;
         }
+        steps.seekToCycle(keyframe->cycle);
+        skipEventsBefore(keyframe->cycle);
+
+        auto isBefore = [](const GameEvent& event, unsigned long c) { return event.cycle < c; };
+        firstHashIndex = std::lower_bound(expectedHashes.begin(), expectedHashes.end(), keyframe->cycle, isBefore) -
+                         expectedHashes.begin();
+        actualDigests.clear();
+    }
+    else if (cycleCount == 0 && currentRoomId == 0) reportScreenChange(0);
+
+    bool wasSilent = context.silent;
+    context.silent = true;
+
+    while (currentState == GameState::inGame && cycleCount < cycle && !shouldQuit())
+    {
+        checkpointState();
+        handleInput();
+        update();
+        verifyInvariants();
+    }
+
+    context.silent = wasSilent;
+    return currentState == GameState::inGame && cycleCount == cycle;
+}
+
+///////////////////////////////////////////    verifyInvariants    /////////////////////////////////////////////
+
+void LoadedGame::verifyInvariants()
+{
+    if (!invariantChecks || !testPassed) return;
+
+    std::string broken = checkInvariants();
+    if (!broken.empty()) testFailed("Invariant broken at cycle " + std::to_string(cycleCount) + ": " + broken);
+}
+
+///////////////////////////////////////////    skipEventsBefore    /////////////////////////////////////////////
+
+// Events stamped with the keyframe's cycle were raised by the tick that led up to it,
+// except QUIT, which is reported at the top of the cycle the player left on
+void LoadedGame::skipEventsBefore(unsigned long cycle)
+{
+    expectedEventIndex = 0;
+    while (expectedEventIndex < expectedEvents.size())
+    {
+        const GameEvent& event = expectedEvents[expectedEventIndex];
+        if (event.cycle > cycle || (event.cycle == cycle && event.type == GameEventType::QUIT)) break;
+        expectedEventIndex++;
     }
 }
 
@@ -149,14 +229,25 @@ void LoadedGame::gameLoop()
 
     while (currentState == GameState::inGame)
     {
+        checkpointState();
+
         if (shouldQuit())
         {
             currentState = GameState::quit;
             return;
         }
 
+        if (cycleLimit > 0 && cycleCount >= cycleLimit)
+        {
+            testFailed("Replay still running at cycle " + std::to_string(cycleCount) +
+                       ", past the end of the recording");
+            currentState = GameState::quit;
+            return;
+        }
+
         handleInput();
         update();
+        verifyInvariants();
         Renderer::sleep_ms(50);
     }
 }
@@ -165,6 +256,7 @@ void LoadedGame::gameLoop()
 
 void LoadedGame::run()
 {
+  GameContext::Scope bind(context);
   bool running = true;
 
   while (running)
@@ -174,12 +266,13 @@ void LoadedGame::run()
 
     case GameState::inGame:
       startNewGame();
-      gameLoop();
+      if (seekCycle > 0) seekTo(seekCycle);
+      if (currentState == GameState::inGame) gameLoop();
       break;
 
     case GameState::victory:
     case GameState::gameOver:
-      if (silentMode) showSilentPrompt();
+      if (context.silent) showSilentPrompt();
       else
       {
         if (currentState == GameState::victory) showVictory();
@@ -191,7 +284,7 @@ void LoadedGame::run()
       break;
 
     case GameState::error:
-      if (silentMode) showSilentPrompt();
+      if (context.silent) showSilentPrompt();
       else
       {
         showErrorScreen();
@@ -201,10 +294,13 @@ void LoadedGame::run()
       currentState = GameState::quit;
       break;
 
+    // Pause menus are never recorded, so a replay that pauses (an escaped riddle
+    // with no recorded answer) cannot continue; it ends where the recording quit
     case GameState::paused:
+      currentState = GameState::quit;
       break;
     case GameState::quit:
-      if (silentMode) showSilentPrompt();
+      if (context.silent) showSilentPrompt();
       else
       {
         showQuitScreen();
@@ -224,31 +320,23 @@ void LoadedGame::run()
 
 ErrorCode LoadedGame::loadExpectedResults(const string& filename)
 {
-    std::ifstream file(filename);
-    if (!file.is_open())
-    {
-        cout << "Could not open expected results file: " << filename << endl;
-        return ErrorCode::FILE_NOT_FOUND;
-    }
-
-    expectedEvents.clear();
     expectedEventIndex = 0;
     quitCycle = -1;
-    while (file >> std::ws && file.peek() != EOF)
-    {
-        GameEvent event;
-        if (!event.read(file))
-        {
-            file.close();
-            return ErrorCode::READ_ERROR;
-        }
 
-        if (event.type == GameEventType::QUIT) quitCycle = static_cast<long>(event.cycle);
+    ErrorCode err = loadGameEvents(filename, expectedEvents);
+    if (err == ErrorCode::FILE_NOT_FOUND)
+        *context.out << "Could not open expected results file: " << filename << endl;
+    if (err != ErrorCode::NONE) return err;
 
-        expectedEvents.push_back(event);
-    }
+    // Hashes are checked per cycle, not in sequence with the other events
+    expectedHashes.clear();
+    auto isHash = [](const GameEvent& event) { return event.type == GameEventType::STATE_HASH; };
+    std::copy_if(expectedEvents.begin(), expectedEvents.end(), std::back_inserter(expectedHashes), isHash);
+    expectedEvents.erase(std::remove_if(expectedEvents.begin(), expectedEvents.end(), isHash), expectedEvents.end());
+
+    for (const GameEvent& event : expectedEvents)
+        if (event.type == GameEventType::QUIT) quitCycle = static_cast<long>(event.cycle);
 
-    file.close();
     return ErrorCode::NONE;
 }
 
@@ -333,7 +421,7 @@ void LoadedGame::testFailed(const std::string& details)
         testPassed = false;
         testFailureDetails = details;
         
-        if (!silentMode)
+        if (!context.silent)
         {
             initErrorMessage = ErrorCode::RESULT_MISMATCH;
             currentState = GameState::error;
@@ -353,6 +441,64 @@ void LoadedGame::checkMissedEvents()
     }
 }
 
+///////////////////////////////////////////    checkpointState    /////////////////////////////////////////////
+
+// Digests are only collected here; reportDivergence compares them once the replay ends
+void LoadedGame::checkpointState()
+{
+    size_t next = firstHashIndex + actualDigests.size();
+    if (next >= expectedHashes.size() || expectedHashes[next].cycle != cycleCount) return;
+
+    actualDigests.push_back(digestState());
+}
+
+///////////////////////////////////////////    reportDivergence    /////////////////////////////////////////////
+
+// Binary-searches the hash stream for the first checkpoint whose state differs (a
+// divergence persists, so checkpoints match up to it and differ from it on) and names
+// the parts that differ there. The state changed somewhere after the previous checkpoint.
+void LoadedGame::reportDivergence()
+{
+    auto matches = [this](size_t i) {
+        return actualDigests[i].parts == expectedHashes[firstHashIndex + i].stateHashes;
+    };
+
+    size_t count = actualDigests.size();
+    if (count == 0 || matches(count - 1)) return;
+
+    size_t low = 0, high = count - 1;
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (matches(mid)) low = mid + 1;
+        else high = mid;
+    }
+
+    const StateDigest& actual = actualDigests[low];
+    const GameEvent& expected = expectedHashes[firstHashIndex + low];
+
+    std::string parts;
+    for (size_t i = 0; i < actual.parts.size(); i++)
+    {
+        if (i < expected.stateHashes.size() && actual.parts[i] == expected.stateHashes[i]) continue;
+        parts += (parts.empty() ? "" : ", ") + actual.names[i];
+    }
+    if (actual.parts.size() != expected.stateHashes.size()) parts += (parts.empty() ? "" : ", ") + std::string("room count");
+
+    std::string where;
+    if (low == 0) where = "State already differs at the first checked cycle " + std::to_string(expected.cycle);
+    else
+    {
+        unsigned long lastMatch = expectedHashes[firstHashIndex + low - 1].cycle;
+        if (lastMatch + 1 == expected.cycle) where = "State diverged at cycle " + std::to_string(expected.cycle);
+        else where = "State diverged between cycles " + std::to_string(lastMatch + 1) + " and " + std::to_string(expected.cycle);
+    }
+    where += " (" + parts + ")";
+
+    if (testPassed) testFailed(where);
+    else testFailureDetails += "\n" + where;
+}
+
 ///////////////////////////////////////////    reportScreenChange    /////////////////////////////////////////////
 
 void LoadedGame::reportScreenChange(int roomId)
@@ -371,7 +517,7 @@ void LoadedGame::reportLifeLost(int playerId)
 
 ///////////////////////////////////////////    onRiddleAttempt    /////////////////////////////////////////////
 
-void LoadedGame::onRiddleAttempt(const std::string& question, int answer, bool correct)
+void LoadedGame::onRiddleAttempt(std::string_view question, int answer, bool correct)
 {
     GameEvent actual(cycleCount, currentRoomId, question, answer, correct);
     verifyEvent(actual);
@@ -397,8 +543,7 @@ void LoadedGame::showQuitScreen()
 
 int LoadedGame::getRiddleInput(unsigned long cycle)
 {
-    vector<ActionRecord> actions = steps.getActionsForCycle(cycle);
-    for (const auto& action : actions)
+    for (const ActionRecord& action : steps.getActionsForCycle(cycle))
         if (action.action == Action::ANSWER_RIDDLE) return action.answer;
     return -1;
 }
@@ -407,6 +552,8 @@ int LoadedGame::getRiddleInput(unsigned long cycle)
 
 void LoadedGame::showSilentPrompt()
 {
+    std::ostream &out = *context.out;
+
     switch (currentState)
     {
     case GameState::victory:
@@ -415,20 +562,27 @@ void LoadedGame::showSilentPrompt()
           testFailed("Expected more events (got " + std::to_string(expectedEventIndex) +
                      ", expected " + std::to_string(expectedEvents.size()) + ")");
 
-        if (testPassed) std::cout << "Test passed" << std::endl;
+        reportDivergence();
+
+        if (testPassed) out << "Test passed" << std::endl;
         else
         {
-          std::cout << "Test not passed" << std::endl;
-          std::cout << testFailureDetails << std::endl;
+          out << "Test not passed" << std::endl;
+          out << testFailureDetails << std::endl;
         }
         break;
 
     case GameState::error:
-        std::cout << "Test not passed" << std::endl;
+        testPassed = false;
         if (initErrorMessage == ErrorCode::SCREEN_MISMATCH)
-             std::cout << "Screen files mismatch between steps file and current directory" << std::endl;
+             testFailureDetails = "Screen files mismatch between steps file and current directory";
+        else if (initErrorMessage == ErrorCode::BAD_KEYFRAME)
+             testFailureDetails = "Corrupt keyframe in steps file";
         else
-             std::cout << "Error during initialization" << std::endl;
+             testFailureDetails = "Error during initialization";
+
+        out << "Test not passed" << std::endl;
+        out << testFailureDetails << std::endl;
         break;
     
     case GameState::quit:
@@ -438,11 +592,13 @@ void LoadedGame::showSilentPrompt()
             testFailed("Expected more events (got " + std::to_string(expectedEventIndex) +
                        ", expected " + std::to_string(expectedEvents.size()) + ")");
 
-        if (testPassed) std::cout << "Test passed" << std::endl;
+        reportDivergence();
+
+        if (testPassed) out << "Test passed" << std::endl;
         else
         {
-            std::cout << "Test not passed" << std::endl;
-            std::cout << testFailureDetails << std::endl;
+            out << "Test not passed" << std::endl;
+            out << testFailureDetails << std::endl;
         }
         break;
 
@@ -460,7 +616,7 @@ ErrorCode LoadedGame::validateScreenNames()
     
     if (recordedScreens.empty()) return ErrorCode::NONE;
     
-    std::vector<std::string> currentScreens = LevelLoader::discoverLevelFiles();
+    std::vector<std::string> currentScreens = LevelLoader::discoverLevelFiles(context.dataDir);
     
     std::sort(recordedScreens.begin(), recordedScreens.end());
     
@@ -17,13 +17,30 @@ class LoadedGame : public Game {
     bool testPassed;
     std::string testFailureDetails;
     long quitCycle;
+    unsigned long cycleLimit;
+    unsigned long seekCycle;
+    bool invariantChecks;
 
+    // HASH events from the result file, and the replay's digests at the same
+    // cycles starting from expectedHashes[firstHashIndex] (later after a seek)
+    std::vector<GameEvent> expectedHashes;
+    size_t firstHashIndex;
+    std::vector<StateDigest> actualDigests;
+
+    static const unsigned long STALL_GRACE_CYCLES = 2000;
+
+    void loadRecording(const string& stepsFile, const string& resultFile);
+    void prepareReplay(const string& resultFile);
     ErrorCode validateScreenNames();
     ErrorCode loadActions(const string& filename) { return steps.loadFromFile(filename); }
     ErrorCode loadExpectedResults(const string& filename);
     bool verifyEvent(const GameEvent& actual);
+    void skipEventsBefore(unsigned long cycle);
     void testFailed(const std::string& details);
     void checkMissedEvents();
+    void checkpointState();
+    void verifyInvariants();
+    void reportDivergence();
     void showQuitScreen();
     bool shouldQuit() const { return (quitCycle >= 0 && cycleCount >= static_cast<unsigned long>(quitCycle)); }
     void showSilentPrompt();
@@ -31,15 +48,33 @@ class LoadedGame : public Game {
 protected:
     void reportScreenChange(int roomId) override;
     void reportLifeLost(int playerId) override;
-    void onRiddleAttempt(const std::string& question, int answer, bool correct) override;
+    void onRiddleAttempt(std::string_view question, int answer, bool correct) override;
     void reportQuit() override;
     int getRiddleInput(unsigned long cycle) override;
     void reportRiddleAnswer(int answer) override { (void)answer; }
 
 public:
-    LoadedGame(const string &filename, bool silent = false);
+    LoadedGame(const string& stepsFile, const string& resultFile, const string& dataDir = ".", bool silent = true);
+    // Silent replay of steps held in memory (the minimizer's candidates)
+    LoadedGame(const RecordedSteps& recorded, const string& resultFile, const string& dataDir);
     LoadedGame(int argc, char* argv[]);
 
+    // Verdict, valid once run() has returned (silent mode)
+    bool hasPassed() const { return testPassed; }
+    const std::string& getFailureDetails() const { return testFailureDetails; }
+
+    // Verdict text ("Test passed"...) goes to this stream instead of std::cout
+    void setOutput(std::ostream& out) { context.out = &out; }
+    void enableStallGuard();
+
+    // -check: fail the replay on the first tick that breaks Game::checkInvariants
+    void enableInvariantChecks() { invariantChecks = true; }
+
+    // Jumps forward to cycle: restores the nearest keyframe at or before it, then
+    // simulates silently the rest of the way. Events before the keyframe are not verified.
+    bool seekTo(unsigned long cycle);
+    void setSeekCycle(unsigned long cycle) { seekCycle = cycle; }
+
     void handleInput() override;
     void run() override;
     void gameLoop() override;
@@ -0,0 +1,375 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Minimizer.h"
+#include "Console.h"
+#include "LevelLoader.h"
+#include "LevelPack.h"
+#include "LoadedGame.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifdef PLATFORM_UNIX
+#include <csignal>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+namespace fs = std::filesystem;
+
+//////////////////////////////////////////          helpers           //////////////////////////////////////////
+
+static const std::string INVARIANT_PREFIX = "Invariant broken at cycle ";
+
+// A crash candidate still running after this long is killed; a hang is not the crash sought
+static const int CHILD_REPLAY_SECONDS = 60;
+
+static long processId()
+{
+#ifdef PLATFORM_UNIX
+    return static_cast<long>(getpid());
+#else
+    return static_cast<long>(_getpid());
+#endif
+}
+
+// `executable -load -silent -stall-guard` in dir: "" on a clean exit, "crash" on any
+// other, "timeout" when it outlived CHILD_REPLAY_SECONDS
+static std::string runChildReplay(const std::string &executable, const fs::path &dir)
+{
+#ifdef PLATFORM_UNIX
+    pid_t child = fork();
+    if (child < 0) return "could not start";
+
+    if (child == 0)
+    {
+        int null = open("/dev/null", O_RDWR);
+        if (null >= 0)
+        {
+            dup2(null, STDIN_FILENO);
+            dup2(null, STDOUT_FILENO);
+            dup2(null, STDERR_FILENO);
+        }
+        if (chdir(dir.c_str()) != 0) _exit(127);
+        execlp(executable.c_str(), executable.c_str(), "-load", "-silent", "-stall-guard", static_cast<char *>(nullptr));
+        _exit(127);
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(CHILD_REPLAY_SECONDS);
+    int status = 0;
+    pid_t done;
+    while ((done = waitpid(child, &status, WNOHANG)) == 0 || (done < 0 && errno == EINTR))
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            kill(child, SIGKILL);
+            waitpid(child, &status, 0);
+            return "timeout";
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return done == child && WIFEXITED(status) && WEXITSTATUS(status) == 0 ? "" : "crash";
+#else
+    // No deadline here; the stall guard still ends replays that run past their recording
+    std::string command = "cd /d \"" + dir.string() + "\" && \"" + executable + "\" -load -silent -stall-guard > NUL 2>&1";
+    return std::system(command.c_str()) != 0 ? "crash" : "";
+#endif
+}
+
+// [begin, end) of chunk i when size items are cut into n nearly equal chunks
+static std::vector<ActionRecord> chunkOf(const std::vector<ActionRecord> &actions, size_t i, size_t n)
+{
+    size_t begin = i * actions.size() / n;
+    size_t end = (i + 1) * actions.size() / n;
+    return std::vector<ActionRecord>(actions.begin() + begin, actions.begin() + end);
+}
+
+static std::vector<ActionRecord> complementOf(const std::vector<ActionRecord> &actions, size_t i, size_t n)
+{
+    size_t begin = i * actions.size() / n;
+    size_t end = (i + 1) * actions.size() / n;
+
+    std::vector<ActionRecord> rest(actions.begin(), actions.begin() + begin);
+    rest.insert(rest.end(), actions.begin() + end, actions.end());
+    return rest;
+}
+
+//////////////////////////////////////////        Constructor         //////////////////////////////////////////
+
+Minimizer::Minimizer(const std::string &steps, const std::string &executablePath, size_t threadCount)
+    : stepsFile(steps), resultFile(resultFileFor(steps)), dataDir(), executable(executablePath),
+      workDir(), threads(threadCount), kind(FailureKind::MISMATCH), original(), signature(), replays(0)
+{
+    fs::path parent = fs::path(stepsFile).parent_path();
+    dataDir = parent.empty() ? "." : parent.string();
+    // The pid keeps concurrent runs on the same recording out of each other's slots
+    std::string dirName = "adv-minimize-" + fs::path(stepsFile).stem().string() + "-" + std::to_string(processId());
+    workDir = (fs::temp_directory_path() / dirName).string();
+}
+
+Minimizer::~Minimizer()
+{
+    std::error_code ec;
+    fs::remove_all(workDir, ec);
+}
+
+//////////////////////////////////////////           load             //////////////////////////////////////////
+
+ErrorCode Minimizer::load()
+{
+    if (resultFile.empty() || !fs::exists(resultFile)) return ErrorCode::FILE_NOT_FOUND;
+    return original.loadFromFile(stepsFile);
+}
+
+//////////////////////////////////////////         buildSteps         //////////////////////////////////////////
+
+// The original header with a different action list; keyframes are dropped since they
+// no longer describe the candidate's state
+RecordedSteps Minimizer::buildSteps(const std::vector<ActionRecord> &actions) const
+{
+    RecordedSteps steps;
+    steps.setRandomSeed(original.getRandomSeed());
+    steps.setColorMode(original.getColorMode());
+    for (const std::string &name : original.getScreenNames()) steps.addScreenName(name);
+    for (const ActionRecord &action : actions) steps.addAction(action);
+    return steps;
+}
+
+//////////////////////////////////////////       replayFailure        //////////////////////////////////////////
+
+// "" when the candidate passes; "crash" for an abnormal child exit, "timeout" for a hung one
+std::string Minimizer::replayFailure(const std::vector<ActionRecord> &actions, size_t slot) const
+{
+    replays++;
+
+    if (kind != FailureKind::CRASH)
+    {
+        std::ostringstream sink;
+        LoadedGame game(buildSteps(actions), resultFile, dataDir);
+        game.setOutput(sink);
+        game.enableStallGuard();
+        if (kind == FailureKind::INVARIANT) game.enableInvariantChecks();
+        game.run();
+
+        return game.hasPassed() ? "" : game.getFailureDetails();
+    }
+
+    // The child replays from its working directory, so each slot gets the levels,
+    // riddles and expected results next to the candidate steps
+    fs::path dir = fs::path(workDir) / ("slot-" + std::to_string(slot));
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+
+    std::vector<std::string> dataFiles = LevelLoader::discoverLevelFiles(dataDir);
+    dataFiles.push_back("riddle.txt");
+    dataFiles.push_back(LevelPack::FILE_NAME); // if there is one; copied last so it stays newer
+    for (const std::string &name : dataFiles)
+        fs::copy_file(LevelLoader::pathIn(dataDir, name), dir / name, fs::copy_options::overwrite_existing, ec);
+    fs::copy_file(resultFile, dir / "adv-world.result.txt", fs::copy_options::overwrite_existing, ec);
+    buildSteps(actions).saveToFile((dir / "adv-world.steps.txt").string(), RecordingFormat::TEXT);
+
+    return runChildReplay(executable, dir);
+}
+
+//////////////////////////////////////////        signatureOf         //////////////////////////////////////////
+
+// Mismatches must repeat their first message exactly; invariants may break at another cycle
+std::string Minimizer::signatureOf(const std::string &details) const
+{
+    std::string first = details.substr(0, details.find('\n'));
+
+    if (kind == FailureKind::INVARIANT)
+    {
+        if (first.compare(0, INVARIANT_PREFIX.size(), INVARIANT_PREFIX) != 0) return "";
+        size_t colon = first.find(": ");
+        return colon == std::string::npos ? "" : first.substr(colon + 2);
+    }
+    return first;
+}
+
+bool Minimizer::reproduces(const std::vector<ActionRecord> &actions, size_t slot) const
+{
+    std::string details = replayFailure(actions, slot);
+    return !details.empty() && signatureOf(details) == signature;
+}
+
+//////////////////////////////////////////      captureFailure        //////////////////////////////////////////
+
+bool Minimizer::captureFailure(FailureKind failureKind, bool autoDetect)
+{
+    kind = autoDetect ? FailureKind::INVARIANT : failureKind;
+
+    std::vector<ActionRecord> actions;
+    for (size_t i = 0; i < original.getActionCount(); i++) actions.push_back(original.getActionAt(i));
+
+    std::string details = replayFailure(actions, 0);
+    if (details.empty() || (kind == FailureKind::CRASH && details != "crash")) return false;
+
+    if (autoDetect && details.compare(0, INVARIANT_PREFIX.size(), INVARIANT_PREFIX) != 0)
+        kind = FailureKind::MISMATCH;
+
+    signature = signatureOf(details);
+    return !signature.empty();
+}
+
+//////////////////////////////////////////      firstReproducing      //////////////////////////////////////////
+
+// Candidates replay in waves of two per worker; the lowest index that reproduces in the
+// first successful wave wins, so the result does not depend on thread timing
+size_t Minimizer::firstReproducing(const std::vector<std::vector<ActionRecord>> &candidates) const
+{
+    WorkStealingPool pool(threads);
+    size_t wave = pool.getWorkerCount() * 2;
+
+    for (size_t start = 0; start < candidates.size(); start += wave)
+    {
+        size_t count = std::min(wave, candidates.size() - start);
+        std::vector<char> failed(count, 0);
+
+        pool.run(count, [&](size_t i) { failed[i] = reproduces(candidates[start + i], i) ? 1 : 0; });
+
+        for (size_t i = 0; i < count; i++)
+            if (failed[i]) return start + i;
+    }
+    return candidates.size();
+}
+
+//////////////////////////////////////////          minimize          //////////////////////////////////////////
+
+std::vector<ActionRecord> Minimizer::minimize()
+{
+    std::vector<ActionRecord> current;
+    for (size_t i = 0; i < original.getActionCount(); i++) current.push_back(original.getActionAt(i));
+
+    // The failure may not need any input at all
+    if (reproduces({}, 0)) return {};
+
+    size_t n = 2;
+    while (current.size() >= 2)
+    {
+        n = std::min(n, current.size());
+
+        // Chunks first (jump straight to a small piece), then complements (drop one piece).
+        // With two chunks every complement is the other chunk.
+        std::vector<std::vector<ActionRecord>> candidates;
+        for (size_t i = 0; i < n; i++) candidates.push_back(chunkOf(current, i, n));
+        if (n > 2)
+            for (size_t i = 0; i < n; i++) candidates.push_back(complementOf(current, i, n));
+
+        size_t found = firstReproducing(candidates);
+
+        if (found < n)
+        {
+            current = candidates[found];
+            n = 2;
+        }
+        else if (found < candidates.size())
+        {
+            current = candidates[found];
+            n = std::max<size_t>(n - 1, 2);
+        }
+        else if (n >= current.size()) break;
+        else n = std::min(n * 2, current.size());
+    }
+
+    return current;
+}
+
+//////////////////////////////////////////            save            //////////////////////////////////////////
+
+// Writes the steps and a copy of the expected results next to them, so the pair
+// replays (and shows up in -batch) like any other recording
+bool Minimizer::save(const std::vector<ActionRecord> &actions, const std::string &outFile) const
+{
+    if (buildSteps(actions).saveToFile(outFile, RecordingFormat::TEXT) != ErrorCode::NONE) return false;
+
+    std::string outResult = resultFileFor(outFile);
+    if (outResult.empty()) return true;
+
+    std::error_code ec;
+    fs::copy_file(resultFile, outResult, fs::copy_options::overwrite_existing, ec);
+    return !ec;
+}
+
+//////////////////////////////////////////        runFromArgs         //////////////////////////////////////////
+
+int Minimizer::runFromArgs(int argc, char *argv[], int fileIndex)
+{
+    if (fileIndex >= argc)
+    {
+        std::cout << "Usage: game -minimize <steps file> [-predicate mismatch|invariant|crash] "
+                     "[-threads N] [-out file]" << std::endl;
+        return 1;
+    }
+
+    std::string stepsFile = argv[fileIndex];
+    size_t threadCount = 0;
+    std::string predicate;
+    std::string outFile;
+
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        std::string arg(argv[i]);
+        if (arg == "-threads") threadCount = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "-predicate") predicate = argv[i + 1];
+        else if (arg == "-out") outFile = argv[i + 1];
+    }
+
+    FailureKind failureKind = FailureKind::MISMATCH;
+    if (predicate == "invariant") failureKind = FailureKind::INVARIANT;
+    else if (predicate == "crash") failureKind = FailureKind::CRASH;
+    else if (!predicate.empty() && predicate != "mismatch")
+    {
+        std::cout << "Unknown predicate " << predicate << " (mismatch, invariant or crash)" << std::endl;
+        return 1;
+    }
+
+    // The child replays of -predicate crash need a path that survives a change of directory
+    std::string executable = argv[0];
+    if (executable.find('/') != std::string::npos || executable.find('\\') != std::string::npos)
+        executable = fs::absolute(executable).string();
+
+    if (outFile.empty())
+    {
+        size_t pos = stepsFile.rfind(".steps");
+        outFile = (pos == std::string::npos) ? stepsFile + ".min" : stepsFile.substr(0, pos) + ".min" + stepsFile.substr(pos);
+    }
+
+    Minimizer minimizer(stepsFile, executable, threadCount);
+    if (minimizer.load() != ErrorCode::NONE)
+    {
+        std::cout << "Could not load " << stepsFile << " and its result file" << std::endl;
+        return 1;
+    }
+
+    if (!minimizer.captureFailure(failureKind, predicate.empty()))
+    {
+        std::cout << "The recording does not fail, nothing to minimize" << std::endl;
+        return 1;
+    }
+    std::cout << "Failure: " << minimizer.getSignature() << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ActionRecord> actions = minimizer.minimize();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Reduced " << minimizer.getOriginalCount() << " actions to " << actions.size() << " in "
+              << minimizer.getReplayCount() << " replays (" << seconds << " s)" << std::endl;
+
+    if (!minimizer.save(actions, outFile))
+    {
+        std::cout << "Could not write " << outFile << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << outFile << std::endl;
+    return 0;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Recorder.h"
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////       FailureKind          //////////////////////////////////////////
+
+// What a reduced recording has to keep doing to count as the same failure
+enum class FailureKind
+{
+    MISMATCH,  // replay fails against the result file with the same first message
+    INVARIANT, // replay with -check breaks the same invariant (at any cycle)
+    CRASH      // `game -load -silent` on the recording exits abnormally
+};
+
+//////////////////////////////////////////         Minimizer          //////////////////////////////////////////
+
+// -minimize <steps file> [-predicate mismatch|invariant|crash] [-threads N] [-out file]:
+// delta debugging (ddmin) over the action list of a failing recording. Each round splits
+// the actions into n chunks and replays, headless and in parallel, every chunk and every
+// complement; the first candidate that still fails becomes the new recording. Ends when
+// no single chunk can be removed at chunk size 1. Crash candidates replay in a child
+// process, since a crash would take the minimizer down with it; one that hangs instead
+// is stopped by the stall guard or killed at a deadline.
+class Minimizer
+{
+    std::string stepsFile;
+    std::string resultFile;
+    std::string dataDir;
+    std::string executable;
+    std::string workDir;
+    size_t threads;
+
+    FailureKind kind;
+    RecordedSteps original;
+    std::string signature;
+    mutable std::atomic<size_t> replays;
+
+    RecordedSteps buildSteps(const std::vector<ActionRecord> &actions) const;
+    std::string replayFailure(const std::vector<ActionRecord> &actions, size_t slot) const;
+    std::string signatureOf(const std::string &details) const;
+    bool reproduces(const std::vector<ActionRecord> &actions, size_t slot) const;
+
+    // Index of the first candidate that reproduces, or candidates.size()
+    size_t firstReproducing(const std::vector<std::vector<ActionRecord>> &candidates) const;
+
+public:
+    Minimizer(const std::string &steps, const std::string &executablePath, size_t threadCount = 0);
+    ~Minimizer();
+
+    ErrorCode load();
+
+    // Replays the full recording and records how it fails; false when it does not.
+    // With autoDetect the kind becomes INVARIANT or MISMATCH, whichever the replay hits.
+    bool captureFailure(FailureKind failureKind, bool autoDetect);
+
+    std::vector<ActionRecord> minimize();
+    bool save(const std::vector<ActionRecord> &actions, const std::string &outFile) const;
+
+    FailureKind getKind() const { return kind; }
+    const std::string &getSignature() const { return signature; }
+    size_t getOriginalCount() const { return original.getActionCount(); }
+    size_t getReplayCount() const { return replays; }
+
+    // Exit status: 0 when the failure was reproduced and the reduced recording written,
+    // 1 otherwise (or on bad usage)
+    static int runFromArgs(int argc, char *argv[], int fileIndex);
+};
@@ -1,6 +1,7 @@
 //////////////////////////////////////       INCLUDES & FORWARDS       /////////////////////////////////////////////
 
 #include "Momentum.h"
+#include "Snapshot.h"
 
 //////////////////////////////////////////        Operator=       //////////////////////////////////////////
 Momentum &Momentum::operator=(const Momentum &other)
@@ -8,8 +9,7 @@ Momentum &Momentum::operator=(const Momentum &other)
     if (this != &other)
     {
         activeState = other.activeState;
-        dx = other.dx;
-        dy = other.dy;
+        velocity = other.velocity;
         launchFramesRemaining = other.launchFramesRemaining;
         launchDir = other.launchDir;
     }
@@ -20,8 +20,29 @@ Momentum &Momentum::operator=(const Momentum &other)
 void Momentum::resetMomentum()
     {
         activeState = false;
-        dx = 0;
-        dy = 0;
+        velocity = Velocity();
         launchFramesRemaining = 0;
         launchDir = Direction::STAY;
-    }
\ No newline at end of file
+    }
+
+/////////////////////////////////////////////    saveState / loadState    //////////////////////////////////////////
+
+// Velocity is stored as raw fixed-point so a restored body steps bit-for-bit the same
+void Momentum::saveState(StateWriter &out) const
+{
+    out.writeBool(activeState);
+    out.writeInt(velocity.x.getRaw());
+    out.writeInt(velocity.y.getRaw());
+    out.writeInt(launchFramesRemaining);
+    out.writeEnum(launchDir);
+}
+
+void Momentum::loadState(StateReader &in)
+{
+    activeState = in.readBool();
+    Fixed x = Fixed::fromRaw(static_cast<int32_t>(in.readInt()));
+    Fixed y = Fixed::fromRaw(static_cast<int32_t>(in.readInt()));
+    velocity = Velocity(x, y);
+    launchFramesRemaining = static_cast<int>(in.readInt());
+    launchDir = in.readEnum<Direction>();
+}
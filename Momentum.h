@@ -3,39 +3,43 @@
 //////////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
 #include "Console.h"
 #include "Constants.h"
+#include "Physics.h"
+
+class StateWriter;
+class StateReader;
 
 //////////////////////////////////////////          Momentum          //////////////////////////////////////////
-// Momentum representation class
+// Momentum representation class - a launched body stepped by Physics
 class Momentum
 {
     bool activeState;
-    int dx;
-    int dy;
+    Velocity velocity;
     int launchFramesRemaining;
     Direction launchDir;
 
 public:
-    Momentum() : activeState(false), dx(0), dy(0), launchFramesRemaining(0), launchDir(Direction::STAY) {}
+    Momentum() : activeState(false), velocity(), launchFramesRemaining(0), launchDir(Direction::STAY) {}
 
     Momentum &operator=(const Momentum &other);
     Momentum(const Momentum &other)
-        : activeState(other.activeState), dx(other.dx), dy(other.dy),
+        : activeState(other.activeState), velocity(other.velocity),
           launchFramesRemaining(other.launchFramesRemaining), launchDir(other.launchDir) {}
 
     // Getters
     bool isActive() const { return activeState; }
-    int getDX() const { return dx; }
-    int getDY() const { return dy; }
+    const Velocity &getVelocity() const { return velocity; }
+    int getDX() const { return velocity.x.toInt(); }
+    int getDY() const { return velocity.y.toInt(); }
     int getLaunchFramesRemaining() const { return launchFramesRemaining; }
     Direction getLaunchDir() const { return launchDir; }
 
     // Setters
     void setActive(bool state) { activeState = state; }
-    void setDX(int deltaX) { dx = deltaX; }
-    void setDY(int deltaY) { dy = deltaY; }
+    void setVelocity(const Velocity &v) { velocity = v; }
     void setLaunchFramesRemaining(int frames) { launchFramesRemaining = frames; }
     void setLaunchDir(Direction dir) { launchDir = dir; }
     void resetMomentum();
-    void incrementDX(int deltaX) { dx += deltaX; }
-    void incrementDY(int deltaY) { dy += deltaY; }
+
+    void saveState(StateWriter &out) const;
+    void loadState(StateReader &in);
 };
@@ -7,48 +7,69 @@
 #include "Constants.h"
 #include "Constants.h"
 #include <string>
+#include <sstream>
 #include <random>
+#include <cstdlib>
 #include "LevelLoader.h"
 
 //////////////////////////////////////////     NormalGame Constructor     /////////////////////////////////////////////
 
-NormalGame::NormalGame() : Game() {}
+NormalGame::NormalGame() : Game() { prefetchEnabled = true; }
 
 /////////////////////////////////////     NormalGame Constructor (with args)     /////////////////////////////////////////////
 
 NormalGame::NormalGame(int argc, char* argv[]) : NormalGame()
 {
+    GameContext::Scope bind(context);
+
     init_console();
     hideCursor();
     clrscr();
     consoleInitialized = true;
 
     saveMode = false;
+    bool devMode = false;
 
     for (int i = 1; i < argc; i++)
     {
         std::string arg(argv[i]);
 
         if (arg == "-save") saveMode = true;
+        else if (arg == "-hash-interval" && i + 1 < argc) hashInterval = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "-shadow") shadowMode = true;
+        else if (arg == "-shadow-interval" && i + 1 < argc) shadowInterval = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "-dev") devMode = true;
+        else if (arg == "-resident" && i + 1 < argc) residentLimit = std::strtoul(argv[++i], nullptr, 10);
+    }
+
+    // Rooms rebuilt from edited files mid-game would never replay, so -dev records nothing
+    if (devMode)
+    {
+        saveMode = false;
+        shadowMode = false;
+        levelWatcher.start(context.dataDir);
     }
 
+    randomSeed = std::random_device{}();
+
     if (saveMode)
     {
         enableRecording("adv-world.steps.txt");
         resultFile.open("adv-world.result.txt");
-        
-        randomSeed = std::random_device{}();
         writeStepsHeader();
-        
-        initializeRooms(randomSeed);
     }
-    else initializeRooms();
+
+    // The levels are parsed and built on every core while the main menu is up;
+    // the first game waits for them only if it starts before they are done
+    unsigned int seed = randomSeed;
+    pendingLevels = std::async(std::launch::async, [this, seed]() { return loadLevels(seed, 0); });
 }
 
 //////////////////////////////////////////     NormalGame Destructor     /////////////////////////////////////////////
 
 NormalGame::~NormalGame()
 {
+    GameContext::Scope bind(context);
     disableRecording();
     if (resultFile.is_open()) resultFile.close();
     
@@ -63,6 +84,7 @@ NormalGame::~NormalGame()
 
 void NormalGame::run()
 {
+  GameContext::Scope bind(context);
   bool running = true;
 
   while (running)
@@ -91,7 +113,7 @@ void NormalGame::run()
     case GameState::inGame:
       if (!gameInitialized)
       {
-          rooms.clear();
+          clearRooms();
           startNewGame();
       }
       gameLoop();
@@ -242,12 +264,43 @@ void NormalGame::gameLoop()
 
   while (currentState == GameState::inGame)
   {
+    recordKeyframe();
+    recordStateHashes();
+    applyLevelEdits();
     handleInput();
     update();
     Renderer::sleep_ms(100);
   }
 }
 
+//////////////////////////////////////////      applyLevelEdits       /////////////////////////////////////////////
+
+// -dev: rebuilds the rooms whose level files were saved since the last tick. Waits while
+// a riddle is open, since the riddle belongs to the room that would be replaced.
+void NormalGame::applyLevelEdits()
+{
+    if (!levelWatcher.isWatching() || aRiddle.isActive()) return;
+
+    bool redraw = false;
+    std::string problem;
+
+    for (const std::string &name : levelWatcher.poll())
+    {
+        ErrorCode err = reloadLevel(name);
+
+        if (err == ErrorCode::NONE)
+        {
+            if (currentRoomId >= 0 && currentRoomId < static_cast<int>(levelNames.size()) && levelNames[currentRoomId] == name)
+                redraw = true;
+        }
+        else if (err == ErrorCode::INVALID_FORMAT) problem = name + ": not reloaded, could not be parsed";
+        else if (err != ErrorCode::FILE_NOT_FOUND) problem = name + ": not reloaded, invalid legend placement";
+    }
+
+    if (redraw) redrawCurrentRoom();
+    if (!problem.empty()) Renderer::printAt(0, 0, problem);
+}
+
 //////////////////////////////////////////        changeRoom          /////////////////////////////////////////////
 
 void NormalGame::changeRoom(int newRoomId, bool goingForward)
@@ -299,12 +352,54 @@ void NormalGame::handleInput()
 
 void NormalGame::recordAction(const PlayerKeyBinding& binding)
 {
+    ActionRecord record(cycleCount, binding);
+    shadow.feedAction(record);
+
     if (!isRecording || !recordFile.is_open()) return;
 
-    ActionRecord record(cycleCount, binding);
+    recordFile.writeRecord(record);
+}
+
+//////////////////////////////////////////        recordKeyframe      /////////////////////////////////////////////
 
-    record.write(recordFile);
-    recordFile.flush();
+// Taken before the cycle's input, matching where LoadedGame resumes after a seek.
+// A pause re-enters the loop on the same cycle, hence the duplicate guard.
+void NormalGame::recordKeyframe()
+{
+    if (!isRecording || !recordFile.is_open()) return;
+    if (cycleCount == 0 || cycleCount % KEYFRAME_INTERVAL != 0 || cycleCount == lastKeyframeCycle) return;
+    if (aRiddle.isActive()) return;
+
+    lastKeyframeCycle = cycleCount;
+    recordFile.writeRecord(Keyframe(cycleCount, captureKeyframe()));
+}
+
+//////////////////////////////////////////      recordStateHashes     /////////////////////////////////////////////
+
+// Same point in the cycle as recordKeyframe, so the result file and the shadow replica
+// are both compared where -load would be. One digest serves both when their intervals
+// meet; -hash-interval 0 turns result hashes off.
+void NormalGame::recordStateHashes()
+{
+    if (aRiddle.isActive()) return;
+
+    bool toResult = resultFile.is_open() && hashInterval != 0 && cycleCount % hashInterval == 0 &&
+                    cycleCount >= nextHashCycle;
+    bool toShadow = shadow.isRunning() && shadowInterval != 0 && cycleCount % shadowInterval == 0 &&
+                    cycleCount >= nextShadowCycle;
+    if (!toResult && !toShadow) return;
+
+    StateDigest digest = digestState();
+    if (toResult)
+    {
+        nextHashCycle = cycleCount + 1;
+        resultFile.writeRecord(GameEvent(cycleCount, currentRoomId, digest.parts));
+    }
+    if (toShadow)
+    {
+        nextShadowCycle = cycleCount + 1;
+        shadow.feedDigest(cycleCount, digest);
+    }
 }
 
 ///////////////////////////////////////////    enableRecording    /////////////////////////////////////////////
@@ -330,8 +425,7 @@ void NormalGame::reportScreenChange(int roomId)
     if (resultFile.is_open())
     {
         GameEvent event(cycleCount, roomId);
-        event.write(resultFile);
-        resultFile.flush();
+        resultFile.writeRecord(event);
     }
 }
 
@@ -342,19 +436,17 @@ void NormalGame::reportLifeLost(int playerId)
     if (!resultFile.is_open()) return;
 
     GameEvent event(cycleCount, currentRoomId, playerId);
-    event.write(resultFile);
-    resultFile.flush();
+    resultFile.writeRecord(event);
 }
 
 ///////////////////////////////////////////    onRiddleAttempt    /////////////////////////////////////////////
 
-void NormalGame::onRiddleAttempt(const std::string& question, int answer, bool correct)
+void NormalGame::onRiddleAttempt(std::string_view question, int answer, bool correct)
 {
     if (!resultFile.is_open()) return;
 
     GameEvent event(cycleCount, currentRoomId, question, answer, correct);
-    event.write(resultFile);
-    resultFile.flush();
+    resultFile.writeRecord(event);
 }
 
 //////////////////////////////////////////     handlePauseInput     /////////////////////////////////////////////
@@ -383,22 +475,22 @@ void NormalGame::reportQuit()
     if (!resultFile.is_open()) return;
 
     GameEvent event(cycleCount, currentRoomId, GameEventType::QUIT);
-    event.write(resultFile);
-    resultFile.flush();
+    resultFile.writeRecord(event);
 }
 
 ///////////////////////////////////////////    reportRiddleAnswer    /////////////////////////////////////////////
 
 void NormalGame::reportRiddleAnswer(int answer)
 {
-    if (!isRecording || !recordFile.is_open()) return;
-    
     int playerId = 1;
     if (aRiddle.isActive() && aRiddle.player != nullptr) playerId = aRiddle.player->getId();
     
     ActionRecord ar(cycleCount, playerId, answer);
-    ar.write(recordFile);
-    recordFile.flush();
+    shadow.feedAction(ar);
+
+    if (!isRecording || !recordFile.is_open()) return;
+
+    recordFile.writeRecord(ar);
 }
 
 ///////////////////////////////////////////    getRiddleInput    /////////////////////////////////////////////
@@ -415,19 +507,18 @@ void NormalGame::writeStepsHeader()
 {
     if (!isRecording || !recordFile.is_open()) return;
     
-    recordFile.seekp(0);
-    
-    recordFile << "RANDOM_SEED: " << randomSeed << " SCREENS: ";
+    std::ostringstream header;
+    header << "RANDOM_SEED: " << randomSeed << " SCREENS: ";
     
     std::vector<std::string> levelFiles = LevelLoader::discoverLevelFiles();
     for (size_t i = 0; i < levelFiles.size(); i++) {
-        recordFile << levelFiles[i];
-        if (i < levelFiles.size() - 1) recordFile << ",";
+        header << levelFiles[i];
+        if (i < levelFiles.size() - 1) header << ",";
     }
     
-    recordFile << " COLOR_MODE: " << (colorMode ? "ON" : "OFF");
-    recordFile << "           \n";
-    recordFile.flush();
+    header << " COLOR_MODE: " << (context.colorMode ? "ON" : "OFF");
+    header << "           \n";
+    recordFile.setHeader(header.str());
 }
 
 //////////////////////////////////////////     handleMainMenuInput     /////////////////////////////////////////////
@@ -444,7 +535,7 @@ void NormalGame::handleMainMenuInput()
       currentState = GameState::inGame;
       break;
     case '2':
-      colorMode = !colorMode;
+      context.colorMode = !context.colorMode;
       toggleColorModeBanner();
       writeStepsHeader();
       break;
@@ -463,16 +554,19 @@ void NormalGame::handleMainMenuInput()
 void NormalGame::toggleColorModeBanner()
 {
   Renderer::gotoxy(47, 10);
-  std::cout << "     ";
+  Renderer::print("     ");
   Renderer::gotoxy(47, 10);
-  std::cout << (colorMode ? "(ON)" : "(OFF)");
-  std::cout.flush();
+  Renderer::print(context.colorMode ? "(ON)" : "(OFF)");
+  Renderer::flush();
 }
 
 //////////////////////////////////////////     closeRecordingFiles     /////////////////////////////////////////////
 
+// Also where a session ends, so the shadow replica is wound down here
 void NormalGame::closeRecordingFiles()
 {
+    shadow.stop();
+
     if (!saveMode) return;
     
     disableRecording();
@@ -488,6 +582,8 @@ void NormalGame::resetRecordingFiles()
     closeRecordingFiles();
     enableRecording("adv-world.steps.txt");
     resultFile.open("adv-world.result.txt");
+    lastKeyframeCycle = 0;
+    nextHashCycle = 0;
     randomSeed = std::random_device{}();
     writeStepsHeader();
 }
@@ -496,12 +592,31 @@ void NormalGame::resetRecordingFiles()
 
 void NormalGame::startNewGame()
 {
-    if (saveMode && (!isGameInitialized() || !recordFile.is_open()))
+    if (pendingLevels.valid())
+    {
+        // First game: the rooms built behind the menu, from the seed picked at startup
+        LevelSet levels = pendingLevels.get();
+        adoptLevels(levels);
+        if (currentState == GameState::error) return;
+    }
+    else if (saveMode && (!isGameInitialized() || !recordFile.is_open()))
     {
         resetRecordingFiles();
-        rooms.clear();
+        clearRooms();
+        initializeRooms(randomSeed);
+    }
+    else if (shadowMode && !saveMode && rooms.empty())
+    {
+        // The replica needs the seed, which initializeRooms() would keep to itself
+        randomSeed = std::random_device{}();
         initializeRooms(randomSeed);
     }
     
     Game::startNewGame();
+
+    if (shadowMode && !shadow.isRunning() && currentState != GameState::error)
+    {
+        nextShadowCycle = 0;
+        shadow.start(randomSeed, context.dataDir, context.colorMode, "adv-world.shadow.txt");
+    }
 }
\ No newline at end of file
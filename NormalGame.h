@@ -1,8 +1,11 @@
 #pragma once
 
 #include "Game.h"
+#include "LevelWatcher.h"
 #include "Recorder.h"
-#include <fstream>
+#include "RecordingWriter.h"
+#include "ShadowChecker.h"
+#include <future>
 
 using namespace std;
 
@@ -10,11 +13,28 @@ class NormalGame : public Game
 {
     bool isRecording;
     bool saveMode;
-    ofstream recordFile;
-    ofstream resultFile;
+    RecordingWriter recordFile;
+    RecordingWriter resultFile;
     unsigned int randomSeed = 0;
+    unsigned long lastKeyframeCycle = 0;
+    unsigned long hashInterval = DEFAULT_HASH_INTERVAL;
+    unsigned long nextHashCycle = 0;
+    bool shadowMode = false;
+    ShadowChecker shadow;
+    unsigned long shadowInterval = DEFAULT_HASH_INTERVAL;
+    unsigned long nextShadowCycle = 0;
+    std::future<LevelSet> pendingLevels;
+    LevelWatcher levelWatcher;
+
+    // A full-state keyframe every KEYFRAME_INTERVAL cycles lets -load -seek skip ahead
+    static const unsigned long KEYFRAME_INTERVAL = 1000;
+    // HASH events in the result file let a failing replay locate where it diverged
+    static const unsigned long DEFAULT_HASH_INTERVAL = 100;
 
     void recordAction(const PlayerKeyBinding& binding);
+    void recordKeyframe();
+    void recordStateHashes();
+    void applyLevelEdits();
     void writeStepsHeader();
     void toggleColorModeBanner();
     void closeRecordingFiles();
@@ -23,7 +43,7 @@ class NormalGame : public Game
 protected:
     void reportScreenChange(int roomId) override;
     void reportLifeLost(int playerId) override;
-    void onRiddleAttempt(const std::string& question, int answer, bool correct) override;
+    void onRiddleAttempt(std::string_view question, int answer, bool correct) override;
     void reportQuit() override;
     int getRiddleInput(unsigned long cycle) override;
     void reportRiddleAnswer(int answer) override;
@@ -0,0 +1,390 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "ObservationServer.h"
+#include "Console.h"
+#include "LevelLoader.h"
+#include "Room.h"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <thread>
+
+#ifdef PLATFORM_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+namespace
+{
+    volatile std::sig_atomic_t stopRequested = 0;
+
+    void requestStop(int signal)
+    {
+        (void)signal;
+        stopRequested = 1;
+    }
+
+    // Sleeps until word may have changed from expected, or timeoutNs passed. Without
+    // futexes (not Linux) this is a short sleep, and the waiter polls.
+    void waitOn(std::atomic<uint32_t> &word, uint32_t expected, long timeoutNs)
+    {
+#ifdef __linux__
+        timespec timeout{0, timeoutNs};
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+#else
+        (void)word;
+        (void)expected;
+        std::this_thread::sleep_for(std::chrono::nanoseconds(std::min(timeoutNs, 50000L)));
+#endif
+    }
+
+    void wake(std::atomic<uint32_t> &word)
+    {
+#ifdef __linux__
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+        (void)word;
+#endif
+    }
+
+    // Plane of each grid char, -1 for none (air, and the legend's letters)
+    const int *planeOfChar()
+    {
+        static const std::vector<int> planes = []
+        {
+            std::vector<int> table(256, -1);
+            for (int p = 0; p < SHM_PLANE_COUNT; p++)
+            {
+                table[static_cast<unsigned char>(static_cast<char>(SHM_PLANE_TYPES[p]))] = p;
+                if (SHM_PLANE_TYPES[p] == ObjectType::DOOR)
+                    for (char digit = '0'; digit <= '9'; digit++) table[static_cast<unsigned char>(digit)] = p;
+            }
+            return table;
+        }();
+        return planes.data();
+    }
+
+    size_t alignTo64(size_t offset) { return (offset + 63) / 64 * 64; }
+}
+
+//////////////////////////////////////////        Constructor         //////////////////////////////////////////
+
+ObservationServer::ObservationServer(const std::string &regionName, size_t envCount, size_t threadCount,
+                                     unsigned int randomSeed, bool replaceStale)
+    : name(regionName), baseSeed(randomSeed), replaceRegion(replaceStale), failure(), envs(), steps(envCount, 0), resets(envCount, 0), answers(envCount, -1),
+      pool(threadCount), region(nullptr), regionSize(0), control(nullptr), batches(0), envSteps(0)
+{
+    for (size_t i = 0; i < envCount; i++)
+    {
+        envs.push_back(std::make_unique<Simulation>());
+        envs[i]->setGridObservation(false); // encode() reads the room itself
+        envs[i]->setRiddleAnswerer([this, i](const RiddleData &riddle, int playerId)
+        {
+            (void)riddle;
+            (void)playerId;
+            return answers[i];
+        });
+    }
+}
+
+ObservationServer::~ObservationServer()
+{
+    unmap();
+}
+
+#ifdef PLATFORM_UNIX
+
+//////////////////////////////////////////            map             //////////////////////////////////////////
+
+bool ObservationServer::map()
+{
+    const size_t actionsOffset = alignTo64(sizeof(ShmControl));
+    const size_t observationsOffset = alignTo64(actionsOffset + envs.size() * sizeof(ShmAction));
+    regionSize = observationsOffset + envs.size() * ENV_STRIDE;
+
+    // A region of this name may be another server's, live: only -replace takes it over
+    if (replaceRegion) shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        if (errno == EEXIST)
+            failure = "shared memory " + name + " already exists (another server, or a stale region: -replace removes it)";
+        else failure = "could not create shared memory " + name + ": " + std::strerror(errno);
+        return false;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(regionSize)) != 0)
+    {
+        failure = "could not size shared memory " + name + ": " + std::strerror(errno);
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    void *mapped = mmap(nullptr, regionSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        failure = "could not map shared memory " + name + ": " + std::strerror(errno);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    region = static_cast<unsigned char *>(mapped);
+    control = new (region) ShmControl();
+    control->version = SHM_VERSION;
+    control->envCount = static_cast<uint32_t>(envs.size());
+    control->viewWidth = VIEW_WIDTH;
+    control->viewHeight = VIEW_HEIGHT;
+    control->planeCount = SHM_PLANE_COUNT;
+    control->planeStride = static_cast<uint32_t>(PLANE_STRIDE);
+    control->envStride = static_cast<uint32_t>(ENV_STRIDE);
+    control->actionsOffset = actionsOffset;
+    control->observationsOffset = observationsOffset;
+    control->command = static_cast<uint32_t>(ShmCommand::STEP);
+
+    ShmAction *actions = reinterpret_cast<ShmAction *>(region + actionsOffset);
+    for (size_t i = 0; i < envs.size(); i++) actions[i] = ShmAction{-1, -1, -1, 0};
+    return true;
+}
+
+//////////////////////////////////////////           unmap            //////////////////////////////////////////
+
+void ObservationServer::unmap()
+{
+    if (region == nullptr) return;
+
+    munmap(region, regionSize);
+    shm_unlink(name.c_str());
+    region = nullptr;
+    control = nullptr;
+}
+
+#else
+
+bool ObservationServer::map()
+{
+    failure = "shared memory needs a POSIX system";
+    return false;
+}
+
+void ObservationServer::unmap() {}
+
+#endif
+
+//////////////////////////////////////////           reset            //////////////////////////////////////////
+
+// Every game of the server gets its own seed
+void ObservationServer::reset(size_t env)
+{
+    unsigned long game = static_cast<unsigned long>(resets[env]) * envs.size() + env;
+    envs[env]->reset(baseSeed + static_cast<unsigned int>(game), ".");
+    steps[env] = 0;
+    resets[env]++;
+}
+
+//////////////////////////////////////////           encode           //////////////////////////////////////////
+
+// The env's observation, written in place into its block of the region. Planes come from
+// the room's base layout and overlays directly; the grid is never copied.
+void ObservationServer::encode(size_t env)
+{
+    const Observation &o = envs[env]->getObservation();
+    unsigned char *block = region + control->observationsOffset + env * ENV_STRIDE;
+
+    ShmEnvHeader *header = reinterpret_cast<ShmEnvHeader *>(block);
+    header->cycle = o.cycle;
+    header->steps = steps[env];
+    header->roomId = o.roomId;
+    header->state = static_cast<int32_t>(o.state);
+    header->roomWidth = o.width;
+    header->roomHeight = o.height;
+    header->viewX = o.viewX;
+    header->viewY = o.viewY;
+    header->resets = resets[env];
+
+    header->events = 0;
+    for (const GameEvent &event : o.events) header->events |= 1u << static_cast<int>(event.type);
+
+    for (int p = 0; p < 2; p++)
+    {
+        const PlayerObservation &player = o.players[p];
+        header->players[p] = ShmPlayer{player.x, player.y, static_cast<int32_t>(player.moving), player.lives, player.keys,
+                                       player.score, static_cast<int32_t>(static_cast<char>(player.item)),
+                                       player.alive, player.atDoor, player.launched};
+    }
+
+    unsigned char *planes = block + sizeof(ShmEnvHeader);
+    std::memset(planes, 0, SHM_PLANE_COUNT * PLANE_STRIDE);
+
+    const Room *room = envs[env]->getCurrentRoom();
+    if (room == nullptr) return;
+
+    const int *planeOf = planeOfChar();
+    const Screen *layout = room->getBaseLayout();
+    auto baseAt = [layout](int x, int y) { return layout != nullptr ? layout->getCharAt(x, y) : 'W'; };
+    auto flip = [planes](int plane, size_t bit)
+    {
+        if (plane >= 0) planes[plane * PLANE_STRIDE + bit / 8] ^= static_cast<unsigned char>(1u << (bit % 8));
+    };
+
+    const int rows = std::min(VIEW_HEIGHT, o.height - o.viewY);
+    const int cols = std::min(VIEW_WIDTH, o.width - o.viewX);
+    for (int y = 0; y < rows; y++)
+        for (int x = 0; x < cols; x++)
+            flip(planeOf[static_cast<unsigned char>(baseAt(o.viewX + x, o.viewY + y))], static_cast<size_t>(y) * VIEW_WIDTH + x);
+
+    // Each overlay moves its cell from the base char's plane to its own
+    for (const Modification &mod : room->getModifications())
+    {
+        int x = mod.x - o.viewX, y = mod.y - o.viewY;
+        if (x < 0 || x >= cols || y < 0 || y >= rows) continue;
+
+        size_t bit = static_cast<size_t>(y) * VIEW_WIDTH + x;
+        int before = planeOf[static_cast<unsigned char>(baseAt(mod.x, mod.y))];
+        int after = planeOf[static_cast<unsigned char>(mod.newChar)];
+        if (before == after) continue;
+        flip(before, bit);
+        flip(after, bit);
+    }
+}
+
+//////////////////////////////////////////       waitForRequest       //////////////////////////////////////////
+
+// Spins briefly (an agent stepping in a loop answers within microseconds), then sleeps on
+// the futex, waking every millisecond for agents that poll and for SIGINT
+bool ObservationServer::waitForRequest(uint32_t served, uint32_t &request)
+{
+    for (int spin = 0; spin < 4000; spin++)
+    {
+        request = control->request.load(std::memory_order_acquire);
+        if (request != served) return true;
+    }
+
+    while (!stopRequested)
+    {
+        waitOn(control->request, served, 1000000);
+        request = control->request.load(std::memory_order_acquire);
+        if (request != served) return true;
+    }
+    return false;
+}
+
+//////////////////////////////////////////            run             //////////////////////////////////////////
+
+bool ObservationServer::run()
+{
+    if (!map()) return false;
+
+    pool.run(envs.size(), [this](size_t i) { reset(i); });
+    for (const std::unique_ptr<Simulation> &env : envs)
+        if (env->getError() != ErrorCode::NONE || env->getObservation().state == GameState::error)
+        {
+            failure = "the levels did not load";
+            return false;
+        }
+    pool.run(envs.size(), [this](size_t i) { encode(i); });
+
+    control->magic.store(SHM_MAGIC, std::memory_order_release);
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    const ShmAction *actions = reinterpret_cast<const ShmAction *>(region + control->actionsOffset);
+    uint32_t served = 0, request = 0;
+
+    while (waitForRequest(served, request))
+    {
+        served = request;
+        if (control->command == static_cast<uint32_t>(ShmCommand::QUIT)) break;
+
+        pool.run(envs.size(), [&](size_t i)
+        {
+            ShmAction action = actions[i];
+            if (action.reset != 0) reset(i);
+            else
+            {
+                auto key = [](int8_t value) -> std::optional<Action>
+                {
+                    if (value < static_cast<int8_t>(Action::MOVE_UP) || value > static_cast<int8_t>(Action::DROP_ITEM)) return std::nullopt;
+                    return static_cast<Action>(value);
+                };
+
+                answers[i] = action.answer >= 0 && action.answer <= 3 ? action.answer : -1;
+                if (!envs[i]->isOver()) steps[i]++;
+                envs[i]->step(key(action.player1), key(action.player2));
+            }
+            encode(i);
+        });
+
+        batches++;
+        envSteps += envs.size();
+
+        control->response.store(served, std::memory_order_release);
+        wake(control->response);
+    }
+
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    return true;
+}
+
+//////////////////////////////////////////        runFromArgs         //////////////////////////////////////////
+
+int ObservationServer::runFromArgs(int argc, char *argv[])
+{
+    size_t envCount = 16;
+    size_t threadCount = 0;
+    std::string regionName = "/adv-world";
+    unsigned int seed = 1;
+    bool replaceStale = false;
+
+    for (int i = 1; i < argc; i++)
+        if (std::string(argv[i]) == "-replace") replaceStale = true;
+
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        std::string arg(argv[i]);
+        if (arg == "-envs") envCount = std::max<size_t>(1, std::strtoul(argv[i + 1], nullptr, 10));
+        else if (arg == "-name") regionName = argv[i + 1];
+        else if (arg == "-threads") threadCount = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "-seed") seed = static_cast<unsigned int>(std::strtoul(argv[i + 1], nullptr, 10));
+    }
+
+    if (LevelLoader::discoverLevelFiles(".").empty())
+    {
+        std::cout << "No level files found in the current directory" << std::endl;
+        return 1;
+    }
+    if (regionName.empty() || regionName[0] != '/') regionName = "/" + regionName;
+
+    ObservationServer server(regionName, envCount, threadCount, seed, replaceStale);
+    std::cout << "Serving " << envCount << " envs on shared memory " << regionName << " ("
+              << envCount * ENV_STRIDE / 1024 << " KiB of observations), " << server.pool.getWorkerCount()
+              << " workers (Ctrl-C stops)" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    if (!server.run())
+    {
+        std::cout << "Could not serve: " << server.getFailure() << std::endl;
+        return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Served " << server.batches << " batches, " << server.envSteps << " env steps in " << seconds << " s ("
+              << static_cast<unsigned long>(seconds > 0 ? server.envSteps / seconds : 0) << " steps/s)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Constants.h"
+#include "Simulation.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////      Shared memory layout      //////////////////////////////////////////
+
+// -shm region, in order: ShmControl, envCount ShmActions (at actionsOffset), then envCount
+// observation blocks of envStride bytes (at observationsOffset), each a ShmEnvHeader
+// followed by planeCount bit-planes of planeStride bytes. A plane covers the
+// viewWidth x viewHeight cells from (viewX, viewY): cell (x, y) is bit (y * viewWidth + x) % 8
+// of byte (y * viewWidth + x) / 8, set when the cell holds SHM_PLANE_TYPES[plane].
+// Players are not in the planes. All fields are native-endian.
+
+static const ObjectType SHM_PLANE_TYPES[] = {
+    ObjectType::WALL, ObjectType::BREAKABLE_WALL, ObjectType::SPRING, ObjectType::OBSTACLE_BLOCK,
+    ObjectType::TORCH, ObjectType::BOMB, ObjectType::KEY, ObjectType::SWITCH_OFF,
+    ObjectType::SWITCH_ON, ObjectType::RIDDLE, ObjectType::DOOR, ObjectType::SWITCH_WALL}; // doors: any digit or 'D'
+static const int SHM_PLANE_COUNT = sizeof(SHM_PLANE_TYPES) / sizeof(SHM_PLANE_TYPES[0]);
+
+static const uint32_t SHM_MAGIC = 0x424f5741; // "AWOB"
+static const uint32_t SHM_VERSION = 1;
+
+enum class ShmCommand : uint32_t
+{
+    STEP = 0, // every env steps (or resets, see ShmAction::reset)
+    QUIT = 1  // the server unmaps, removes the region and exits
+};
+
+struct ShmControl
+{
+    std::atomic<uint32_t> magic; // SHM_MAGIC, written last, once the first observations are in place
+    uint32_t version;
+    uint32_t envCount;
+    uint32_t viewWidth, viewHeight;
+    uint32_t planeCount;
+    uint32_t planeStride;
+    uint32_t envStride;
+    uint64_t actionsOffset;
+    uint64_t observationsOffset;
+    uint32_t command; // ShmCommand for the next request
+
+    // Handshake: the agent writes the actions and the command, then bumps request and
+    // wakes it (futex); the server writes every observation in place, then sets response
+    // to the request it served and wakes that. Agents that cannot futex may poll both.
+    alignas(64) std::atomic<uint32_t> request;
+    alignas(64) std::atomic<uint32_t> response;
+};
+
+struct ShmAction
+{
+    int8_t player1; // Action to press, -1 for none
+    int8_t player2;
+    int8_t answer;  // riddle answer (0-3) if the step opens one, -1 escapes it
+    uint8_t reset;  // non-zero: start a new game instead of stepping
+};
+
+struct ShmPlayer
+{
+    int32_t x, y;
+    int32_t direction; // Direction
+    int32_t lives, keys, score;
+    int32_t item; // ObjectType char, ' ' when empty-handed
+    int32_t alive, atDoor, launched;
+};
+
+struct ShmEnvHeader
+{
+    uint64_t cycle;
+    uint64_t steps; // since the last reset
+    int32_t roomId;
+    int32_t state; // GameState: inGame until the game is won or lost
+    int32_t roomWidth, roomHeight;
+    int32_t viewX, viewY;
+    uint32_t events; // bit GameEventType set when one was reported during the step
+    uint32_t resets;
+    ShmPlayer players[2];
+};
+
+static_assert(sizeof(ShmAction) == 4, "ShmAction is part of the -shm layout");
+static_assert(sizeof(ShmPlayer) == 40, "ShmPlayer is part of the -shm layout");
+static_assert(sizeof(ShmEnvHeader) == 128, "ShmEnvHeader is part of the -shm layout");
+
+//////////////////////////////////////////     ObservationServer      //////////////////////////////////////////
+
+// -shm [-envs N] [-name /name] [-threads N] [-seed S] [-replace]: N simulations of the level
+// files in the current directory behind one POSIX shared memory region (layout above) for an
+// agent in another process. Each request steps the whole batch on the pool; every env encodes
+// its planes from its room's cells straight into the region, which the agent reads in place.
+// An existing region of the same name is an error; -replace removes one left by a server
+// that did not exit cleanly.
+class ObservationServer
+{
+    std::string name;
+    unsigned int baseSeed;
+    bool replaceRegion;
+    std::string failure;
+
+    std::vector<std::unique_ptr<Simulation>> envs;
+    std::vector<uint64_t> steps;
+    std::vector<uint32_t> resets;
+    std::vector<int> answers; // riddle answer of each env's current step
+    WorkStealingPool pool;
+
+    unsigned char *region;
+    size_t regionSize;
+    ShmControl *control;
+
+    unsigned long batches;
+    unsigned long envSteps;
+
+    bool map();
+    void unmap();
+    void reset(size_t env);
+    void encode(size_t env);
+    bool waitForRequest(uint32_t served, uint32_t &request);
+
+public:
+    static const int VIEW_WIDTH = MAX_X;
+    static const int VIEW_HEIGHT = MAX_Y;
+    static const size_t PLANE_STRIDE = ((VIEW_WIDTH * VIEW_HEIGHT + 7) / 8 + 63) / 64 * 64;
+    static const size_t ENV_STRIDE = sizeof(ShmEnvHeader) + SHM_PLANE_COUNT * PLANE_STRIDE;
+
+    ObservationServer(const std::string &regionName, size_t envCount, size_t threadCount, unsigned int randomSeed,
+                      bool replaceStale = false);
+    ~ObservationServer();
+
+    // Serves requests until QUIT, SIGINT or SIGTERM; false (getFailure()) when the region
+    // could not be created or the levels did not load
+    bool run();
+    const std::string &getFailure() const { return failure; }
+
+    // Exit status: 0 after serving until QUIT or a signal, 1 when the server could not start
+    static int runFromArgs(int argc, char *argv[]);
+};
@@ -5,6 +5,7 @@
 #include "Room.h"
 #include "Player.h"
 #include "Renderer.h"
+#include "Snapshot.h"
 
 //////////////////////////////////////////         Constructor         /////////////////////////////////////////////
 
@@ -61,16 +62,21 @@ bool Obstacle::move(Direction dir, Room *room, int force)
         if (room->isBlocked(pos.getX() + dx, pos.getY() + dy)) return false;
     }
 
+    // Clear every old cell before drawing any new one: a block moving into a cell
+    // another block just left must not be erased by that block's clear
     for (ObstacleBlock *block : blocks)
     {
         Point oldPos = block->getPosition();
-        Point newPos(oldPos.getX() + dx, oldPos.getY() + dy);
-
         room->setCharAt(oldPos.getX(), oldPos.getY(), ' ');
-        Renderer::printAt(oldPos.getX(), oldPos.getY(), ' ');
+        Renderer::printCell(oldPos.getX(), oldPos.getY(), ' ');
+    }
 
-        block->setPosition(newPos);
+    for (ObstacleBlock *block : blocks)
+    {
+        Point oldPos = block->getPosition();
+        Point newPos(oldPos.getX() + dx, oldPos.getY() + dy);
 
+        block->setPosition(newPos);
         room->setCharAt(newPos.getX(), newPos.getY(), block->getSprite());
     }
 
@@ -108,6 +114,9 @@ std::vector<Direction> ObstacleBlock::neighborsToEdgeDirections(std::unordered_m
 
 void Obstacle::initEdges(std::unordered_map<Point, std::vector<Point>> &neighbors)
 {
+    // reconstruct() rebuilds the edges after blocks were destroyed; drop the old ones
+    edges.clear();
+
     for (auto &block : blocks)
     {
         if (neighbors.find(block->getPosition()) != neighbors.end())
@@ -173,7 +182,12 @@ void Obstacle::reconstruct(Room *room)
     for (ObstacleBlock *block : blocks)
         if (block && block->isActive()) remaining.push_back(block);
 
-    if (remaining.empty()) return;
+    if (remaining.empty())
+    {
+        blocks.clear();
+        needsReconstructionFlag = false;
+        return;
+    }
 
     std::vector<std::vector<ObstacleBlock *>> components = findConnectedComponents(remaining);
 
@@ -314,4 +328,84 @@ std::unordered_map<Point, std::vector<Point>> Obstacle::buildNeighborsMap(
     }
 
     return neighbors;
-}
\ No newline at end of file
+}
+
+//////////////////////////////////////////  saveState / loadState  //////////////////////////////////////////
+
+void ObstacleBlock::saveState(StateWriter &out) const
+{
+    GameObject::saveState(out);
+    out.writeInt(blockIndex);
+    out.writeBool(is_edge);
+}
+
+void ObstacleBlock::loadState(StateReader &in)
+{
+    GameObject::loadState(in);
+    blockIndex = static_cast<int>(in.readInt());
+    is_edge = in.readBool();
+}
+
+static void writeBlockList(StateWriter &out, const std::vector<ObstacleBlock *> &list, const ObjectIndex &indexOf)
+{
+    out.writeUInt(list.size());
+    for (ObstacleBlock *block : list)
+    {
+        auto it = indexOf.find(block);
+        out.writeInt(it != indexOf.end() ? it->second : -1);
+    }
+}
+
+static bool readBlockList(StateReader &in, const std::vector<GameObject *> &objects, std::vector<ObstacleBlock *> &list)
+{
+    list.clear();
+    size_t count = in.readCount();
+    for (size_t i = 0; i < count && in.ok(); i++)
+    {
+        long index = in.readInt();
+        if (index < 0 || index >= static_cast<long>(objects.size())) return false;
+
+        ObstacleBlock *block = dynamic_cast<ObstacleBlock *>(objects[index]);
+        if (block == nullptr) return false;
+        list.push_back(block);
+    }
+    return in.ok();
+}
+
+// Edge lists are saved per direction as-is (duplicates included) so move() sees the same lists
+void Obstacle::saveState(StateWriter &out, const ObjectIndex &indexOf) const
+{
+    writeBlockList(out, blocks, indexOf);
+
+    const Direction edgeDirs[4] = {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT};
+    for (Direction dir : edgeDirs)
+    {
+        auto it = edges.find(dir);
+        writeBlockList(out, it != edges.end() ? it->second : std::vector<ObstacleBlock *>(), indexOf);
+    }
+
+    out.writeInt(weight);
+    out.writeInt(accumulatedForce);
+    out.writeEnum(pushDirection);
+    out.writeBool(movedThisFrame);
+    out.writeBool(needsReconstructionFlag);
+}
+
+bool Obstacle::loadState(StateReader &in, const std::vector<GameObject *> &objects)
+{
+    if (!readBlockList(in, objects, blocks)) return false;
+
+    const Direction edgeDirs[4] = {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT};
+    for (Direction dir : edgeDirs)
+        if (!readBlockList(in, objects, edges[dir])) return false;
+
+    weight = static_cast<int>(in.readInt());
+    accumulatedForce = static_cast<int>(in.readInt());
+    pushDirection = in.readEnum<Direction>();
+    movedThisFrame = in.readBool();
+    needsReconstructionFlag = in.readBool();
+    pushers.clear();
+
+    for (ObstacleBlock *block : blocks) block->setParent(this);
+    return in.ok();
+}
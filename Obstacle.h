@@ -11,6 +11,8 @@
 class Room;
 class Player;
 class Obstacle;
+class StateWriter;
+class StateReader;
 
 ///////////////////////////////////////////      ObstacleBlock        //////////////////////////////////////////
 
@@ -24,6 +26,7 @@ public:
     ObstacleBlock(const Point &pos, Obstacle *parent)
         : StaticObject(pos, '*', ObjectType::OBSTACLE_BLOCK),
           parentObstacle(parent), blockIndex(-1), is_edge(false) {}
+    ObstacleBlock() : ObstacleBlock(Point(-1, -1), nullptr) {}
 
     GameObject *clone() const override { return new ObstacleBlock(*this); }
     const char *getName() const override { return "ObstacleBloack"; }
@@ -36,6 +39,9 @@ public:
     void setParent(Obstacle *parent) { parentObstacle = parent; }
     bool isEdge() const { return is_edge; }
     std::vector<Direction> neighborsToEdgeDirections(std::unordered_map<Point, std::vector<Point>> &neighbors);
+
+    void saveState(StateWriter &out) const override;
+    void loadState(StateReader &in) override;
 };
 
 //////////////////////////////////////////        Obstacle         //////////////////////////////////////////
@@ -75,4 +81,9 @@ public:
     void markForReconstruction() { needsReconstructionFlag = true; }
     bool needsReconstruction() const { return needsReconstructionFlag; }
     void reconstruct(Room *room);
+
+    // Blocks are stored as indices into the room's objects. Pushers are not saved:
+    // Room::resetAllObstaclePushStates clears them before every tick uses them.
+    void saveState(StateWriter &out, const ObjectIndex &indexOf) const;
+    bool loadState(StateReader &in, const std::vector<GameObject *> &objects);
 };
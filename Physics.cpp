@@ -0,0 +1,123 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       /////////////////////////////////////////////
+
+#include "Physics.h"
+#include "Momentum.h"
+
+//////////////////////////////////////////     oppositeDirection      //////////////////////////////////////////
+
+Direction Physics::oppositeDirection(Direction dir)
+{
+    switch (dir)
+    {
+    case Direction::UP:
+        return Direction::DOWN;
+    case Direction::DOWN:
+        return Direction::UP;
+    case Direction::LEFT:
+        return Direction::RIGHT;
+    case Direction::RIGHT:
+        return Direction::LEFT;
+    default:
+        return Direction::STAY;
+    }
+}
+
+//////////////////////////////////////////     directionVelocity      //////////////////////////////////////////
+
+Velocity Physics::directionVelocity(Direction dir, int speed)
+{
+    switch (dir)
+    {
+    case Direction::UP:
+        return Velocity::fromInts(0, -speed);
+    case Direction::DOWN:
+        return Velocity::fromInts(0, speed);
+    case Direction::LEFT:
+        return Velocity::fromInts(-speed, 0);
+    case Direction::RIGHT:
+        return Velocity::fromInts(speed, 0);
+    default:
+        return Velocity();
+    }
+}
+
+//////////////////////////////////////////        launchFrames        //////////////////////////////////////////
+
+int Physics::launchFrames(int compression) { return compression * compression; }
+
+//////////////////////////////////////////           launch           //////////////////////////////////////////
+
+// A spring compressed toward compressionDir throws the body the opposite way,
+// one cell per compressed link per tick, for compression^2 ticks
+Momentum Physics::launch(Direction compressionDir, int compression)
+{
+    Momentum body;
+    body.setActive(true);
+    body.setLaunchFramesRemaining(launchFrames(compression));
+
+    Direction launchDir = oppositeDirection(compressionDir);
+    body.setVelocity(directionVelocity(launchDir, compression));
+    body.setLaunchDir(launchDir);
+
+    return body;
+}
+
+//////////////////////////////////////////    perpendicularImpulse    //////////////////////////////////////////
+
+Velocity Physics::perpendicularImpulse(Direction launchDir, Direction inputDir)
+{
+    bool horizontalLaunch = (launchDir == Direction::LEFT || launchDir == Direction::RIGHT);
+    bool verticalLaunch = (launchDir == Direction::UP || launchDir == Direction::DOWN);
+    bool horizontalInput = (inputDir == Direction::LEFT || inputDir == Direction::RIGHT);
+    bool verticalInput = (inputDir == Direction::UP || inputDir == Direction::DOWN);
+
+    if ((horizontalLaunch && verticalInput) || (verticalLaunch && horizontalInput))
+        return directionVelocity(inputDir, 1);
+
+    return Velocity();
+}
+
+//////////////////////////////////////////        applyImpulse        //////////////////////////////////////////
+
+void Physics::applyImpulse(Momentum &body, const Velocity &impulse)
+{
+    body.setVelocity(body.getVelocity() + impulse);
+}
+
+//////////////////////////////////////////       advanceLaunch        //////////////////////////////////////////
+
+// Counts down the launch clock; a body with no frames left comes to rest
+bool Physics::advanceLaunch(Momentum &body)
+{
+    int frames = body.getLaunchFramesRemaining();
+    if (frames == 0)
+    {
+        body.resetMomentum();
+        return false;
+    }
+
+    body.setLaunchFramesRemaining(frames - 1);
+    return true;
+}
+
+//////////////////////////////////////////          transfer          //////////////////////////////////////////
+
+// Head-on hit: the struck body takes over the full launch, the striker stops after this tick
+void Physics::transfer(Momentum &from, Momentum &to)
+{
+    to = from;
+    stop(from);
+}
+
+//////////////////////////////////////////            stop            //////////////////////////////////////////
+
+void Physics::stop(Momentum &body) { body.setLaunchFramesRemaining(0); }
+
+//////////////////////////////////////////           force            //////////////////////////////////////////
+
+int Physics::force(const Velocity &velocity)
+{
+    int fx = velocity.x.abs().toInt();
+    int fy = velocity.y.abs().toInt();
+    return fx > fy ? fx : fy;
+}
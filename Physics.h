@@ -0,0 +1,95 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Constants.h"
+#include <cstdint>
+
+class Momentum;
+
+//////////////////////////////////////////           Fixed            //////////////////////////////////////////
+
+// Q24.8 fixed-point scalar. Physics never touches floating point, so every build
+// and every platform computes launches bit-for-bit the same and recordings replay identically.
+class Fixed
+{
+    int32_t raw;
+
+    constexpr explicit Fixed(int32_t rawValue, bool) : raw(rawValue) {}
+
+public:
+    static constexpr int FRACTION_BITS = 8;
+    static constexpr int32_t ONE = 1 << FRACTION_BITS;
+
+    constexpr Fixed() : raw(0) {}
+
+    static constexpr Fixed fromInt(int value) { return Fixed(value * ONE, true); }
+    static constexpr Fixed fromRaw(int32_t rawValue) { return Fixed(rawValue, true); }
+
+    constexpr int32_t getRaw() const { return raw; }
+
+    // Truncates toward zero (C++ integer division), never rounds
+    constexpr int toInt() const { return raw / ONE; }
+
+    constexpr Fixed operator+(Fixed other) const { return Fixed(raw + other.raw, true); }
+    constexpr Fixed operator-(Fixed other) const { return Fixed(raw - other.raw, true); }
+    constexpr Fixed operator-() const { return Fixed(-raw, true); }
+    constexpr Fixed operator*(int scalar) const { return Fixed(raw * scalar, true); }
+    Fixed &operator+=(Fixed other) { raw += other.raw; return *this; }
+    Fixed &operator-=(Fixed other) { raw -= other.raw; return *this; }
+
+    constexpr bool operator==(Fixed other) const { return raw == other.raw; }
+    constexpr bool operator!=(Fixed other) const { return raw != other.raw; }
+    constexpr bool operator<(Fixed other) const { return raw < other.raw; }
+    constexpr bool operator>(Fixed other) const { return raw > other.raw; }
+
+    constexpr Fixed abs() const { return Fixed(raw < 0 ? -raw : raw, true); }
+};
+
+//////////////////////////////////////////            Vec2            //////////////////////////////////////////
+
+// Per-tick displacement in cells; also used for impulses
+struct Vec2
+{
+    Fixed x;
+    Fixed y;
+
+    constexpr Vec2() : x(), y() {}
+    constexpr Vec2(Fixed _x, Fixed _y) : x(_x), y(_y) {}
+
+    static constexpr Vec2 fromInts(int dx, int dy) { return Vec2(Fixed::fromInt(dx), Fixed::fromInt(dy)); }
+
+    constexpr Vec2 operator+(const Vec2 &other) const { return Vec2(x + other.x, y + other.y); }
+    Vec2 &operator+=(const Vec2 &other) { x += other.x; y += other.y; return *this; }
+    constexpr bool operator==(const Vec2 &other) const { return x == other.x && y == other.y; }
+    constexpr bool isZero() const { return x.getRaw() == 0 && y.getRaw() == 0; }
+};
+
+using Velocity = Vec2;
+
+//////////////////////////////////////////          Physics           //////////////////////////////////////////
+
+// Launch and impulse helpers shared by springs, players and obstacles. Positions are moved
+// by their owners (Player, Obstacle); Physics only sets up, steers and times launches.
+namespace Physics
+{
+    // Launch impulse
+    Direction oppositeDirection(Direction dir);
+    Velocity directionVelocity(Direction dir, int speed);
+    int launchFrames(int compression);
+    Momentum launch(Direction compressionDir, int compression);
+
+    // Steering: impulse for an input perpendicular to the launch, zero otherwise
+    Velocity perpendicularImpulse(Direction launchDir, Direction inputDir);
+    void applyImpulse(Momentum &body, const Velocity &impulse);
+
+    // Launch clock: one tick off the remaining frames; false (and momentum reset) once spent
+    bool advanceLaunch(Momentum &body);
+
+    // Collision response
+    void transfer(Momentum &from, Momentum &to);
+    void stop(Momentum &body);
+
+    // Push force of a moving body, in whole cells per tick
+    int force(const Velocity &velocity);
+}
@@ -8,6 +8,7 @@
 #include "Obstacle.h"
 #include "Riddle.h"
 #include "Room.h"
+#include "Snapshot.h"
 #include "Spring.h"
 #include "SpringLink.h"
 #include "Switch.h"
@@ -90,10 +91,10 @@ void Player::copyInventoryFrom(const Player &other)
 
 bool Player::isStationary() const{ return (pos.getDiffX() == 0 && pos.getDiffY() == 0); }
 
-bool Player::isWithinAbsoluteBounds(int x, int y) const{ return (x >= 0 && x < MAX_X && y >= 1 && y < MAX_Y - 1); }
+bool Player::isWithinAbsoluteBounds(int x, int y, Room *room) const{ return (x >= 0 && x < room->getWidth() && y >= 1 && y < room->getHeight() - 1); }
 
 bool Player::canMoveToBoundaryPosition(int x, int y, Room *room) const{
-  bool atBoundaryColumn = (x < 1 || x >= MAX_X - 1);
+  bool atBoundaryColumn = (x < 1 || x >= room->getWidth() - 1);
 
   if (!atBoundaryColumn) return true;
 
@@ -105,7 +106,7 @@ void Player::erase(Room *room)
 {
   if (room == nullptr)
   {
-    Renderer::printAt(pos.getX(), pos.getY(), ' ');
+    Renderer::printCell(pos.getX(), pos.getY(), ' ');
     return;
   }
 
@@ -120,7 +121,7 @@ void Player::erase(Room *room)
     restoreChar = (currentChar == ' ' || currentChar == sprite) ? ' ' : currentChar;
   }
 
-  Renderer::printAt(pos.getX(), pos.getY(), restoreChar);
+  Renderer::printCell(pos.getX(), pos.getY(), restoreChar);
 }
 
 //////////////////////////////////////////  Respawn and Death Helpers       /////////////////////////////////////////////
@@ -270,13 +271,17 @@ bool Player::move(Room *room, Riddle **activeRiddle, Player **activePlayer,
 
 void Player::draw(Room *room)
 {
-  Renderer::gotoxy(pos.getX(), pos.getY());
+  if (!Renderer::shouldRender()) return;
+
+  bool onScreen = Renderer::gotoCell(pos.getX(), pos.getY());
 
   if (waitingAtDoor)
   {
     if (doorId != room->getPrevRoomId()) { erase(room); return; }
   }
 
+  if (!onScreen) return;
+
   if (isRespawning() && respawnTimer % BLINK_RATE != 0) Renderer::print(' ');
   
   else 
@@ -322,8 +327,8 @@ Point Player::dropItem(Room *room)
     int testX = pos.getX() + checkOffsets[i][0];
     int testY = pos.getY() + checkOffsets[i][1];
 
-    if (testX >= 1 && testX < MAX_X - 1 && testY >= 1 &&
-        testY < MAX_Y - 1)
+    if (testX >= 1 && testX < room->getWidth() - 1 && testY >= 1 &&
+        testY < room->getHeight() - 1)
     {
       ObjectType type = room->getObjectTypeAt(testX, testY);
       GameObject *existing = room->getObjectAt(testX, testY);
@@ -360,7 +365,7 @@ Point Player::dropItem(Room *room)
     clearInventory();
     clearInventory();
 
-    Renderer::printAt(dropX, dropY, droppedItem->getSprite());
+    Renderer::printCell(dropX, dropY, droppedItem->getSprite());
   }
 
   else delete droppedItem;
@@ -596,7 +601,7 @@ bool Player::handleSwitchInteraction(Switch *sw, Room *room)
 {
   sw->toggle();
   room->setCharAt(sw->getX(), sw->getY(), sw->getSprite());
-  Renderer::printAt(sw->getX(), sw->getY(), sw->getSprite());
+  Renderer::printCell(sw->getX(), sw->getY(), sw->getSprite());
   room->updatePuzzleState();
   return true;
 }
@@ -649,7 +654,7 @@ bool Player::isCellBlocking(int x, int y, Room *room) const
 {
   if (room == nullptr) return true;
 
-  if (x < 0 || x >= MAX_X || y < 1 || y >= MAX_Y - 1) return true;
+  if (x < 0 || x >= room->getWidth() || y < 1 || y >= room->getHeight() - 1) return true;
 
   if (room->isWallAt(x, y)) return true;
 
@@ -698,18 +703,8 @@ bool Player::canApplyInputDuringLaunch(Direction inputDir) const
 
 void Player::applyPerpendicularVelocity(Direction perpendicularDir)
 {
-  Direction launchDir = springMomentum.getLaunchDir();
-
-  if (launchDir == Direction::LEFT || launchDir == Direction::RIGHT)
-  {
-    if (perpendicularDir == Direction::UP) springMomentum.incrementDY(-1);
-    else if (perpendicularDir == Direction::DOWN) springMomentum.incrementDY(1);
-  }
-  else if (launchDir == Direction::UP || launchDir == Direction::DOWN)
-  {
-    if (perpendicularDir == Direction::LEFT) springMomentum.incrementDX(-1);
-    else if (perpendicularDir == Direction::RIGHT) springMomentum.incrementDX(1);
-  }
+  Velocity impulse = Physics::perpendicularImpulse(springMomentum.getLaunchDir(), perpendicularDir);
+  Physics::applyImpulse(springMomentum, impulse);
 }
 
 //////////////////////////////////////////   calculateNextBresenhamPoint       /////////////////////////////////////////////
@@ -773,17 +768,7 @@ bool Player::moveMultiStep(Room *room, Riddle **activeRiddle,
     currentY = nextY;
   }
 
-  if (springMomentum.getLaunchFramesRemaining() == 0)
-  {
-    springMomentum.resetMomentum();
-    pos.stopMovement();
-  }
-
-  else
-  {
-    int remaining = springMomentum.getLaunchFramesRemaining() - 1;
-    springMomentum.setLaunchFramesRemaining(remaining);
-  }
+  if (!Physics::advanceLaunch(springMomentum)) pos.stopMovement();
 
   return true;
 }
@@ -793,7 +778,7 @@ bool Player::moveMultiStep(Room *room, Riddle **activeRiddle,
 bool Player::singleStep(int nextX, int nextY, Room *room, Riddle **activeRiddle,
                         Player **activePlayer, Player *otherPlayer, Game *game)
 {
-  if (!isWithinAbsoluteBounds(nextX, nextY)) return false;
+  if (!isWithinAbsoluteBounds(nextX, nextY, room)) return false;
 
   if (!canMoveToBoundaryPosition(nextX, nextY, room)) return false;
 
@@ -825,7 +810,7 @@ void Player::stopAtPosition(int x, int y)
 
   pos.stopMovement();
 
-  springMomentum.setLaunchFramesRemaining(0);
+  Physics::stop(springMomentum);
 }
 
 //////////////////////////////////////////   transferMomentumTo       /////////////////////////////////////////////
@@ -834,28 +819,16 @@ void Player::transferMomentumTo(Player *otherPlayer)
 {
   if (otherPlayer == nullptr || !otherPlayer->isAlive()) return;
 
-  otherPlayer->springMomentum = this->springMomentum;
-
   otherPlayer->setDirection(getCurrentDirection());
-  springMomentum.setLaunchFramesRemaining(0);
+  Physics::transfer(springMomentum, otherPlayer->springMomentum);
 }
 
 ////////////////////////////////////////////   calculateForce       /////////////////////////////////////////////
 
 int Player::calculateForce() const
 {
-  int dx, dy;
-  if (springMomentum.isActive())
-  {
-    dx = abs(springMomentum.getDX());
-    dy = abs(springMomentum.getDY());
-  }
-  else
-  {
-    dx = abs(pos.getDiffX());
-    dy = abs(pos.getDiffY());
-  }
-  return dx > dy ? dx : dy;
+  if (springMomentum.isActive()) return Physics::force(springMomentum.getVelocity());
+  return Physics::force(Velocity::fromInts(pos.getDiffX(), pos.getDiffY()));
 }
 
 ////////////////////////////////////////////   handleObstacleInteraction       /////////////////////////////////////////////
@@ -872,3 +845,51 @@ bool Player::handleObstacleInteraction(class ObstacleBlock *block, Room *room)
 
   return !obstacleMoved;
 }
+
+//////////////////////////////////////////      saveState / loadState       /////////////////////////////////////////////
+
+void Player::saveState(StateWriter &out) const
+{
+  out.writePoint(pos);
+  out.writeInt(playerId);
+  out.writeChar(sprite);
+  out.writeBool(atDoor);
+  out.writeInt(doorId);
+  out.writeBool(alive);
+  out.writeInt(keyCount);
+  out.writeInt(lives);
+  out.writeInt(score);
+  out.writeBool(waitingAtDoor);
+  out.writeBool(requestPause);
+  out.writeInt(respawnTimer);
+  springMomentum.saveState(out);
+
+  out.writeBool(inventory != nullptr);
+  if (inventory != nullptr) writeObject(out, *inventory);
+}
+
+bool Player::loadState(StateReader &in)
+{
+  pos = in.readPoint();
+  playerId = static_cast<int>(in.readInt());
+  sprite = in.readChar();
+  atDoor = in.readBool();
+  doorId = static_cast<int>(in.readInt());
+  alive = in.readBool();
+  keyCount = static_cast<int>(in.readInt());
+  lives = static_cast<int>(in.readInt());
+  score = static_cast<int>(in.readInt());
+  waitingAtDoor = in.readBool();
+  requestPause = in.readBool();
+  respawnTimer = static_cast<int>(in.readInt());
+  springMomentum.loadState(in);
+
+  clearInventory();
+  if (in.readBool())
+  {
+    inventory = readObject(in);
+    if (inventory == nullptr) return false;
+  }
+
+  return in.ok();
+}
@@ -11,6 +11,8 @@
 class Room;
 class Spring;
 class Game;
+class StateWriter;
+class StateReader;
 
 //////////////////////////////////////////      PlayerKeyBinding       /////////////////////////////////////////////
 
@@ -143,6 +145,10 @@ public:
   Direction actionToDirection(Action action) const;
   int calculateForce() const;
 
+  // Keyframes
+  void saveState(StateWriter &out) const;
+  bool loadState(StateReader &in);
+
 private:
   void clearInventory();
   void copyInventoryFrom(const Player &other);
@@ -183,6 +189,6 @@ private:
 
   // Movement validation helpers
   bool isStationary() const;
-  bool isWithinAbsoluteBounds(int x, int y) const;
+  bool isWithinAbsoluteBounds(int x, int y, Room *room) const;
   bool canMoveToBoundaryPosition(int x, int y, Room *room) const;
 };
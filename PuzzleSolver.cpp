@@ -0,0 +1,621 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "PuzzleSolver.h"
+#include "HeadlessGame.h"
+#include "LevelLoader.h"
+#include "LevelPack.h"
+#include "Riddle.h"
+#include "Room.h"
+#include "Snapshot.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+//////////////////////////////////////////          helpers           //////////////////////////////////////////
+
+// A player's input for one tick: 0 stands still, the rest are CHOICES[i - 1]. A move is
+// one cell: keys are let go after every tick (SolverGame::step).
+static const Action CHOICES[] = {Action::MOVE_UP, Action::MOVE_DOWN, Action::MOVE_LEFT, Action::MOVE_RIGHT,
+                                 Action::DROP_ITEM};
+static const int CHOICE_COUNT = 6;
+
+static Direction heldDirection(Action action)
+{
+    switch (action)
+    {
+    case Action::MOVE_UP: return Direction::UP;
+    case Action::MOVE_DOWN: return Direction::DOWN;
+    case Action::MOVE_LEFT: return Direction::LEFT;
+    case Action::MOVE_RIGHT: return Direction::RIGHT;
+    default: return Direction::STAY;
+    }
+}
+
+// Dropping empty hands plays exactly like standing still, and so does nudging a launch
+// the way it already flies
+static bool changesAnything(const Player &player, int choice)
+{
+    if (choice == 0) return true;
+    Action action = CHOICES[choice - 1];
+    if (action == Action::DROP_ITEM) return player.hasItem() && !player.isLaunched();
+    return !player.isLaunched() || heldDirection(action) != player.getCurrentDirection();
+}
+
+static const char *gameOverReason(GameOverMessege messege)
+{
+    switch (messege)
+    {
+    case GameOverMessege::PLAYER1_DIED: return "PLAYER1_DIED";
+    case GameOverMessege::PLAYER2_DIED: return "PLAYER2_DIED";
+    case GameOverMessege::VALUABLE_DESTROYED: return "VALUABLE_DESTROYED";
+    default: return "GAME_OVER";
+    }
+}
+
+//////////////////////////////////////////         SolverGame         //////////////////////////////////////////
+
+enum class TickOutcome
+{
+    PLAYING,
+    EXITED,   // through the way on, or the game was won
+    WENT_BACK,
+    GAME_OVER
+};
+
+// A game the search can drop into any state of one room and advance a tick. Search copies
+// only note a room change; the follower, which plays the solution found, really changes
+// rooms and records steps and events the way NormalGame does.
+class SolverGame : public HeadlessGame
+{
+    bool following;
+    bool leftRoom;
+    bool leftForward;
+    RecordedSteps steps;
+
+protected:
+    // Riddles are answered from the database; the search does not branch on them
+    int getRiddleInput(unsigned long cycle) override
+    {
+        const RiddleData *data = aRiddle.riddle != nullptr ? context.riddles.getRiddle(aRiddle.riddle->getRiddleId()) : nullptr;
+        if (data == nullptr) return -1;
+
+        int playerId = aRiddle.player != nullptr ? aRiddle.player->getId() : 1;
+        if (following) steps.addAction(ActionRecord(cycle, playerId, data->correctAnswerIndex));
+        return data->correctAnswerIndex;
+    }
+
+public:
+    SolverGame(const std::string &dataDir, bool follow)
+        : HeadlessGame(dataDir, follow), following(follow), leftRoom(false), leftForward(false), steps()
+    {
+    }
+
+    void changeRoom(int newRoomId, bool goingForward) override
+    {
+        leftRoom = true;
+        leftForward = goingForward;
+        if (following) HeadlessGame::changeRoom(newRoomId, goingForward);
+    }
+
+    bool begin(unsigned int seed)
+    {
+        GameContext::Scope bind(context);
+
+        if (following)
+        {
+            steps.setRandomSeed(seed);
+            for (const std::string &name : LevelLoader::discoverLevelFiles(context.dataDir)) steps.addScreenName(name);
+        }
+
+        return HeadlessGame::begin(seed);
+    }
+
+    void capture(std::string &players, std::string &room) const
+    {
+        StateWriter playerState, roomState;
+        player1.saveState(playerState);
+        player2.saveState(playerState);
+        rooms[currentRoomId].saveSearchState(roomState);
+        players = playerState.data();
+        room = roomState.data();
+    }
+
+    // room == nullptr keeps the room as it is, when it already plays like the state wanted
+    bool restore(int roomId, unsigned long cycle, const std::string &players, const std::string *room)
+    {
+        GameContext::Scope bind(context);
+
+        ensureRoom(roomId);
+        currentRoomId = roomId;
+        cycleCount = cycle;
+        currentState = GameState::inGame;
+        gameOverMessege = GameOverMessege::NONE;
+        aRiddle.reset();
+        leftRoom = false;
+
+        StateReader playerState(players);
+        if (!player1.loadState(playerState) || !player2.loadState(playerState)) return false;
+        if (room == nullptr) return true;
+
+        StateReader roomState(*room);
+        return rooms[roomId].loadSearchState(roomState);
+    }
+
+    bool canPlay(int player, int choice) const { return changesAnything(player == 1 ? player1 : player2, choice); }
+
+    // One pass of the game loop: the two players' keys, then update()
+    TickOutcome step(int choice1, int choice2)
+    {
+        GameContext::Scope bind(context);
+
+        Room *room = getCurrentRoom();
+        play(player1, choice1, room);
+        play(player2, choice2, room);
+        update();
+
+        if (currentState == GameState::gameOver) return TickOutcome::GAME_OVER;
+
+        // Search copies let go of every key after the tick, so which key was held last
+        // is never part of a state; the follower gets there by pressing what play() needs
+        if (!following)
+            for (Player *player : {&player1, &player2})
+                if (!player->isLaunched()) player->performAction(Action::STAY, getCurrentRoom());
+
+        if (currentState == GameState::victory) return TickOutcome::EXITED;
+        if (leftRoom) return leftForward ? TickOutcome::EXITED : TickOutcome::WENT_BACK;
+        return TickOutcome::PLAYING;
+    }
+
+    // A choice as keys: a move is held for this tick only, anything else stands still.
+    // Mid-launch a move only nudges the flight.
+    void play(Player &player, int choice, Room *room)
+    {
+        Action action = choice != 0 ? CHOICES[choice - 1] : Action::STAY;
+        bool move = choice != 0 && action != Action::DROP_ITEM;
+
+        if (player.isLaunched())
+        {
+            if (move) press(player, action, room);
+            return;
+        }
+
+        Action hold = move ? action : Action::STAY;
+        if (heldDirection(hold) != player.getCurrentDirection()) press(player, hold, room);
+        if (action == Action::DROP_ITEM) press(player, action, room);
+    }
+
+    void press(Player &player, Action action, Room *room)
+    {
+        if (following) steps.addAction(ActionRecord(cycleCount, PlayerKeyBinding{0, player.getId(), action}));
+        player.performAction(action, room);
+    }
+
+    void stopRecording() { reportQuit(); }
+
+    GameOverMessege getGameOverMessege() const { return gameOverMessege; }
+    const RecordedSteps &getSteps() const { return steps; }
+};
+
+//////////////////////////////////////////        RoomSearcher        //////////////////////////////////////////
+
+namespace
+{
+
+struct JointMove
+{
+    unsigned char first, second;
+};
+
+// Visited states keep only how they were reached; the state itself lives in the frontier
+struct SearchNode
+{
+    std::uint32_t parent;
+    JointMove move;
+};
+
+struct FrontierEntry
+{
+    std::uint32_t node;
+    std::uint32_t roomState;
+    std::string players;
+};
+
+struct Child
+{
+    std::uint32_t parent;
+    std::uint32_t parentRoomState;
+    JointMove move;
+    TickOutcome outcome;
+    std::string players;
+    std::string room;        // empty when the tick left the room as it was
+    std::uint64_t roomHash;
+    GameOverMessege reason;
+    Point player1, player2;
+};
+
+// A visited state by its bytes: interned room states are unique, so their index stands in for the room
+struct VisitedState
+{
+    std::uint32_t roomState;
+    std::string players;
+
+    bool operator==(const VisitedState &other) const { return roomState == other.roomState && players == other.players; }
+};
+
+struct VisitedStateHash
+{
+    size_t operator()(const VisitedState &state) const
+    {
+        return std::hash<std::string>()(state.players) ^ (static_cast<size_t>(state.roomState) * 0x9E3779B97F4A7C15ull);
+    }
+};
+
+const std::uint32_t NO_NODE = 0xFFFFFFFFu;
+const size_t BATCH_SIZE = 4096; // frontier entries expanded between merges
+const size_t TASK_SIZE = 64;
+
+// BFS of one room from the state a game is in. Room states are interned (most ticks
+// leave the room untouched), so a state costs its players' bytes and an index.
+class RoomSearcher
+{
+    std::vector<std::unique_ptr<SolverGame>> &workers;
+    WorkStealingPool &pool;
+    size_t stateLimit;
+    bool allDeadEnds;
+
+    std::mutex idleMutex;
+    std::vector<SolverGame *> idle;
+
+    int roomId;
+    unsigned long firstCycle;
+    std::vector<std::string> roomStates;
+    std::vector<std::uint64_t> roomHashes;
+    std::unordered_multimap<std::uint64_t, std::uint32_t> roomIndex;
+    std::vector<SearchNode> nodes;
+    std::unordered_set<VisitedState, VisitedStateHash> visited;
+    std::unordered_set<std::uint64_t> deadEndKeys;
+
+    SolverGame *acquire()
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        SolverGame *game = idle.back();
+        idle.pop_back();
+        return game;
+    }
+
+    void release(SolverGame *game)
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        idle.push_back(game);
+    }
+
+    // The hash finds candidates; the bytes decide, so two rooms that collide stay apart
+    std::uint32_t intern(std::string &room, std::uint64_t hash)
+    {
+        auto candidates = roomIndex.equal_range(hash);
+        for (auto found = candidates.first; found != candidates.second; ++found)
+            if (roomStates[found->second] == room) return found->second;
+
+        std::uint32_t index = static_cast<std::uint32_t>(roomStates.size());
+        roomStates.push_back(std::move(room));
+        roomHashes.push_back(hash);
+        roomIndex.emplace(hash, index);
+        return index;
+    }
+
+    static std::uint64_t stateKey(const std::string &players, std::uint64_t roomHash)
+    {
+        return combineStateHashes({hashState(players), roomHash});
+    }
+
+    // loaded: the room state the game's room is in, NO_NODE when unknown
+    void expand(SolverGame &game, const FrontierEntry &entry, unsigned long cycle, std::uint32_t &loaded,
+                std::vector<Child> &children) const
+    {
+        const std::string &room = roomStates[entry.roomState];
+
+        // Most ticks leave the room alone: then only the players need restoring
+        auto restore = [&]()
+        {
+            bool restored = game.restore(roomId, cycle, entry.players, loaded == entry.roomState ? nullptr : &room);
+            loaded = restored ? entry.roomState : NO_NODE;
+            return restored;
+        };
+        if (!restore()) return;
+
+        std::vector<int> choices1, choices2;
+        for (int c = 0; c < CHOICE_COUNT; c++)
+        {
+            if (game.canPlay(1, c)) choices1.push_back(c);
+            if (game.canPlay(2, c)) choices2.push_back(c);
+        }
+
+        bool fresh = true;
+        for (int c1 : choices1)
+            for (int c2 : choices2)
+            {
+                if (!fresh && !restore()) return;
+                fresh = false;
+
+                Child child;
+                child.parent = entry.node;
+                child.parentRoomState = entry.roomState;
+                child.move = JointMove{static_cast<unsigned char>(c1), static_cast<unsigned char>(c2)};
+                child.outcome = game.step(c1, c2);
+                child.roomHash = 0;
+                child.reason = game.getGameOverMessege();
+                child.player1 = game.getPlayer1().getPosition();
+                child.player2 = game.getPlayer2().getPosition();
+                loaded = NO_NODE;
+
+                if (child.outcome == TickOutcome::PLAYING || child.outcome == TickOutcome::GAME_OVER)
+                {
+                    game.capture(child.players, child.room);
+                    child.roomHash = hashState(child.room);
+                    if (child.roomHash == roomHashes[entry.roomState] && child.room == room)
+                    {
+                        child.room.clear();
+                        loaded = entry.roomState;
+                    }
+                }
+                children.push_back(std::move(child));
+            }
+    }
+
+public:
+    std::vector<DeadEnd> deadEnds;
+    size_t deadEndCount;
+
+    RoomSearcher(std::vector<std::unique_ptr<SolverGame>> &games, WorkStealingPool &workerPool,
+                 size_t maxStates, bool listAllDeadEnds)
+        : workers(games), pool(workerPool), stateLimit(maxStates), allDeadEnds(listAllDeadEnds),
+          roomId(-1), firstCycle(0), deadEndCount(0)
+    {
+        for (std::unique_ptr<SolverGame> &game : workers) idle.push_back(game.get());
+    }
+
+    // Fills solution with the shortest input that leaves the room the way on
+    RoomSearch search(const SolverGame &start, std::vector<JointMove> &solution)
+    {
+        RoomSearch result;
+        result.roomId = roomId = start.getCurrentRoomId();
+        firstCycle = start.getCycleCount();
+
+        std::string players, room;
+        start.capture(players, room);
+        std::uint64_t roomHash = hashState(room);
+
+        std::vector<FrontierEntry> frontier, next;
+        std::uint32_t firstRoomState = intern(room, roomHash);
+        frontier.push_back(FrontierEntry{0, firstRoomState, players});
+        nodes.push_back(SearchNode{NO_NODE, JointMove{0, 0}});
+        visited.insert(VisitedState{firstRoomState, players});
+
+        std::uint32_t solvedFrom = NO_NODE;
+        JointMove lastMove{0, 0};
+        bool limitHit = false;
+
+        for (unsigned long depth = 0; !frontier.empty() && !limitHit; depth++)
+        {
+            unsigned long cycle = firstCycle + depth;
+            next.clear();
+
+            for (size_t begin = 0; begin < frontier.size() && !limitHit; begin += BATCH_SIZE)
+            {
+                size_t end = std::min(frontier.size(), begin + BATCH_SIZE);
+                size_t tasks = (end - begin + TASK_SIZE - 1) / TASK_SIZE;
+                std::vector<std::vector<Child>> results(tasks);
+
+                pool.run(tasks, [&](size_t t)
+                {
+                    SolverGame *game = acquire();
+                    std::uint32_t loaded = NO_NODE;
+                    size_t first = begin + t * TASK_SIZE;
+                    for (size_t i = first; i < std::min(end, first + TASK_SIZE); i++) expand(*game, frontier[i], cycle, loaded, results[t]);
+                    release(game);
+                });
+
+                // Merged in frontier order, so the result does not depend on the thread count
+                for (std::vector<Child> &children : results)
+                    for (Child &child : children)
+                    {
+                        if (child.outcome == TickOutcome::EXITED && solvedFrom == NO_NODE)
+                        {
+                            solvedFrom = child.parent;
+                            lastMove = child.move;
+                            result.ticks = depth + 1;
+                        }
+                        else if (child.outcome == TickOutcome::GAME_OVER)
+                        {
+                            if (!deadEndKeys.insert(stateKey(child.players, child.roomHash)).second) continue;
+                            deadEndCount++;
+                            if (deadEnds.size() < PuzzleSolver::MAX_LISTED_DEAD_ENDS)
+                                deadEnds.push_back(DeadEnd{roomId, cycle, gameOverReason(child.reason), child.player1, child.player2});
+                        }
+                        else if (child.outcome == TickOutcome::PLAYING)
+                        {
+                            std::uint32_t roomState = child.room.empty() ? child.parentRoomState : intern(child.room, child.roomHash);
+                            if (!visited.insert(VisitedState{roomState, child.players}).second) continue;
+
+                            nodes.push_back(SearchNode{child.parent, child.move});
+                            next.push_back(FrontierEntry{static_cast<std::uint32_t>(nodes.size() - 1), roomState, std::move(child.players)});
+                            if (nodes.size() >= stateLimit) limitHit = true;
+                        }
+                    }
+            }
+
+            if (solvedFrom != NO_NODE && !allDeadEnds) break;
+            frontier.swap(next);
+        }
+
+        result.states = nodes.size();
+        result.exhausted = !limitHit && frontier.empty();
+        result.solved = solvedFrom != NO_NODE;
+
+        if (result.solved)
+        {
+            solution.assign(1, lastMove);
+            for (std::uint32_t n = solvedFrom; nodes[n].parent != NO_NODE; n = nodes[n].parent) solution.push_back(nodes[n].move);
+            std::reverse(solution.begin(), solution.end());
+        }
+        return result;
+    }
+};
+
+} // namespace
+
+//////////////////////////////////////////        PuzzleSolver        //////////////////////////////////////////
+
+PuzzleSolver::PuzzleSolver(const std::string &data, const std::string &out, size_t maxStates,
+                           size_t threadCount, unsigned int randomSeed, bool listAllDeadEnds)
+    : dataDir(data), outDir(out), stateLimit(maxStates), threads(threadCount), seed(randomSeed),
+      allDeadEnds(listAllDeadEnds), searches(), deadEnds(), deadEndCount(0), won(false), savedTo()
+{
+}
+
+//////////////////////////////////////////            run             //////////////////////////////////////////
+
+bool PuzzleSolver::run()
+{
+    SolverGame follower(dataDir, true);
+    if (!follower.begin(seed)) return false;
+
+    WorkStealingPool pool(threads);
+    std::vector<std::unique_ptr<SolverGame>> workers;
+    for (size_t i = 0; i < pool.getWorkerCount(); i++)
+    {
+        workers.push_back(std::make_unique<SolverGame>(dataDir, false));
+        if (!workers.back()->begin(seed)) return false;
+    }
+
+    while (true)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        RoomSearcher searcher(workers, pool, stateLimit, allDeadEnds);
+        std::vector<JointMove> solution;
+        RoomSearch search = searcher.search(follower, solution);
+
+        search.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        searches.push_back(search);
+        deadEndCount += searcher.deadEndCount;
+        for (const DeadEnd &deadEnd : searcher.deadEnds)
+            if (deadEnds.size() < MAX_LISTED_DEAD_ENDS) deadEnds.push_back(deadEnd);
+
+        if (!search.solved) break;
+
+        // Play the solution for real; it carries the follower into the next room
+        TickOutcome outcome = TickOutcome::PLAYING;
+        for (const JointMove &move : solution) outcome = follower.step(move.first, move.second);
+
+        if (outcome != TickOutcome::EXITED)
+        {
+            searches.back().solved = false;
+            std::cerr << "room " << search.roomId << ": the solution found did not replay" << std::endl;
+            break;
+        }
+        if (follower.getCurrentState() == GameState::victory)
+        {
+            won = true;
+            break;
+        }
+    }
+
+    if (!won) follower.stopRecording();
+    savedTo = save(follower.getSteps(), follower.getEvents());
+    return won;
+}
+
+//////////////////////////////////////////            save            //////////////////////////////////////////
+
+// Like a -autoplay run: steps, results and the data files they ran against, plus the dead ends
+std::string PuzzleSolver::save(const RecordedSteps &steps, const std::vector<GameEvent> &events) const
+{
+    fs::path dir(outDir);
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec) return "";
+
+    std::vector<std::string> dataFiles = LevelLoader::discoverLevelFiles(dataDir);
+    dataFiles.push_back("riddle.txt");
+    dataFiles.push_back(LevelPack::FILE_NAME); // if there is one; copied last so it stays newer
+    for (const std::string &name : dataFiles)
+        fs::copy_file(LevelLoader::pathIn(dataDir, name), dir / name, fs::copy_options::overwrite_existing, ec);
+
+    if (steps.saveToFile((dir / "adv-world.steps.txt").string(), RecordingFormat::TEXT) != ErrorCode::NONE) return "";
+    if (saveGameEvents((dir / "adv-world.result.txt").string(), events, RecordingFormat::TEXT) != ErrorCode::NONE) return "";
+
+    std::ofstream list(dir / "adv-world.deadends.txt");
+    if (!list) return "";
+    for (const DeadEnd &deadEnd : deadEnds)
+        list << "DEAD_END CYCLE: " << deadEnd.cycle << " ROOM: " << deadEnd.roomId << " REASON: " << deadEnd.reason
+             << " P1: " << deadEnd.player1.getX() << "," << deadEnd.player1.getY()
+             << " P2: " << deadEnd.player2.getX() << "," << deadEnd.player2.getY() << "\n";
+    if (deadEndCount > deadEnds.size()) list << "... " << deadEndCount - deadEnds.size() << " more\n";
+
+    return dir.string();
+}
+
+//////////////////////////////////////////        runFromArgs         //////////////////////////////////////////
+
+int PuzzleSolver::runFromArgs(int argc, char *argv[])
+{
+    size_t maxStates = 1000000;
+    size_t threadCount = 0;
+    unsigned int seed = 1;
+    bool listAllDeadEnds = false;
+    std::string outDir = "solve-out";
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg(argv[i]);
+        if (arg == "-deadends") listAllDeadEnds = true;
+        if (i + 1 >= argc) continue;
+        if (arg == "-states") maxStates = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "-threads") threadCount = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "-seed") seed = static_cast<unsigned int>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (arg == "-out") outDir = argv[i + 1];
+    }
+
+    if (LevelLoader::discoverLevelFiles(".").empty())
+    {
+        std::cout << "No level files found in the current directory" << std::endl;
+        return 1;
+    }
+
+    PuzzleSolver solver(".", outDir, maxStates, threadCount, seed, listAllDeadEnds);
+    bool solved = false;
+    try
+    {
+        solved = solver.run();
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << "exception: " << e.what() << std::endl;
+    }
+
+    for (const RoomSearch &s : solver.getSearches())
+    {
+        std::cout << "room " << s.roomId << ": ";
+        if (s.solved) std::cout << "solved in " << s.ticks << " ticks";
+        else if (s.exhausted) std::cout << "unsolvable";
+        else std::cout << "undecided (state limit reached)";
+        std::cout << ", " << s.states << " states in " << s.wallMs / 1000.0 << " s" << std::endl;
+    }
+    std::cout << solver.getDeadEndCount() << " dead ends, game " << (solved ? "solved" : "not solved");
+    if (!solver.getSavedTo().empty()) std::cout << ", saved to " << solver.getSavedTo();
+    std::cout << std::endl;
+    return solved ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Point.h"
+#include "Recorder.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////         RoomSearch         //////////////////////////////////////////
+
+// How the search of one room went
+struct RoomSearch
+{
+    int roomId;
+    bool solved;
+    bool exhausted;      // every reachable state was visited
+    size_t states;       // distinct states visited
+    unsigned long ticks; // length of the solution
+    double wallMs;
+
+    RoomSearch() : roomId(-1), solved(false), exhausted(false), states(0), ticks(0), wallMs(0.0) {}
+};
+
+//////////////////////////////////////////          DeadEnd           //////////////////////////////////////////
+
+// A reachable state the game ends in, short of the exit
+struct DeadEnd
+{
+    int roomId;
+    unsigned long cycle;
+    std::string reason;
+    Point player1, player2;
+};
+
+//////////////////////////////////////////        PuzzleSolver        //////////////////////////////////////////
+
+// -solve [-states N] [-threads N] [-seed S] [-deadends] [-out dir]: breadth-first search over
+// both players' joint inputs, one tick at a time, through the level files in the current
+// directory. A state is the players plus the current room's search state (Room::saveSearchState);
+// states are deduplicated by hash and each layer of the frontier is expanded on all cores.
+// Rooms are solved in order, each from where the previous solution left the game, so the
+// shortest trace per room chains into one steps file that `game -load -silent` replays.
+// Game-over states met on the way are listed as dead ends; -deadends keeps searching each
+// room past its solution to list all of them (up to -states).
+class PuzzleSolver
+{
+    std::string dataDir;
+    std::string outDir;
+    size_t stateLimit;
+    size_t threads;
+    unsigned int seed;
+    bool allDeadEnds;
+
+    std::vector<RoomSearch> searches;
+    std::vector<DeadEnd> deadEnds;
+    size_t deadEndCount;
+    bool won;
+    std::string savedTo;
+
+    std::string save(const RecordedSteps &steps, const std::vector<GameEvent> &events) const;
+
+public:
+    static const size_t MAX_LISTED_DEAD_ENDS = 1000;
+
+    PuzzleSolver(const std::string &data, const std::string &out, size_t maxStates,
+                 size_t threadCount, unsigned int randomSeed, bool listAllDeadEnds);
+
+    // True when the whole game was solved
+    bool run();
+
+    const std::vector<RoomSearch> &getSearches() const { return searches; }
+    const std::vector<DeadEnd> &getDeadEnds() const { return deadEnds; }
+    size_t getDeadEndCount() const { return deadEndCount; }
+    const std::string &getSavedTo() const { return savedTo; }
+
+    // Exit status: 0 when the whole game was solved, 1 otherwise (unsolvable, undecided,
+    // or no level files)
+    static int runFromArgs(int argc, char *argv[]);
+};
@@ -1,6 +1,11 @@
 #include "Recorder.h"
+#include "Snapshot.h"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <iterator>
 #include <sstream>
+#include <unordered_map>
 
 //////////////////////////////////////////    Action Conversion    /////////////////////////////////////////////
 
@@ -30,6 +35,134 @@ inline string actionToString(Action action) {
     }
 }
 
+//////////////////////////////////////////    Binary Codec    /////////////////////////////////////////////
+
+// LEB128-style varints; signed values are zigzag-encoded so small negatives stay one byte
+static void writeVarint(ostream& out, unsigned long value)
+{
+    while (value >= 0x80) {
+        out.put(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.put(static_cast<char>(value));
+}
+
+static void writeSignedVarint(ostream& out, long value)
+{
+    writeVarint(out, (static_cast<unsigned long>(value) << 1) ^ static_cast<unsigned long>(value >> (sizeof(long) * 8 - 1)));
+}
+
+static void writeBinaryString(ostream& out, const string& str)
+{
+    writeVarint(out, str.size());
+    out.write(str.data(), static_cast<std::streamsize>(str.size()));
+}
+
+// Hashes are uniformly random, so a varint would only make them longer
+static void writeFixed64(ostream& out, std::uint64_t value)
+{
+    for (int shift = 56; shift >= 0; shift -= 8) out.put(static_cast<char>((value >> shift) & 0xFF));
+}
+
+// Bounds-checked cursor over a fully buffered binary file
+struct ByteReader
+{
+    const unsigned char* data;
+    size_t size;
+    size_t pos;
+
+    bool atEnd() const { return pos >= size; }
+
+    bool readByte(unsigned char& b)
+    {
+        if (pos >= size) return false;
+        b = data[pos++];
+        return true;
+    }
+
+    bool readVarint(unsigned long& value)
+    {
+        value = 0;
+        for (size_t shift = 0; shift < sizeof(unsigned long) * 8; shift += 7) {
+            unsigned char b;
+            if (!readByte(b)) return false;
+            value |= static_cast<unsigned long>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) return true;
+        }
+        return false;
+    }
+
+    bool readSignedVarint(long& value)
+    {
+        unsigned long raw;
+        if (!readVarint(raw)) return false;
+        value = static_cast<long>(raw >> 1) ^ -static_cast<long>(raw & 1);
+        return true;
+    }
+
+    bool readFixed64(std::uint64_t& value)
+    {
+        if (size - pos < 8) return false;
+        value = 0;
+        for (int i = 0; i < 8; i++) value = (value << 8) | data[pos++];
+        return true;
+    }
+
+    bool readString(string& str)
+    {
+        unsigned long len;
+        if (!readVarint(len) || len > size - pos) return false;
+        str.assign(reinterpret_cast<const char*>(data + pos), len);
+        pos += len;
+        return true;
+    }
+};
+
+// Actions fit in 3 bits (ESC is remapped from 27); the player id takes the high nibble
+static unsigned char packAction(int playerId, Action action)
+{
+    unsigned char code = (action == Action::ESC) ? 7 : static_cast<unsigned char>(action);
+    return static_cast<unsigned char>(((playerId & 0x0F) << 4) | code);
+}
+
+// Player 0 never acts, so this packed byte marks a keyframe record (version 2)
+static const unsigned char KEYFRAME_TAG = 0x0F;
+
+static bool unpackAction(unsigned char packed, int& playerId, Action& action)
+{
+    unsigned char code = packed & 0x0F;
+    if (code > 7) return false;
+    playerId = packed >> 4;
+    action = (code == 7) ? Action::ESC : static_cast<Action>(code);
+    return true;
+}
+
+static bool readBinaryHeader(ByteReader& reader, const char magic[4])
+{
+    if (reader.size < 5 || memcmp(reader.data, magic, 4) != 0) return false;
+    reader.pos = 5;
+    return reader.data[4] >= 1 && reader.data[4] <= RECORDING_VERSION;
+}
+
+static vector<unsigned char> readRemainingBytes(istream& in)
+{
+    return vector<unsigned char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+//////////////////////////////////////////    detectRecordingFormat    /////////////////////////////////////////////
+
+RecordingFormat detectRecordingFormat(std::istream& in)
+{
+    char magic[4] = {0, 0, 0, 0};
+    std::streampos start = in.tellg();
+    in.read(magic, 4);
+    bool binary = in.gcount() == 4 &&
+                  (memcmp(magic, STEPS_MAGIC, 4) == 0 || memcmp(magic, RESULT_MAGIC, 4) == 0);
+    in.clear();
+    in.seekg(start);
+    return binary ? RecordingFormat::BINARY : RecordingFormat::TEXT;
+}
+
 //////////////////////////////////////////    GameEvent::write    /////////////////////////////////////////////
 
 void GameEvent::write(std::ostream& out) const
@@ -51,6 +184,13 @@ void GameEvent::write(std::ostream& out) const
         case GameEventType::QUIT:
             out << "QUIT CYCLE: " << cycle << " ROOM: " << roomId << "\n";
             break;
+        case GameEventType::STATE_HASH:
+            out << "HASH CYCLE: " << cycle << " ROOM: " << roomId
+                << " STATE: " << toHex64(combineStateHashes(stateHashes))
+                << " PARTS: " << stateHashes.size();
+            for (std::uint64_t hash : stateHashes) out << " " << toHex64(hash);
+            out << "\n";
+            break;
     }
 }
 
@@ -93,6 +233,25 @@ bool GameEvent::read(std::istream& in)
         wasCorrect = (correctStr == "YES");
     }
     else if (eventType == "QUIT") type = GameEventType::QUIT;
+
+    // The combined STATE value is redundant; it only guards against edited parts
+    else if (eventType == "HASH")
+    {
+        type = GameEventType::STATE_HASH;
+        std::string combined;
+        size_t count;
+        if (!(in >> dummy >> combined >> dummy >> count)) return false;
+
+        stateHashes.clear();
+        for (size_t i = 0; i < count; i++)
+        {
+            std::string hex;
+            std::uint64_t hash;
+            if (!(in >> hex) || !fromHex64(hex, hash)) return false;
+            stateHashes.push_back(hash);
+        }
+        if (combined != toHex64(combineStateHashes(stateHashes))) return false;
+    }
     
     else return false;  // Unknown event type
 
@@ -135,25 +294,59 @@ bool ActionRecord::read(istream &input)
     return true; 
 }
 
+//////////////////////////////////////////    Keyframe::write / read    /////////////////////////////////////////////
+
+void Keyframe::write(ostream &output) const
+{
+    output << "KEYFRAME CYCLE: " << cycle << " STATE: " << toHex(state) << "\n";
+}
+
+// The leading KEYFRAME tag has already been consumed by the caller. The state is the rest
+// of the line, which is empty for an empty state.
+bool Keyframe::read(istream &input)
+{
+    string dummy;
+    string hex;
+
+    if (!(input >> dummy >> cycle >> dummy)) return false;
+    getline(input, hex);
+
+    size_t first = hex.find_first_not_of(" \t\r");
+    size_t last = hex.find_last_not_of(" \t\r");
+    hex = first == string::npos ? string() : hex.substr(first, last - first + 1);
+    return fromHex(hex, state);
+}
+
 //////////////////////////////////////////    RecordedSteps::loadFromFile    /////////////////////////////////////////////
 
-// Made with AI
 ErrorCode RecordedSteps::loadFromFile(const string& filename)
 {
-    ifstream file(filename);
+    ifstream file(filename, ios::binary);
     if (!file.is_open()) return ErrorCode::FILE_NOT_FOUND;
 
     actions.clear();
+    cycleIndex.clear();
+    keyframes.clear();
     screenNames.clear();
     currActionIndex = 0;
     randomSeed = 0; // Default
     colorMode = false; // Default per user request (legacy compatible)
 
+    ErrorCode err = detectRecordingFormat(file) == RecordingFormat::BINARY ? readBinary(file) : readText(file);
+    indexActions();
+    return err;
+}
+
+//////////////////////////////////////////    RecordedSteps::readText    /////////////////////////////////////////////
+
+// Made with AI
+ErrorCode RecordedSteps::readText(istream& in)
+{
     // Check for header line
-    if (file.peek() != EOF) {
+    if (in.peek() != EOF) {
         string line;
-        streampos oldPos = file.tellg();
-        getline(file, line);
+        streampos oldPos = in.tellg();
+        getline(in, line);
         
         stringstream ss(line);
         string key;
@@ -184,27 +377,160 @@ ErrorCode RecordedSteps::loadFromFile(const string& filename)
              }
         } else {
              // Not a seed line, rewind
-             file.seekg(oldPos);
+             in.seekg(oldPos);
         }
     }
 
-    while (file >> ws && file.peek() != EOF) {
+    while (in >> ws && in.peek() != EOF) {
+        if (in.peek() == 'K') {
+            string tag;
+            Keyframe keyframe;
+            if (!(in >> tag) || tag != "KEYFRAME" || !keyframe.read(in)) return ErrorCode::READ_ERROR;
+            addKeyframe(keyframe);
+            continue;
+        }
+
         ActionRecord record;
-        if (!record.read(file)) {
+        if (!record.read(in)) {
             // Check if it's just garbage or end
              // Actually, read handles structure.
              // If read fails mid-stream, it's an error.
-            file.close();
             return ErrorCode::READ_ERROR;
         }
         actions.push_back(record);
     }
 
 
-    file.close();
     return ErrorCode::NONE;
 }
 
+//////////////////////////////////////////    RecordedSteps::readBinary    /////////////////////////////////////////////
+
+// Layout: magic, version, flags, varint seed, screen list, then one record per action
+// until EOF: zigzag cycle delta, packed player/action byte, zigzag answer for riddles.
+// A KEYFRAME_TAG byte instead of the packed action is followed by the length-prefixed state.
+ErrorCode RecordedSteps::readBinary(istream& in)
+{
+    vector<unsigned char> bytes = readRemainingBytes(in);
+    ByteReader reader{bytes.data(), bytes.size(), 0};
+
+    if (!readBinaryHeader(reader, STEPS_MAGIC)) return ErrorCode::INVALID_FORMAT;
+
+    unsigned char flags;
+    unsigned long seed, screenCount;
+    if (!reader.readByte(flags) || !reader.readVarint(seed) || !reader.readVarint(screenCount))
+        return ErrorCode::READ_ERROR;
+
+    colorMode = (flags & 0x01) != 0;
+    randomSeed = static_cast<unsigned int>(seed);
+
+    for (unsigned long i = 0; i < screenCount; i++) {
+        string name;
+        if (!reader.readString(name)) return ErrorCode::READ_ERROR;
+        screenNames.push_back(name);
+    }
+
+    unsigned long cycle = 0;
+    while (!reader.atEnd()) {
+        ActionRecord record;
+        long delta;
+        unsigned char packed;
+        if (!reader.readSignedVarint(delta) || !reader.readByte(packed)) return ErrorCode::READ_ERROR;
+        cycle += static_cast<unsigned long>(delta);
+
+        if (packed == KEYFRAME_TAG) {
+            Keyframe keyframe;
+            keyframe.cycle = cycle;
+            if (!reader.readString(keyframe.state)) return ErrorCode::READ_ERROR;
+            addKeyframe(keyframe);
+            continue;
+        }
+
+        if (!unpackAction(packed, record.playerId, record.action)) return ErrorCode::INVALID_FORMAT;
+        record.cycle = cycle;
+
+        if (record.action == Action::ANSWER_RIDDLE) {
+            long answer;
+            if (!reader.readSignedVarint(answer)) return ErrorCode::READ_ERROR;
+            record.answer = static_cast<int>(answer);
+        }
+        actions.push_back(record);
+    }
+
+    return ErrorCode::NONE;
+}
+
+//////////////////////////////////////////    RecordedSteps::saveToFile    /////////////////////////////////////////////
+
+ErrorCode RecordedSteps::saveToFile(const string& filename, RecordingFormat format) const
+{
+    ofstream file(filename, ios::binary | ios::trunc);
+    if (!file.is_open()) return ErrorCode::WRITE_ERROR;
+
+    if (format == RecordingFormat::BINARY) writeBinary(file);
+    else writeText(file);
+
+    return file.good() ? ErrorCode::NONE : ErrorCode::WRITE_ERROR;
+}
+
+//////////////////////////////////////////    RecordedSteps::writeText    /////////////////////////////////////////////
+
+void RecordedSteps::writeText(ostream& out) const
+{
+    out << "RANDOM_SEED: " << randomSeed;
+    if (!screenNames.empty()) {
+        out << " SCREENS: ";
+        for (size_t i = 0; i < screenNames.size(); i++) {
+            out << screenNames[i];
+            if (i < screenNames.size() - 1) out << ",";
+        }
+    }
+    out << " COLOR_MODE: " << (colorMode ? "ON" : "OFF") << "\n";
+
+    // Keyframes go before the actions of their cycle, as NormalGame records them
+    size_t nextKeyframe = 0;
+    for (const ActionRecord& record : actions) {
+        while (nextKeyframe < keyframes.size() && keyframes[nextKeyframe].cycle <= record.cycle)
+            keyframes[nextKeyframe++].write(out);
+        record.write(out);
+    }
+    while (nextKeyframe < keyframes.size()) keyframes[nextKeyframe++].write(out);
+}
+
+//////////////////////////////////////////    RecordedSteps::writeBinary    /////////////////////////////////////////////
+
+void RecordedSteps::writeBinary(ostream& out) const
+{
+    out.write(STEPS_MAGIC, 4);
+    out.put(static_cast<char>(RECORDING_VERSION));
+    out.put(static_cast<char>(colorMode ? 0x01 : 0x00));
+    writeVarint(out, randomSeed);
+
+    writeVarint(out, screenNames.size());
+    for (const string& name : screenNames) writeBinaryString(out, name);
+
+    unsigned long prevCycle = 0;
+    size_t nextKeyframe = 0;
+
+    auto writeKeyframe = [&](const Keyframe& keyframe) {
+        writeSignedVarint(out, static_cast<long>(keyframe.cycle - prevCycle));
+        out.put(static_cast<char>(KEYFRAME_TAG));
+        writeBinaryString(out, keyframe.state);
+        prevCycle = keyframe.cycle;
+    };
+
+    for (const ActionRecord& record : actions) {
+        while (nextKeyframe < keyframes.size() && keyframes[nextKeyframe].cycle <= record.cycle)
+            writeKeyframe(keyframes[nextKeyframe++]);
+
+        writeSignedVarint(out, static_cast<long>(record.cycle - prevCycle));
+        out.put(static_cast<char>(packAction(record.playerId, record.action)));
+        if (record.action == Action::ANSWER_RIDDLE) writeSignedVarint(out, record.answer);
+        prevCycle = record.cycle;
+    }
+    while (nextKeyframe < keyframes.size()) writeKeyframe(keyframes[nextKeyframe++]);
+}
+
 //////////////////////////////////////////    RecordedSteps::getCurrentAction    /////////////////////////////////////////////
 
 const ActionRecord* RecordedSteps::getCurrentAction() const
@@ -213,16 +539,260 @@ const ActionRecord* RecordedSteps::getCurrentAction() const
     return &actions[currActionIndex];
 }
 
+//////////////////////////////////////////    RecordedSteps::addAction    /////////////////////////////////////////////
+
+// Recording appends in cycle order, so the index usually just extends or appends its last
+// range; an earlier cycle goes after the actions already at that cycle and the index is rebuilt
+void RecordedSteps::addAction(const ActionRecord& record)
+{
+    if (!actions.empty() && record.cycle < actions.back().cycle)
+    {
+        auto at = std::upper_bound(actions.begin(), actions.end(), record.cycle,
+                                   [](unsigned long cycle, const ActionRecord& r) { return cycle < r.cycle; });
+        actions.insert(at, record);
+        indexActions();
+        return;
+    }
+
+    actions.push_back(record);
+
+    if (!cycleIndex.empty() && cycleIndex.back().cycle == record.cycle)
+        cycleIndex.back().end = actions.size();
+    else
+        cycleIndex.push_back({record.cycle, actions.size() - 1, actions.size()});
+}
+
+//////////////////////////////////////////    RecordedSteps::indexActions    /////////////////////////////////////////////
+
+// Steps files may be hand-edited or merged out of cycle order: actions are sorted by cycle,
+// keeping file order within a cycle, before the per-cycle index is built
+void RecordedSteps::indexActions()
+{
+    auto byCycle = [](const ActionRecord& a, const ActionRecord& b) { return a.cycle < b.cycle; };
+    if (!std::is_sorted(actions.begin(), actions.end(), byCycle))
+        std::stable_sort(actions.begin(), actions.end(), byCycle);
+
+    cycleIndex.clear();
+    for (size_t i = 0; i < actions.size(); i++)
+    {
+        if (!cycleIndex.empty() && cycleIndex.back().cycle == actions[i].cycle)
+            cycleIndex.back().end = i + 1;
+        else
+            cycleIndex.push_back({actions[i].cycle, i, i + 1});
+    }
+}
+
 //////////////////////////////////////////    RecordedSteps::getActionsForCycle    /////////////////////////////////////////////
 
-vector<ActionRecord> RecordedSteps::getActionsForCycle(unsigned long curr) const
+ActionRange RecordedSteps::getActionsForCycle(unsigned long curr) const
 {
-    vector<ActionRecord> result;
-    for (const ActionRecord& record : actions) {
-        if (record.cycle == curr) result.push_back(record);
+    auto it = std::lower_bound(cycleIndex.begin(), cycleIndex.end(), curr,
+                               [](const CycleRange& range, unsigned long cycle) { return range.cycle < cycle; });
+
+    if (it == cycleIndex.end() || it->cycle != curr) return ActionRange();
+
+    const ActionRecord* base = actions.data();
+    return ActionRange(base + it->begin, base + it->end);
+}
+
+//////////////////////////////////////////    RecordedSteps::seekToCycle    /////////////////////////////////////////////
+
+void RecordedSteps::seekToCycle(unsigned long cycle)
+{
+    auto it = std::lower_bound(cycleIndex.begin(), cycleIndex.end(), cycle,
+                               [](const CycleRange& range, unsigned long c) { return range.cycle < c; });
+
+    currActionIndex = (it == cycleIndex.end()) ? actions.size() : it->begin;
+}
+
+//////////////////////////////////////////    RecordedSteps::addKeyframe    /////////////////////////////////////////////
+
+// Recordings are written in cycle order; an out-of-order keyframe is dropped rather than unsorting the list
+void RecordedSteps::addKeyframe(const Keyframe& keyframe)
+{
+    if (!keyframes.empty() && keyframes.back().cycle >= keyframe.cycle) return;
+    keyframes.push_back(keyframe);
+}
+
+//////////////////////////////////////////    RecordedSteps::findKeyframe    /////////////////////////////////////////////
+
+const Keyframe* RecordedSteps::findKeyframe(unsigned long cycle) const
+{
+    auto it = std::upper_bound(keyframes.begin(), keyframes.end(), cycle,
+                               [](unsigned long c, const Keyframe& keyframe) { return c < keyframe.cycle; });
+
+    if (it == keyframes.begin()) return nullptr;
+    return &*(it - 1);
+}
+
+//////////////////////////////////////////    loadGameEvents    /////////////////////////////////////////////
+
+// Binary layout: magic, version, then one record per event until EOF: zigzag cycle
+// delta, type byte, zigzag room, then per-type fields. Riddle questions are interned:
+// an id equal to the current table size introduces a new string inline.
+static ErrorCode readBinaryEvents(istream& in, vector<GameEvent>& events)
+{
+    vector<unsigned char> bytes = readRemainingBytes(in);
+    ByteReader reader{bytes.data(), bytes.size(), 0};
+
+    if (!readBinaryHeader(reader, RESULT_MAGIC)) return ErrorCode::INVALID_FORMAT;
+
+    vector<string> questions;
+    unsigned long cycle = 0;
+    while (!reader.atEnd()) {
+        GameEvent event;
+        long delta, room;
+        unsigned char type;
+        if (!reader.readSignedVarint(delta) || !reader.readByte(type) || !reader.readSignedVarint(room))
+            return ErrorCode::READ_ERROR;
+        if (type > static_cast<unsigned char>(GameEventType::STATE_HASH)) return ErrorCode::INVALID_FORMAT;
+
+        cycle += static_cast<unsigned long>(delta);
+        event.cycle = cycle;
+        event.type = static_cast<GameEventType>(type);
+        event.roomId = static_cast<int>(room);
+
+        if (event.type == GameEventType::LIFE_LOST) {
+            long player;
+            if (!reader.readSignedVarint(player)) return ErrorCode::READ_ERROR;
+            event.playerId = static_cast<int>(player);
+        }
+        else if (event.type == GameEventType::RIDDLE_ANSWERED) {
+            unsigned long id;
+            long answer;
+            unsigned char correct;
+            if (!reader.readVarint(id) || id > questions.size()) return ErrorCode::READ_ERROR;
+            if (id == questions.size()) {
+                string question;
+                if (!reader.readString(question)) return ErrorCode::READ_ERROR;
+                questions.push_back(question);
+            }
+            if (!reader.readSignedVarint(answer) || !reader.readByte(correct)) return ErrorCode::READ_ERROR;
+
+            event.question = questions[id];
+            event.answerGiven = static_cast<int>(answer);
+            event.wasCorrect = correct != 0;
+        }
+        else if (event.type == GameEventType::STATE_HASH) {
+            unsigned long count;
+            if (!reader.readVarint(count) || count > (reader.size - reader.pos) / 8) return ErrorCode::READ_ERROR;
+            event.stateHashes.resize(count);
+            for (std::uint64_t& hash : event.stateHashes)
+                if (!reader.readFixed64(hash)) return ErrorCode::READ_ERROR;
+        }
+        events.push_back(event);
+    }
+
+    return ErrorCode::NONE;
+}
+
+static void writeBinaryEvents(ostream& out, const vector<GameEvent>& events)
+{
+    out.write(RESULT_MAGIC, 4);
+    out.put(static_cast<char>(RECORDING_VERSION));
+
+    std::unordered_map<string, unsigned long> questionIds;
+    unsigned long prevCycle = 0;
+    for (const GameEvent& event : events) {
+        writeSignedVarint(out, static_cast<long>(event.cycle - prevCycle));
+        out.put(static_cast<char>(event.type));
+        writeSignedVarint(out, event.roomId);
+
+        if (event.type == GameEventType::LIFE_LOST) writeSignedVarint(out, event.playerId);
+        else if (event.type == GameEventType::RIDDLE_ANSWERED) {
+            auto it = questionIds.find(event.question);
+            if (it != questionIds.end()) writeVarint(out, it->second);
+            else {
+                unsigned long id = questionIds.size();
+                questionIds.emplace(event.question, id);
+                writeVarint(out, id);
+                writeBinaryString(out, event.question);
+            }
+            writeSignedVarint(out, event.answerGiven);
+            out.put(static_cast<char>(event.wasCorrect ? 1 : 0));
+        }
+        else if (event.type == GameEventType::STATE_HASH) {
+            writeVarint(out, event.stateHashes.size());
+            for (std::uint64_t hash : event.stateHashes) writeFixed64(out, hash);
+        }
+        prevCycle = event.cycle;
+    }
+}
+
+ErrorCode loadGameEvents(const string& filename, vector<GameEvent>& events)
+{
+    ifstream file(filename, ios::binary);
+    if (!file.is_open()) return ErrorCode::FILE_NOT_FOUND;
+
+    events.clear();
+    if (detectRecordingFormat(file) == RecordingFormat::BINARY) return readBinaryEvents(file, events);
+
+    while (file >> ws && file.peek() != EOF) {
+        GameEvent event;
+        if (!event.read(file)) return ErrorCode::READ_ERROR;
+        events.push_back(event);
     }
-    return result;
+    return ErrorCode::NONE;
 }
 
+//////////////////////////////////////////    saveGameEvents    /////////////////////////////////////////////
+
+ErrorCode saveGameEvents(const string& filename, const vector<GameEvent>& events, RecordingFormat format)
+{
+    ofstream file(filename, ios::binary | ios::trunc);
+    if (!file.is_open()) return ErrorCode::WRITE_ERROR;
 
+    if (format == RecordingFormat::BINARY) writeBinaryEvents(file, events);
+    else for (const GameEvent& event : events) event.write(file);
 
+    return file.good() ? ErrorCode::NONE : ErrorCode::WRITE_ERROR;
+}
+
+//////////////////////////////////////////    resultFileFor    /////////////////////////////////////////////
+
+string resultFileFor(const string& stepsFile)
+{
+    size_t pos = stepsFile.rfind(".steps");
+    if (pos == string::npos) return "";
+
+    return stepsFile.substr(0, pos) + ".result" + stepsFile.substr(pos + 6);
+}
+
+//////////////////////////////////////////    convertRecording    /////////////////////////////////////////////
+
+// Steps and result files are told apart by magic (binary) or first keyword (text)
+ErrorCode convertRecording(const string& inFile, const string& outFile, size_t* recordCount)
+{
+    ifstream file(inFile, ios::binary);
+    if (!file.is_open()) return ErrorCode::FILE_NOT_FOUND;
+
+    RecordingFormat inFormat = detectRecordingFormat(file);
+    RecordingFormat outFormat = (inFormat == RecordingFormat::BINARY) ? RecordingFormat::TEXT
+                                                                      : RecordingFormat::BINARY;
+    bool isSteps;
+    if (inFormat == RecordingFormat::BINARY) {
+        char magic[4];
+        file.read(magic, 4);
+        isSteps = memcmp(magic, STEPS_MAGIC, 4) == 0;
+    }
+    else {
+        string firstWord;
+        file >> firstWord;
+        isSteps = (firstWord == "RANDOM_SEED:" || firstWord == "CYCLE:");
+    }
+    file.close();
+
+    if (isSteps) {
+        RecordedSteps steps;
+        ErrorCode err = steps.loadFromFile(inFile);
+        if (err != ErrorCode::NONE) return err;
+        if (recordCount) *recordCount = steps.getActionCount();
+        return steps.saveToFile(outFile, outFormat);
+    }
+
+    vector<GameEvent> events;
+    ErrorCode err = loadGameEvents(inFile, events);
+    if (err != ErrorCode::NONE) return err;
+    if (recordCount) *recordCount = events.size();
+    return saveGameEvents(outFile, events, outFormat);
+}
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <iostream>
 #include <vector>
 #include "Constants.h"
@@ -8,13 +10,30 @@
 
 using namespace std;
 
+//////////////////////////////////////////     Recording Format     /////////////////////////////////////////////
+
+// Steps/result files are either the readable text format or the compact binary one.
+// Binary files start with a 4-byte magic and a version byte; loaders auto-detect.
+enum class RecordingFormat {
+    TEXT,
+    BINARY
+};
+
+static const char STEPS_MAGIC[4] = {'A', 'D', 'V', 'S'};
+static const char RESULT_MAGIC[4] = {'A', 'D', 'V', 'R'};
+// 2: steps files may carry keyframes, 3: result files may carry state hashes
+static const unsigned char RECORDING_VERSION = 3;
+
+RecordingFormat detectRecordingFormat(std::istream& in);
+
 //////////////////////////////////////////     GameEventType & GameEvent     /////////////////////////////////////////////
 
 enum class GameEventType {
     SCREEN_CHANGE,
     LIFE_LOST,
     RIDDLE_ANSWERED,
-    QUIT
+    QUIT,
+    STATE_HASH
 };
 
 struct GameEvent {
@@ -25,6 +44,7 @@ struct GameEvent {
     std::string question;
     int answerGiven;
     bool wasCorrect;
+    std::vector<std::uint64_t> stateHashes; // STATE_HASH only: one hash per StateDigest part
     GameEvent() : cycle(0), type(GameEventType::SCREEN_CHANGE), roomId(0),
                   playerId(0), answerGiven(0), wasCorrect(false) {}
 
@@ -39,7 +59,7 @@ struct GameEvent {
           playerId(player), answerGiven(0), wasCorrect(false) {}
 
     // Constructor for RIDDLE_ANSWERED
-    GameEvent(unsigned long c, int room, const std::string& q, int answer, bool correct)
+    GameEvent(unsigned long c, int room, std::string_view q, int answer, bool correct)
         : cycle(c), type(GameEventType::RIDDLE_ANSWERED), roomId(room),
           playerId(0), question(q), answerGiven(answer), wasCorrect(correct) {}
 
@@ -48,6 +68,11 @@ struct GameEvent {
         : cycle(c), type(quitType), roomId(room),
           playerId(0), answerGiven(0), wasCorrect(false) {}
 
+    // Constructor for STATE_HASH
+    GameEvent(unsigned long c, int room, const std::vector<std::uint64_t>& hashes)
+        : cycle(c), type(GameEventType::STATE_HASH), roomId(room),
+          playerId(0), answerGiven(0), wasCorrect(false), stateHashes(hashes) {}
+
     void write(std::ostream& out) const;
     bool read(std::istream& in);
 };
@@ -75,6 +100,42 @@ struct ActionRecord
     bool read(istream &input);
 };
 
+//////////////////////////////////////////     Keyframe     /////////////////////////////////////////////
+
+// Serialized game state (Game::captureKeyframe) taken at the top of a cycle,
+// before that cycle's actions. Lets a replay start anywhere near a given cycle.
+struct Keyframe
+{
+    unsigned long cycle;
+    std::string state;
+
+    Keyframe() : cycle(0) {}
+    Keyframe(unsigned long c, const std::string& s) : cycle(c), state(s) {}
+
+    void write(ostream &output) const;
+    bool read(istream &input);
+};
+
+//////////////////////////////////////////     ActionRange     /////////////////////////////////////////////
+
+// Non-owning view over the contiguous actions recorded for one cycle
+class ActionRange
+{
+    const ActionRecord* first;
+    const ActionRecord* last;
+
+public:
+    ActionRange() : first(nullptr), last(nullptr) {}
+    ActionRange(const ActionRecord* b, const ActionRecord* e) : first(b), last(e) {}
+
+    const ActionRecord* begin() const { return first; }
+    const ActionRecord* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+};
+
+//////////////////////////////////////////     RecordedSteps     /////////////////////////////////////////////
+
 class RecordedSteps
 {
     unsigned int randomSeed = 0;
@@ -83,21 +144,61 @@ class RecordedSteps
     std::vector<std::string> screenNames;
     bool colorMode = false;
 
+    // One [begin, end) entry per distinct cycle, in recording (= cycle) order
+    struct CycleRange
+    {
+        unsigned long cycle;
+        size_t begin;
+        size_t end;
+    };
+    vector<CycleRange> cycleIndex;
+
+    vector<Keyframe> keyframes; // ascending cycle
+
 public:
     RecordedSteps() : currActionIndex(0) {}
-    void addAction(const ActionRecord& record) { actions.push_back(record); }
+    void addAction(const ActionRecord& record);
     ErrorCode loadFromFile(const string& filename);
+    ErrorCode saveToFile(const string& filename, RecordingFormat format) const;
     const ActionRecord* getCurrentAction() const;
     void advanceToNextAction() { if (currActionIndex < actions.size()) currActionIndex++; }
     bool hasMoreActions() const { return currActionIndex < actions.size(); }
-    vector<ActionRecord> getActionsForCycle(unsigned long cycle) const;
+    ActionRange getActionsForCycle(unsigned long cycle) const;
+
+    // Moves the replay cursor to the first action recorded at or after cycle
+    void seekToCycle(unsigned long cycle);
+
+    void addKeyframe(const Keyframe& keyframe);
+    // Latest keyframe at or before cycle, nullptr if there is none
+    const Keyframe* findKeyframe(unsigned long cycle) const;
+    size_t getKeyframeCount() const { return keyframes.size(); }
     ActionRecord getActionAt(size_t index) const { return actions[index]; }
     size_t getCurrIndex() const { return currActionIndex; }
     void setRandomSeed(unsigned int seed) { randomSeed = seed; }
     unsigned int getRandomSeed() const { return randomSeed; }
     
     const std::vector<std::string>& getScreenNames() const { return screenNames; }
+    void addScreenName(const std::string& name) { screenNames.push_back(name); }
+    size_t getActionCount() const { return actions.size(); }
     
     void setColorMode(bool enabled) { colorMode = enabled; }
     bool getColorMode() const { return colorMode; }
-};
\ No newline at end of file
+
+private:
+    ErrorCode readText(istream& in);
+    ErrorCode readBinary(istream& in);
+    void indexActions();
+    void writeText(ostream& out) const;
+    void writeBinary(ostream& out) const;
+};
+
+//////////////////////////////////////////     Result Files     /////////////////////////////////////////////
+
+ErrorCode loadGameEvents(const string& filename, vector<GameEvent>& events);
+ErrorCode saveGameEvents(const string& filename, const vector<GameEvent>& events, RecordingFormat format);
+
+// "adv-world.steps.txt" -> "adv-world.result.txt"; empty when the name is not a steps file
+string resultFileFor(const string& stepsFile);
+
+// Rewrites a steps or result file in the other format (text <-> binary).
+ErrorCode convertRecording(const string& inFile, const string& outFile, size_t* recordCount = nullptr);
\ No newline at end of file
@@ -0,0 +1,142 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       /////////////////////////////////////////////
+
+#include "RecordingWriter.h"
+#include <chrono>
+
+//////////////////////////////////////////      ByteRing::push        //////////////////////////////////////////
+
+size_t ByteRing::push(const char *data, size_t len)
+{
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t t = tail.load(std::memory_order_acquire);
+    size_t space = CAPACITY - (h - t);
+    if (len > space) len = space;
+
+    for (size_t i = 0; i < len; i++) buffer[(h + i) & (CAPACITY - 1)] = data[i];
+
+    head.store(h + len, std::memory_order_release);
+    return len;
+}
+
+//////////////////////////////////////////      ByteRing::pop         //////////////////////////////////////////
+
+size_t ByteRing::pop(char *out, size_t maxLen)
+{
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t h = head.load(std::memory_order_acquire);
+    size_t len = h - t;
+    if (len > maxLen) len = maxLen;
+
+    for (size_t i = 0; i < len; i++) out[i] = buffer[(t + i) & (CAPACITY - 1)];
+
+    tail.store(t + len, std::memory_order_release);
+    return len;
+}
+
+//////////////////////////////////////////     Constructor / Dtor     //////////////////////////////////////////
+
+RecordingWriter::RecordingWriter()
+    : flushIntervalMs(DEFAULT_FLUSH_INTERVAL_MS), stopRequested(false), headerDirty(false) {}
+
+RecordingWriter::~RecordingWriter() { close(); }
+
+//////////////////////////////////////////          open              //////////////////////////////////////////
+
+bool RecordingWriter::open(const std::string &filename, int intervalMs)
+{
+    close();
+
+    file.open(filename, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) return false;
+
+    flushIntervalMs = intervalMs;
+    stopRequested = false;
+    overflow.clear();
+    worker = std::thread(&RecordingWriter::run, this);
+    return true;
+}
+
+//////////////////////////////////////////          close             //////////////////////////////////////////
+
+// Stops the writer, then writes whatever is still queued from this (producer) thread
+void RecordingWriter::close()
+{
+    if (!worker.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopRequested = true;
+    }
+    wake.notify_one();
+    worker.join();
+
+    drain();
+    if (!overflow.empty()) file.write(overflow.data(), static_cast<std::streamsize>(overflow.size()));
+    overflow.clear();
+
+    file.close();
+}
+
+//////////////////////////////////////////          write             //////////////////////////////////////////
+
+void RecordingWriter::write(const std::string &data)
+{
+    if (!worker.joinable()) return;
+
+    if (!overflow.empty())
+    {
+        size_t pushed = ring.push(overflow.data(), overflow.size());
+        overflow.erase(0, pushed);
+        if (!overflow.empty())
+        {
+            overflow += data;
+            return;
+        }
+    }
+
+    size_t pushed = ring.push(data.data(), data.size());
+    if (pushed < data.size()) overflow.append(data, pushed, std::string::npos);
+}
+
+//////////////////////////////////////////        setHeader           //////////////////////////////////////////
+
+void RecordingWriter::setHeader(const std::string &text)
+{
+    if (!worker.joinable()) return;
+
+    std::lock_guard<std::mutex> lock(headerMutex);
+    header = text;
+    headerDirty.store(true, std::memory_order_release);
+}
+
+//////////////////////////////////////////           run              //////////////////////////////////////////
+
+void RecordingWriter::run()
+{
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    while (!stopRequested)
+    {
+        wake.wait_for(lock, std::chrono::milliseconds(flushIntervalMs));
+        drain();
+    }
+}
+
+//////////////////////////////////////////          drain             //////////////////////////////////////////
+
+void RecordingWriter::drain()
+{
+    if (headerDirty.exchange(false, std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(headerMutex);
+        file.seekp(0);
+        file << header;
+        file.seekp(0, std::ios::end);
+    }
+
+    char chunk[4096];
+    size_t len;
+    while ((len = ring.pop(chunk, sizeof(chunk))) > 0)
+        file.write(chunk, static_cast<std::streamsize>(len));
+
+    file.flush();
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+//////////////////////////////////////////        ByteRing            //////////////////////////////////////////
+
+// Single-producer / single-consumer lock-free byte queue.
+// The game thread only advances head, the writer thread only advances tail.
+class ByteRing
+{
+    static const size_t CAPACITY = 1 << 16; // power of two, indices wrap with a mask
+
+    char buffer[CAPACITY];
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+
+public:
+    ByteRing() : head(0), tail(0) {}
+
+    size_t push(const char *data, size_t len);
+    size_t pop(char *out, size_t maxLen);
+};
+
+//////////////////////////////////////////     RecordingWriter        //////////////////////////////////////////
+
+// Append-only recording file drained by a background thread.
+// write() copies into the ring and returns, the writer thread flushes every
+// flushIntervalMs and on close(), so a crash loses at most one interval.
+class RecordingWriter
+{
+public:
+    static const int DEFAULT_FLUSH_INTERVAL_MS = 100;
+
+private:
+    std::ofstream file;
+    std::thread worker;
+    ByteRing ring;
+    int flushIntervalMs;
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopRequested;
+
+    // Header rewritten in place at offset 0 (rare, menu-time only)
+    std::mutex headerMutex;
+    std::string header;
+    std::atomic<bool> headerDirty;
+
+    // Producer-side spill for bytes that did not fit in a full ring
+    std::string overflow;
+    std::ostringstream scratch;
+
+    void run();
+    void drain();
+
+public:
+    RecordingWriter();
+    ~RecordingWriter();
+    RecordingWriter(const RecordingWriter &) = delete;
+    RecordingWriter &operator=(const RecordingWriter &) = delete;
+
+    bool open(const std::string &filename, int intervalMs = DEFAULT_FLUSH_INTERVAL_MS);
+    void close();
+    bool is_open() const { return worker.joinable(); }
+
+    void write(const std::string &data);
+    void setHeader(const std::string &text);
+
+    // Formats any record with a write(std::ostream&) member on the calling thread
+    template <typename Record>
+    void writeRecord(const Record &record)
+    {
+        scratch.str("");
+        record.write(scratch);
+        write(scratch.str());
+    }
+};
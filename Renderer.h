@@ -1,24 +1,63 @@
 #pragma once
 
 #include "Console.h"
+#include "Constants.h"
+#include "GameContext.h"
 #include <iostream>
 #include <string>
+#include <string_view>
 
+// Output proxy for the game bound to the calling thread (see GameContext):
+// writes to its sink, and not at all when that game is silent.
+// Building with -DHEADLESS_BUILD (make headless) turns shouldRender() into a
+// compile-time false: every Renderer call and every draw path guarded by it
+// is compiled out, leaving only the simulation.
 class Renderer {
-    inline static bool silentMode = false;
+    static std::ostream& out() { return *GameContext::current().out; }
 
 public:
-    static void setSilentMode(bool silent) { silentMode = silent; }
-    static inline bool shouldRender() { return !silentMode; }
-    static inline void gotoxy(int x, int y) { if (shouldRender()) ::gotoxy(x, y); }
-    static inline void clrscr() { if (shouldRender()) ::clrscr(); }
+#ifdef HEADLESS_BUILD
+    static constexpr bool isHeadless() { return true; }
+    static void setSilentMode(bool silent) { (void)silent; }
+    static constexpr bool shouldRender() { return false; }
+#else
+    static constexpr bool isHeadless() { return false; }
+    static void setSilentMode(bool silent) { GameContext::current().silent = silent; }
+    static inline bool shouldRender() { return !GameContext::current().silent; }
+#endif
+    static inline void gotoxy(int x, int y) { if (shouldRender()) ::gotoxy(x, y, out()); }
+    static inline void clrscr() { if (shouldRender()) ::clrscr(out()); }
     static inline void hideCursor() { if (shouldRender()) ::hideCursor(); }
     static inline void showCursor() { if (shouldRender()) ::showCursor(); }
     static inline void sleep_ms(int milliseconds) { if (shouldRender()) ::sleep_ms(milliseconds); }
-    static inline void print(char c) { if (shouldRender()) std::cout << c; }
-    static inline void print(const std::string& str) { if (shouldRender()) std::cout << str; }
-    static inline void print(int value) { if (shouldRender()) std::cout << value; }
-    static inline void flush() { if (shouldRender()) std::cout << std::flush; }
-    static inline void printAt(int x, int y, char c) { if (shouldRender()) { ::gotoxy(x, y); std::cout << c; } }
-    static inline void printAt(int x, int y, const std::string& str) { if (shouldRender()) { ::gotoxy(x, y); std::cout << str; } }
+    static inline void print(char c) { if (shouldRender()) out() << c; }
+    static inline void print(std::string_view str) { if (shouldRender()) out() << str; }
+    static inline void print(int value) { if (shouldRender()) out() << value; }
+    static inline void flush() { if (shouldRender()) out() << std::flush; }
+    static inline void printAt(int x, int y, char c) { if (shouldRender()) { ::gotoxy(x, y, out()); out() << c; } }
+    static inline void printAt(int x, int y, std::string_view str) { if (shouldRender()) { ::gotoxy(x, y, out()); out() << str; } }
+
+    // Room cells: shifted by the game's camera, and skipped outside the console
+    static inline bool gotoCell(int x, int y)
+    {
+        if (!shouldRender()) return false;
+        x -= GameContext::current().cameraX;
+        y -= GameContext::current().cameraY;
+        if (x < 0 || x >= MAX_X || y < 0 || y >= MAX_Y) return false;
+        ::gotoxy(x, y, out());
+        return true;
+    }
+    static inline void printCell(int x, int y, char c) { if (gotoCell(x, y)) out() << c; }
+    static inline void printCell(int x, int y, std::string_view str)
+    {
+        int skip = GameContext::current().cameraX - x;
+        if (skip > 0)
+        {
+            if (static_cast<size_t>(skip) >= str.size()) return;
+            str.remove_prefix(skip);
+            x += skip;
+        }
+        if (!gotoCell(x, y)) return;
+        out() << str.substr(0, static_cast<size_t>(MAX_X - (x - GameContext::current().cameraX)));
+    }
 };
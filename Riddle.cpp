@@ -3,9 +3,10 @@
 #include "Riddle.h"
 #include "Game.h"
 #include "Layouts.h"
-#include "RiddleDatabase.h"
+#include "GameContext.h"
 #include "Player.h"
 #include "Room.h"
+#include "Snapshot.h"
 #include "Console.h"
 #include "Renderer.h"
 #include <iostream>
@@ -28,9 +29,8 @@ RiddleResult Riddle::enterRiddle(Room *room, Player *triggeringPlayer, Game *gam
 
     if (game != nullptr)
     {
-        const RiddleData *data = RiddleDatabase::getRiddle(riddleId);
-        std::string questionText = data ? data->question : "";
-        game->onRiddleAttempt(questionText, playerAnswer + 1, correct);
+        const RiddleData *data = GameContext::current().riddles.getRiddle(riddleId);
+        game->onRiddleAttempt(data ? data->question : std::string_view(), playerAnswer + 1, correct);
     }
 
     if (correct && firstAttempt && triggeringPlayer != nullptr) triggeringPlayer->incrementScore(100);
@@ -59,7 +59,7 @@ RiddleResult Riddle::enterRiddle(Room *room, Player *triggeringPlayer, Game *gam
 
 bool Riddle::displayRiddleQuestion()
 {
-    const RiddleData *data = RiddleDatabase::getRiddle(riddleId);
+    const RiddleData *data = GameContext::current().riddles.getRiddle(riddleId);
     if (data == nullptr) return false;
 
     int startX = 11;
@@ -94,6 +94,9 @@ int Riddle::getPlayerAnswer(const Game* gameContext) const
         if (recordedAnswer != -1) return recordedAnswer;
     }
 
+    // Silent replays have nobody at the keyboard: a riddle the recording never answered is escaped
+    if (!Renderer::shouldRender()) return -1;
+
     Renderer::showCursor();
 
     while (check_kbhit()) get_char_nonblocking();
@@ -156,9 +159,9 @@ void Riddle::displayFeedback(bool correct) const
 
 void Riddle::playRiddleAnimation(DelayRate delayRate) const 
 { 
-    while (check_kbhit()) get_char_nonblocking();
-    
     if (!Renderer::shouldRender()) return;
+
+    while (check_kbhit()) get_char_nonblocking();
     
     const int startX = 11;
     const int startY = 4;
@@ -195,7 +198,29 @@ void Riddle::playRiddleAnimation(DelayRate delayRate) const
 
 bool Riddle::checkAnswer(int playerAnswer) const
 {
-    const RiddleData *data = RiddleDatabase::getRiddle(riddleId);
+    const RiddleData *data = GameContext::current().riddles.getRiddle(riddleId);
     if (data == nullptr) return false;
     return playerAnswer == data->correctAnswerIndex;
 }
+
+//////////////////////////////////////////    saveState / loadState    //////////////////////////////////////////
+
+void Riddle::saveState(StateWriter &out) const
+{
+    InteractableObject::saveState(out);
+    out.writeBool(firstAttempt);
+    out.writeChar(solvingPlayerSprite);
+    out.writeInt(solvingPlayerId);
+    out.writeInt(riddleId);
+    out.writeInt(correctAnswer);
+}
+
+void Riddle::loadState(StateReader &in)
+{
+    InteractableObject::loadState(in);
+    firstAttempt = in.readBool();
+    solvingPlayerSprite = in.readChar();
+    solvingPlayerId = static_cast<int>(in.readInt());
+    riddleId = static_cast<int>(in.readInt());
+    correctAnswer = static_cast<int>(in.readInt());
+}
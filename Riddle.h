@@ -67,4 +67,7 @@ public:
         sprite = ' ';
         type = ObjectType::AIR;
     }
+
+    void saveState(StateWriter &out) const override;
+    void loadState(StateReader &in) override;
 };
\ No newline at end of file
@@ -1,51 +1,85 @@
 //////////////////////////////////////       INCLUDES & FORWARDS       /////////////////////////////////////////////
 
 #include "RiddleDatabase.h"
+#include <cctype>
 #include <fstream>
+#include <iterator>
 
-//////////////////////////////////////////    Static Initialization       /////////////////////////////////////////////
+//////////////////////////////////////////          helpers          /////////////////////////////////////////////
 
-std::vector<RiddleData> RiddleDatabase::riddles;
-bool RiddleDatabase::isActive = false;
+// std::getline over the arena: the line without its '\n'; false at the end
+static bool nextLine(std::string_view text, size_t &pos, std::string_view &line)
+{
+  if (pos >= text.size()) return false;
 
-//////////////////////////////////////////          initialize       /////////////////////////////////////////////
+  size_t end = text.find('\n', pos);
+  if (end == std::string_view::npos) end = text.size();
 
-void RiddleDatabase::initialize()
+  line = text.substr(pos, end - pos);
+  pos = (end < text.size()) ? end + 1 : end;
+  return true;
+}
+
+// `file >> answer; file.ignore();`: skips whitespace, reads an integer, drops one char
+static bool readAnswer(std::string_view text, size_t &pos, int &answer)
 {
-  if (isActive) return;
+  while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) pos++;
 
-  std::ifstream file("riddle.txt");
-  if (!file.is_open())
-  {
-    isActive = true;
-    return;
-  }
+  size_t start = pos;
+  if (pos < text.size() && (text[pos] == '-' || text[pos] == '+')) pos++;
+  if (pos >= text.size() || !std::isdigit(static_cast<unsigned char>(text[pos]))) return false;
+
+  answer = 0;
+  while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos])))
+    answer = answer * 10 + (text[pos++] - '0');
+  if (text[start] == '-') answer = -answer;
+
+  if (pos < text.size()) pos++;
+  return true;
+}
+
+//////////////////////////////////////////            load           /////////////////////////////////////////////
+
+int RiddleDatabase::load(const std::string &path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) return -1;
+
+  clearRiddles();
+  arena.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  isActive = true;
 
-  std::string line;
-  int riddleId = 0;
+  std::string_view text(arena);
+  size_t pos = 0;
+  std::string_view line;
 
-  while (std::getline(file, line))
+  while (nextLine(text, pos, line))
   {
-    if (line.find("---RIDDLE---") != std::string::npos)
-    {
-      std::string question;
-      if (!std::getline(file, question)) break;
+    if (line.find("---RIDDLE---") == std::string_view::npos) continue;
 
-      std::string opts[4];
-      for (int i = 0; i < 4; i++) if (!std::getline(file, opts[i])) break;
+    RiddleData riddle;
+    riddle.riddleId = static_cast<int>(riddles.size());
 
-      std::string answerLine;
-      if (!std::getline(file, answerLine)) break;
+    nextLine(text, pos, riddle.question);
+    for (int i = 0; i < 4; i++) nextLine(text, pos, riddle.options[i]);
 
-      int correctAnswer = std::stoi(answerLine) - 1;
+    int answer;
+    if (!readAnswer(text, pos, answer)) break;
+    riddle.correctAnswerIndex = answer - 1;
 
-      riddles.push_back(RiddleData(riddleId, question, opts, correctAnswer));
-      riddleId++;
-    }
+    riddles.push_back(riddle);
   }
 
-  file.close();
-  isActive = true;
+  return static_cast<int>(riddles.size());
+}
+
+//////////////////////////////////////////          initialize       /////////////////////////////////////////////
+
+void RiddleDatabase::initialize()
+{
+  if (isActive) return;
+
+  if (load(sourceFile) < 0) isActive = true;
 }
 
 //////////////////////////////////////////          getRiddle       /////////////////////////////////////////////
@@ -54,9 +88,8 @@ const RiddleData *RiddleDatabase::getRiddle(int riddleId)
 {
   initialize();
 
-  for (const RiddleData &r : riddles) if (r.riddleId == riddleId) return &r;
-
-  return nullptr;
+  if (riddleId < 0 || riddleId >= static_cast<int>(riddles.size())) return nullptr;
+  return &riddles[riddleId];
 }
 
 //////////////////////////////////////////       getTotalRiddles       /////////////////////////////////////////////
@@ -67,18 +100,11 @@ int RiddleDatabase::getTotalRiddles()
   return riddles.size();
 }
 
-//////////////////////////////////////////          addRiddle       /////////////////////////////////////////////
-
-void RiddleDatabase::addRiddle(const RiddleData &riddle)
-{
-  riddles.push_back(riddle);
-  isActive = true;
-}
-
 //////////////////////////////////////////        clearRiddles       /////////////////////////////////////////////
 
 void RiddleDatabase::clearRiddles()
 {
   riddles.clear();
+  arena.clear();
   isActive = false;
 }
@@ -3,41 +3,49 @@
 //////////////////////////////////////       INCLUDES & FORWARDS       /////////////////////////////////////////////
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 //////////////////////////////////////////          RiddleData       /////////////////////////////////////////////
 
+// Views into the database's copy of riddle.txt; valid until the database reloads
 struct RiddleData
 {
   int riddleId;
-  std::string question;
-  std::string options[4];
+  std::string_view question;
+  std::string_view options[4];
   int correctAnswerIndex;
 
   RiddleData() : riddleId(-1), correctAnswerIndex(-1) {}
-
-  RiddleData(int id, const std::string &q, const std::string opt[4],
-             int correct)
-      : riddleId(id), correctAnswerIndex(correct)
-  {
-    question = q;
-    for (int i = 0; i < 4; i++) options[i] = opt[i];
-  }
 };
 
 //////////////////////////////////////////       RiddleDatabase       /////////////////////////////////////////////
 
+// Riddle set of one game (owned by its GameContext). riddle.txt is read once into a
+// single buffer and parsed in place; riddles[id] holds the views, so lookups are O(1).
 class RiddleDatabase
 {
-  static std::vector<RiddleData> riddles;
-  static bool isActive;
+  std::string arena;
+  std::vector<RiddleData> riddles;
+  bool isActive;
+  std::string sourceFile;
 
-  static void initialize();
+  void initialize();
 
 public:
-  static const RiddleData *getRiddle(int riddleId);
-  static int getTotalRiddles();
+  RiddleDatabase() : isActive(false), sourceFile("riddle.txt") {}
+
+  // The views point into arena, so the database stays where it was built
+  RiddleDatabase(const RiddleDatabase &) = delete;
+  RiddleDatabase &operator=(const RiddleDatabase &) = delete;
+
+  void setSourceFile(const std::string &path) { sourceFile = path; }
+
+  // Replaces the riddles with those of path; -1 (riddles kept) when it cannot be read
+  int load(const std::string &path);
+
+  const RiddleData *getRiddle(int riddleId);
+  int getTotalRiddles();
 
-  static void addRiddle(const RiddleData &riddle);
-  static void clearRiddles();
+  void clearRiddles();
 };
@@ -7,12 +7,14 @@
 #include "Renderer.h"
 
 #include "Door.h"
+#include "GameContext.h"
 #include "GameObject.h"
 #include "Layouts.h"
 
 #include "Items.h"
 #include "Obstacle.h"
 #include "Player.h"
+#include "Snapshot.h"
 #include "Spring.h"
 #include "SpringLink.h"
 #include "StaticObjects.h"
@@ -30,6 +32,7 @@ Room::Room()
       activeSwitches(0), totalSwitches(0), nextRoomId(-1), prevRoomId(-1)
 {
   initVisibility();
+  activeAreas[0] = CellRect(0, 0, MAX_ROOM_SIZE, MAX_ROOM_SIZE);
 }
 
 Room::Room(int id)
@@ -38,6 +41,7 @@ Room::Room(int id)
       activeSwitches(0), totalSwitches(0), nextRoomId(-1), prevRoomId(-1)
 {
   initVisibility();
+  activeAreas[0] = CellRect(0, 0, MAX_ROOM_SIZE, MAX_ROOM_SIZE);
 }
 
 //////////////////////////////////////////       Room Destructor       /////////////////////////////////////////////
@@ -66,10 +70,8 @@ Room::Room(const Room &other)
       spawnPoint(other.spawnPoint),
       spawnPointFromNext(other.spawnPointFromNext), darkZones(other.darkZones)
 {
-  for (int y = 0; y < MAX_Y; y++)
-    for (int x = 0; x < MAX_X; x++)
-      visibilityMap[y][x] = other.visibilityMap[y][x];
-
+  for (int i = 0; i < 3; i++) activeAreas[i] = other.activeAreas[i];
+  copyVisibilityFrom(other);
   copyObjectsFrom(other);
 }
 
@@ -90,6 +92,7 @@ Room &Room::operator=(const Room &other)
     completed = other.completed;
     baseLayout = other.baseLayout;
     mods = other.mods;
+    invalidateNavigation();
     totalKeysInRoom = other.totalKeysInRoom;
     keysCollected = other.keysCollected;
     activeSwitches = other.activeSwitches;
@@ -100,11 +103,9 @@ Room &Room::operator=(const Room &other)
     spawnPointFromNext = other.spawnPointFromNext;
     darkZones = other.darkZones;
     doorReqs = other.doorReqs;
+    for (int i = 0; i < 3; i++) activeAreas[i] = other.activeAreas[i];
 
-    for (int y = 0; y < MAX_Y; y++)
-      for (int x = 0; x < MAX_X; x++)
-        visibilityMap[y][x] = other.visibilityMap[y][x];
-
+    copyVisibilityFrom(other);
     copyObjectsFrom(other);
   }
   return *this;
@@ -150,11 +151,64 @@ void Room::deleteAllObjects()
   objects.clear();
 }
 
+// Objects plus the springs and obstacles that group them, so a room can be rebuilt
+void Room::deleteLevelObjects()
+{
+  deleteAllObjects();
+
+  for (Spring *spring : springs) delete spring;
+  springs.clear();
+
+  for (Obstacle *obstacle : obstacles) delete obstacle;
+  obstacles.clear();
+}
+
+// Everything INNER: no tiles at all
 void Room::initVisibility()
 {
-  for (int y = 0; y < MAX_Y; y++)
-    for (int x = 0; x < MAX_X; x++)
-      visibilityMap[y][x] = VisibilityState::INNER;
+  visibility.clear();
+  visibility.shrink_to_fit();
+}
+
+void Room::copyVisibilityFrom(const Room &other)
+{
+  visibility.clear();
+  for (const std::unique_ptr<VisibilityChunk> &chunk : other.visibility)
+    visibility.emplace_back(chunk ? new VisibilityChunk(*chunk) : nullptr);
+}
+
+static int chunksAcross(int cells) { return (cells + CHUNK_SIZE - 1) / CHUNK_SIZE; }
+
+VisibilityState Room::getVisibility(int x, int y) const
+{
+  int across = chunksAcross(getWidth());
+  if (visibility.size() != static_cast<size_t>(across * chunksAcross(getHeight()))) return VisibilityState::INNER;
+
+  const std::unique_ptr<VisibilityChunk> &chunk = visibility[(y / CHUNK_SIZE) * across + x / CHUNK_SIZE];
+  if (!chunk) return VisibilityState::INNER;
+  return chunk->cells[y % CHUNK_SIZE][x % CHUNK_SIZE];
+}
+
+// The tile list is sized to the layout the first time a cell leaves INNER
+void Room::setVisibility(int x, int y, VisibilityState state)
+{
+  size_t chunkCount = static_cast<size_t>(chunksAcross(getWidth()) * chunksAcross(getHeight()));
+  if (visibility.size() != chunkCount)
+  {
+    if (state == VisibilityState::INNER) return;
+    visibility.clear();
+    visibility.resize(chunkCount);
+  }
+
+  std::unique_ptr<VisibilityChunk> &chunk = visibility[(y / CHUNK_SIZE) * chunksAcross(getWidth()) + x / CHUNK_SIZE];
+  if (!chunk)
+  {
+    if (state == VisibilityState::INNER) return;
+    chunk.reset(new VisibilityChunk);
+    for (auto &row : chunk->cells)
+      for (VisibilityState &cell : row) cell = VisibilityState::INNER;
+  }
+  chunk->cells[y % CHUNK_SIZE][x % CHUNK_SIZE] = state;
 }
 
 void Room::setColorForChar(char c)
@@ -192,7 +246,8 @@ void Room::initFromLayout(const Screen *layout, const std::vector<int> *riddleId
 {
   baseLayout = layout;
   mods.clear();
-  deleteAllObjects();
+  invalidateNavigation();
+  deleteLevelObjects();
   loadObjects(riddleIds, riddleIndex);
 }
 
@@ -209,9 +264,9 @@ void Room::loadObjects(const std::vector<int> *riddleIds, int *riddleIndex)
 
   if (baseLayout == nullptr) return;
 
-  for (int y = 0; y < MAX_Y; y++)
+  for (int y = 0; y < baseLayout->getHeight(); y++)
   {
-    for (int x = 0; x < MAX_X; x++)
+    for (int x = 0; x < baseLayout->getWidth(); x++)
     {
       char ch = baseLayout->getCharAt(x, y);
 
@@ -226,29 +281,7 @@ void Room::loadObjects(const std::vector<int> *riddleIds, int *riddleIndex)
         continue;
       }
 
-      int riddleId = -1;
-      if (ch == '?')
-      {
-        if (riddleIds != nullptr && riddleIndex != nullptr &&
-             *riddleIndex < static_cast<int>(riddleIds->size()))
-          riddleId = (*riddleIds)[(*riddleIndex)++];
-        else continue;
-      }
-
-      GameObject *obj = createObjectFromChar(ch, x, y, riddleId);
-
-      if (obj != nullptr)
-      {
-        if (obj->getType() == ObjectType::KEY) totalKeysInRoom++;
-        else if (obj->getType() == ObjectType::SWITCH_OFF) totalSwitches++;
-        else if (obj->getType() == ObjectType::SWITCH_ON)
-        {
-          totalSwitches++;
-          activeSwitches++;
-        }
-
-        if (!addObject(obj)) delete obj;
-      }
+      addObjectFromCell(x, y, ch, riddleIds, riddleIndex);
     }
   }
 
@@ -256,6 +289,67 @@ void Room::loadObjects(const std::vector<int> *riddleIds, int *riddleIndex)
   createMultiCellObject(obstaclePositions);
 }
 
+//////////////////////////////////////////       initFromCells        /////////////////////////////////////////////
+
+// Same objects as initFromLayout, from cell lists a level pack grouped ahead of time
+void Room::initFromCells(const Screen *layout, const std::vector<Point> &objectCells,
+                         const std::vector<std::vector<Point>> &springGroups,
+                         const std::vector<std::vector<Point>> &obstacleGroups,
+                         const std::vector<int> *riddleIds, int *riddleIndex)
+{
+  baseLayout = layout;
+  mods.clear();
+  invalidateNavigation();
+  deleteLevelObjects();
+
+  totalKeysInRoom = 0;
+  keysCollected = 0;
+  activeSwitches = 0;
+  totalSwitches = 0;
+
+  if (baseLayout == nullptr) return;
+
+  for (const Point &p : objectCells)
+    addObjectFromCell(p.getX(), p.getY(), baseLayout->getCharAt(p.getX(), p.getY()), riddleIds, riddleIndex);
+
+  for (const std::vector<Point> &group : springGroups) createSpringFromGroup(group);
+
+  for (const std::vector<Point> &group : obstacleGroups)
+  {
+    std::unordered_map<Point, std::vector<Point>> edges = obstacleEdges(baseLayout, group);
+    createObstacleFromGroup(group, edges);
+  }
+}
+
+//////////////////////////////////////////     addObjectFromCell      /////////////////////////////////////////////
+
+void Room::addObjectFromCell(int x, int y, char ch, const std::vector<int> *riddleIds, int *riddleIndex)
+{
+  int riddleId = -1;
+  if (ch == '?')
+  {
+    if (riddleIds != nullptr && riddleIndex != nullptr &&
+         *riddleIndex < static_cast<int>(riddleIds->size()))
+      riddleId = (*riddleIds)[(*riddleIndex)++];
+    else return;
+  }
+
+  GameObject *obj = createObjectFromChar(ch, x, y, riddleId);
+
+  if (obj != nullptr)
+  {
+    if (obj->getType() == ObjectType::KEY) totalKeysInRoom++;
+    else if (obj->getType() == ObjectType::SWITCH_OFF) totalSwitches++;
+    else if (obj->getType() == ObjectType::SWITCH_ON)
+    {
+      totalSwitches++;
+      activeSwitches++;
+    }
+
+    if (!addObject(obj)) delete obj;
+  }
+}
+
 //////////////////////////////////////////    setDoorRequirements       /////////////////////////////////////////////
 
 void Room::setDoorRequirements(int doorId, int keys, int switches, int targetRoomId)
@@ -275,48 +369,114 @@ void Room::setDoorRequirements(int doorId, int keys, int switches, int targetRoo
 
 void Room::draw()
 {
-  if (baseLayout != nullptr) baseLayout->draw();
+  if (!Renderer::shouldRender()) return;
+
+  if (baseLayout != nullptr) baseLayout->drawView(GameContext::current().cameraX, GameContext::current().cameraY);
 
+  CellRect view = viewArea();
   for (const Modification &mod : mods) 
   {
+      if (!view.contains(mod.x, mod.y)) continue;
+
       if (mod.newChar == ' ') {
-          Renderer::printAt(mod.x, mod.y, mod.newChar);
+          Renderer::printCell(mod.x, mod.y, mod.newChar);
           continue;
       }
       
       setColorForChar(mod.newChar);
-      Renderer::printAt(mod.x, mod.y, mod.newChar);
+      Renderer::printCell(mod.x, mod.y, mod.newChar);
       reset_color();
   }
 
   drawDarkness();
 }
 
+//////////////////////////////////////////          viewArea         /////////////////////////////////////////////
+
+// The cells the console shows from the game's camera
+CellRect Room::viewArea() const
+{
+  int x1 = std::max(0, GameContext::current().cameraX);
+  int y1 = std::max(0, GameContext::current().cameraY);
+  int x2 = std::min(getWidth(), GameContext::current().cameraX + MAX_X) - 1;
+  int y2 = std::min(getHeight(), GameContext::current().cameraY + MAX_Y) - 1;
+  return CellRect(x1, y1, x2, y2);
+}
+
+//////////////////////////////////////////         viewOrigin        /////////////////////////////////////////////
+
+// Top-left cell of a view centered on (focusX, focusY), kept inside the room
+Point Room::viewOrigin(int focusX, int focusY) const
+{
+  int x = std::max(0, std::min(focusX - MAX_X / 2, getWidth() - MAX_X));
+  int y = std::max(0, std::min(focusY - MAX_Y / 2, getHeight() - MAX_Y));
+  return Point(x, y);
+}
+
+//////////////////////////////////////////      updateActiveArea     /////////////////////////////////////////////
+
+CellRect Room::activeAreaAround(Point origin) const
+{
+  // Out to the margin, then out to whole chunks
+  int x1 = std::max(0, origin.getX() - ACTIVE_MARGIN) / CHUNK_SIZE * CHUNK_SIZE;
+  int y1 = std::max(0, origin.getY() - ACTIVE_MARGIN) / CHUNK_SIZE * CHUNK_SIZE;
+  int x2 = (origin.getX() + MAX_X + ACTIVE_MARGIN) / CHUNK_SIZE * CHUNK_SIZE + CHUNK_SIZE - 1;
+  int y2 = (origin.getY() + MAX_Y + ACTIVE_MARGIN) / CHUNK_SIZE * CHUNK_SIZE + CHUNK_SIZE - 1;
+  return CellRect(x1, y1, std::min(x2, getWidth() - 1), std::min(y2, getHeight() - 1));
+}
+
+// Depends only on where the players stand, so replays simulate the same cells
+void Room::updateActiveArea(const Player *p1, const Player *p2)
+{
+  activeAreas[0] = p1 != nullptr ? activeAreaAround(viewOrigin(p1->getX(), p1->getY())) : CellRect();
+  activeAreas[1] = p2 != nullptr ? activeAreaAround(viewOrigin(p2->getX(), p2->getY())) : CellRect();
+  activeAreas[2] = activeAreaAround(cameraFor(p1, p2));
+}
+
+//////////////////////////////////////////         cameraFor         /////////////////////////////////////////////
+
+// The view around the players' midpoint, moved in half-chunk steps so walking does not
+// repaint the console every tick
+Point Room::cameraFor(const Player *p1, const Player *p2) const
+{
+  if (p1 == nullptr && p2 == nullptr) return Point(0, 0);
+  const Player *a = p1 != nullptr ? p1 : p2;
+  const Player *b = p2 != nullptr ? p2 : p1;
+
+  Point origin = viewOrigin((a->getX() + b->getX()) / 2, (a->getY() + b->getY()) / 2);
+  const int step = CHUNK_SIZE / 2;
+  int x = std::min(origin.getX() / step * step, std::max(0, getWidth() - MAX_X));
+  int y = std::min(origin.getY() / step * step, std::max(0, getHeight() - MAX_Y));
+  return Point(x, y);
+}
+
 //////////////////////////////////////////        drawDarkness       /////////////////////////////////////////////
 
 void Room::drawDarkness(Player *p1, Player *p2)
 {
-  if (darkZones.empty()) return;
+  if (!Renderer::shouldRender() || darkZones.empty()) return;
 
-  for (int y = 0; y < MAX_Y; y++)
+  CellRect view = viewArea();
+  for (int y = view.y1; y <= view.y2; y++)
   {
-    for (int x = 0; x < MAX_X; x++)
+    for (int x = view.x1; x <= view.x2; x++)
     {
       if (!isInDarkZone(x, y)) continue;
 
       if (p1 != nullptr && p1->getX() == x && p1->getY() == y) continue;
       if (p2 != nullptr && p2->getX() == x && p2->getY() == y) continue;
 
-      Renderer::gotoxy(x, y);
+      if (!Renderer::gotoCell(x, y)) continue;
 
-      if (visibilityMap[y][x] != VisibilityState::DARK) 
+      VisibilityState state = getVisibility(x, y);
+      if (state != VisibilityState::DARK) 
       {
           char c = getCharAt(x, y);
           
           if (c != ' ') {
-              if (visibilityMap[y][x] == VisibilityState::CLOSE) setColorForChar(c);
-              else if (visibilityMap[y][x] == VisibilityState::EDGE) set_color(Color::LightYellow);
-              else if (visibilityMap[y][x] == VisibilityState::INNER) set_color(Color::Yellow);
+              if (state == VisibilityState::CLOSE) setColorForChar(c);
+              else if (state == VisibilityState::EDGE) set_color(Color::LightYellow);
+              else if (state == VisibilityState::INNER) set_color(Color::Yellow);
           }
           
           Renderer::print(c);
@@ -332,6 +492,8 @@ void Room::drawDarkness(Player *p1, Player *p2)
 
 void Room::drawVisibleObjects()
 {
+  if (!Renderer::shouldRender()) return;
+
   for (GameObject *obj : objects)
   {
     if (!obj || !obj->isActive()) continue;
@@ -345,23 +507,24 @@ void Room::drawVisibleObjects()
       continue;
     }
 
-    if (isInDarkZone(x, y) && visibilityMap[y][x] == VisibilityState::DARK && !obj->isAlwaysVisible())
+    VisibilityState state = getVisibility(x, y);
+    if (isInDarkZone(x, y) && state == VisibilityState::DARK && !obj->isAlwaysVisible())
     {
-      Renderer::printAt(x, y, ' ');
+      Renderer::printCell(x, y, ' ');
       continue;
     }
 
-    if (isInDarkZone(x, y) && visibilityMap[y][x] != VisibilityState::DARK)
+    if (isInDarkZone(x, y) && state != VisibilityState::DARK)
     {
-      if (visibilityMap[y][x] == VisibilityState::CLOSE)
+      if (state == VisibilityState::CLOSE)
       {
         obj->draw();
       }
       else
       {
-        if (visibilityMap[y][x] == VisibilityState::EDGE) set_color(Color::LightYellow);
+        if (state == VisibilityState::EDGE) set_color(Color::LightYellow);
         else set_color(Color::Yellow);
-        Renderer::printAt(x, y, obj->getSprite());
+        Renderer::printCell(x, y, obj->getSprite());
         reset_color();
       }
     }
@@ -391,22 +554,45 @@ void Room::setCharAt(int x, int y, char c)
   {
     if (mod.x == x && mod.y == y)
     {
+      char before = mod.newChar;
       mod.newChar = c;
+      if (before != c) updateNavigation(x, y, before, c);
       return;
     }
   }
 
+  char before = baseLayout != nullptr ? baseLayout->getCharAt(x, y) : 'W';
   mods.push_back(Modification(x, y, c));
+  if (before != c) updateNavigation(x, y, before, c);
 }
 
 //////////////////////////////////////////         resetMods       /////////////////////////////////////////////
 
-void Room::resetMods() { mods.clear(); }
+void Room::resetMods()
+{
+  mods.clear();
+  invalidateNavigation();
+}
 
 //////////////////////////////////////////     getObjectTypeAt       /////////////////////////////////////////////
 
 ObjectType Room::getObjectTypeAt(int x, int y) const { return static_cast<ObjectType>(getCharAt(x, y)); }
 
+//////////////////////////////////////////         copyGrid          /////////////////////////////////////////////
+
+void Room::copyGrid(std::string &cells) const
+{
+  const int width = getWidth(), height = getHeight();
+  cells.resize(static_cast<size_t>(width) * height);
+
+  for (int y = 0; y < height; y++)
+    for (int x = 0; x < width; x++)
+      cells[static_cast<size_t>(y) * width + x] = baseLayout != nullptr ? baseLayout->getCharAt(x, y) : 'W';
+
+  for (const Modification &mod : mods)
+    if (isInside(mod.x, mod.y)) cells[static_cast<size_t>(mod.y) * width + mod.x] = mod.newChar;
+}
+
 //////////////////////////////////////////        isWallAt       /////////////////////////////////////////////
 
 bool Room::isWallAt(int x, int y) const
@@ -565,6 +751,117 @@ bool Room::hasLineOfSight(int x1, int y1, int x2, int y2)
   return true;
 }
 
+//////////////////////////////////////////        navigation        /////////////////////////////////////////////
+
+// Where a player can stand: not a wall or the legend, not a breakable or switch wall,
+// not an obstacle block and not a door (doors lead out of the room). Springs are left
+// out too: walking into one launches the player off the path.
+static bool isNavPassableChar(char c)
+{
+  if (BlockingChars::isBlockingChar(c) || (c >= '0' && c <= '9')) return false;
+  return c != ObjectType::BREAKABLE_WALL && c != ObjectType::SWITCH_WALL && c != ObjectType::OBSTACLE_BLOCK
+      && c != ObjectType::SPRING;
+}
+
+bool Room::isNavPassable(int x, int y) const
+{
+  return isInside(x, y) && !isWallAt(x, y) && isNavPassableChar(getCharAt(x, y));
+}
+
+bool Room::isNavSource(NavTarget target, char c) const
+{
+  bool door = c >= '0' && c <= '9';
+  switch (target)
+  {
+  case NavTarget::DOOR:
+    return door;
+  case NavTarget::KEY:
+    return c == ObjectType::KEY;
+  case NavTarget::SWITCH:
+    return c == ObjectType::SWITCH_OFF;
+  case NavTarget::EXIT:
+    return door && (c - '0' == nextRoomId || (getDoorTargetRoomId(c - '0') != -1 && getDoorTargetRoomId(c - '0') != prevRoomId));
+  case NavTarget::BOMB:
+  case NavTarget::BLAST:
+    return c == ObjectType::BOMB;
+  case NavTarget::BREAKABLE:
+    return c == ObjectType::BREAKABLE_WALL;
+  case NavTarget::OBSTACLE:
+    return c == ObjectType::OBSTACLE_BLOCK;
+  default:
+    return false;
+  }
+}
+
+std::vector<Point> Room::navSources(NavTarget target) const
+{
+  std::vector<Point> sources;
+  if (target == NavTarget::SPAWN)
+  {
+    for (const Point &spawn : {spawnPoint, spawnPointFromNext})
+      if (isInside(spawn.getX(), spawn.getY())) sources.push_back(spawn);
+    return sources;
+  }
+
+  for (int y = 0; y < getHeight(); y++)
+    for (int x = 0; x < getWidth(); x++)
+    {
+      if (!isNavSource(target, getCharAt(x, y))) continue;
+
+      // A bomb's sprite stays the same once lit; its state tells which field it belongs to
+      if (target == NavTarget::BOMB || target == NavTarget::BLAST)
+      {
+        const Bomb *bomb = dynamic_cast<const Bomb *>(getObjectAt(x, y));
+        if (bomb == nullptr || (bomb->getState() == BombState::TICKING) != (target == NavTarget::BLAST)) continue;
+      }
+      sources.push_back(Point(x, y));
+    }
+  return sources;
+}
+
+void Room::invalidateNavigation()
+{
+  for (DistanceField &field : navFields) field.invalidate();
+}
+
+// A cell changed: a cell that opened or closed is patched into the fields in place;
+// adding or removing a target rebuilds that field on next query
+void Room::updateNavigation(int x, int y, char before, char after)
+{
+  bool anyValid = false;
+  for (const DistanceField &field : navFields) anyValid |= field.isValid();
+  if (!anyValid) return;
+
+  auto passable = [this](int cx, int cy) { return isNavPassable(cx, cy); };
+  bool wasOpen = isNavPassableChar(before);
+  bool opened = isNavPassable(x, y);
+
+  for (int t = 0; t < static_cast<int>(NavTarget::COUNT); t++)
+  {
+    DistanceField &field = navFields[t];
+    if (!field.isValid()) continue;
+
+    NavTarget target = static_cast<NavTarget>(t);
+    if (isNavSource(target, before) || isNavSource(target, after)) field.invalidate();
+    else if (opened && !wasOpen) field.openCell(x, y, passable);
+    else if (wasOpen && !opened) field.closeCell(x, y, passable);
+  }
+}
+
+int Room::distanceTo(NavTarget target, int x, int y)
+{
+  DistanceField &field = navFields[static_cast<int>(target)];
+  if (!field.isValid())
+    field.compute(getWidth(), getHeight(), navSources(target), [this](int cx, int cy) { return isNavPassable(cx, cy); });
+  return field.at(x, y);
+}
+
+Direction Room::directionTo(NavTarget target, int x, int y)
+{
+  distanceTo(target, x, y);
+  return navFields[static_cast<int>(target)].stepFrom(x, y);
+}
+
 //////////////////////////////////////////     updatePuzzleState       /////////////////////////////////////////////
 
 void Room::updatePuzzleState()
@@ -583,7 +880,7 @@ void Room::updatePuzzleState()
         if (sww != nullptr && sww->isRemovedBySwitch())
         {
           setCharAt(sww->getX(), sww->getY(), ' ');
-          Renderer::printAt(sww->getX(), sww->getY(), ' ');
+          Renderer::printCell(sww->getX(), sww->getY(), ' ');
           sww->setActive(false);
         }
       }
@@ -670,16 +967,36 @@ void Room::updateVisibility(Player *p1, Player *p2)
 {
   if (darkZones.empty()) return;
 
-  initVisibility();
+  // Tiles in the active area are reused, the rest released: only active cells are
+  // tracked, isVisible answers for the others from the zones
+  int across = chunksAcross(getWidth());
+  for (size_t i = 0; i < visibility.size(); i++)
+  {
+    std::unique_ptr<VisibilityChunk> &chunk = visibility[i];
+    if (!chunk) continue;
 
+    int x1 = static_cast<int>(i % across) * CHUNK_SIZE;
+    int y1 = static_cast<int>(i / across) * CHUNK_SIZE;
+    CellRect tile(x1, y1, x1 + CHUNK_SIZE - 1, y1 + CHUNK_SIZE - 1);
+    if (!tile.overlaps(activeAreas[0]) && !tile.overlaps(activeAreas[1]) && !tile.overlaps(activeAreas[2]))
+    {
+      chunk.reset();
+      continue;
+    }
+
+    for (auto &row : chunk->cells)
+      for (VisibilityState &cell : row) cell = VisibilityState::INNER;
+  }
+
+  const CellRect inside(0, 0, getWidth() - 1, getHeight() - 1);
   for (const DarkZone &zone : darkZones)
   {
-    for (int y = zone.y1; y <= zone.y2; y++)
+    CellRect dark = CellRect(zone.x1, zone.y1, zone.x2, zone.y2).clippedTo(inside);
+    for (const CellRect &area : activeAreas)
     {
-      for (int x = zone.x1; x <= zone.x2; x++)
-      {
-        if (x >= 0 && x < MAX_X && y >= 0 && y < MAX_Y) visibilityMap[y][x] = VisibilityState::DARK;
-      }
+      CellRect cells = dark.clippedTo(area);
+      for (int y = cells.y1; y <= cells.y2; y++)
+        for (int x = cells.x1; x <= cells.x2; x++) setVisibility(x, y, VisibilityState::DARK);
     }
   }
 
@@ -707,25 +1024,30 @@ void Room::lightRadius(int centerX, int centerY, int radius)
       int x = centerX + dx;
       int y = centerY + dy;
 
-      if (x < 0 || x >= MAX_X || y < 0 || y >= MAX_Y) continue;
+      if (!isInside(x, y)) continue;
 
       double distance = sqrt(dx * dx + dy * dy);
       if (distance > radius) continue;
 
       // Distance-based visibility: CLOSE (≤2), INNER (>2 but <radius), EDGE (at radius)
       if (distance <= 2)
-        visibilityMap[y][x] = VisibilityState::CLOSE;
+        setVisibility(x, y, VisibilityState::CLOSE);
       else if (distance > radius - 1)
-        visibilityMap[y][x] = VisibilityState::EDGE;
+        setVisibility(x, y, VisibilityState::EDGE);
       else
-        visibilityMap[y][x] = VisibilityState::INNER;
+        setVisibility(x, y, VisibilityState::INNER);
     }
   }
 }
 
 //////////////////////////////////////////         isVisible       /////////////////////////////////////////////
 
-bool Room::isVisible(int x, int y) const { return x >= 0 && x < MAX_X && y >= 0 && y < MAX_Y && visibilityMap[y][x] != VisibilityState::DARK; }
+bool Room::isVisible(int x, int y) const
+{
+  if (!isInside(x, y)) return false;
+  if (!isActiveCell(x, y)) return !isInDarkZone(x, y);
+  return getVisibility(x, y) != VisibilityState::DARK;
+}
 
 //////////////////////////////////////////     updateAllObjects       /////////////////////////////////////////////
 
@@ -735,7 +1057,8 @@ ExplosionResult Room::updateAllObjects(Player *p1, Player *p2)
 
   for (GameObject *obj : objects)
   {
-    if (obj && obj->isActive())
+    // Objects far from both players wait until someone comes near
+    if (obj && obj->isActive() && isActiveCell(obj->getX(), obj->getY()))
     {
       if (obj->getType() == ObjectType::BOMB)
       {
@@ -758,15 +1081,8 @@ ExplosionResult Room::updateAllObjects(Player *p1, Player *p2)
     }
   }
 
-  for (int i = static_cast<int>(objects.size()) - 1; i >= 0; i--)
-  {
-    if (objects[i] && !objects[i]->isActive())
-    {
-      delete objects[i];
-      objects.erase(objects.begin() + i);
-    }
-  }
-
+  // Springs and obstacles look at their links/blocks, so settle them before
+  // the inactive objects are deleted. reconstruct() may append obstacles.
   for (int i = static_cast<int>(springs.size()) - 1; i >= 0; i--)
   {
     if (springs[i] && springs[i]->allLinksInactive())
@@ -776,9 +1092,9 @@ ExplosionResult Room::updateAllObjects(Player *p1, Player *p2)
     }
   }
 
-  for (Obstacle *obstacle : obstacles)
+  for (size_t i = 0; i < obstacles.size(); i++)
   {
-    if (obstacle && obstacle->needsReconstruction()) obstacle->reconstruct(this);
+    if (obstacles[i] && obstacles[i]->needsReconstruction()) obstacles[i]->reconstruct(this);
   }
 
   for (int i = static_cast<int>(obstacles.size()) - 1; i >= 0; i--)
@@ -791,6 +1107,15 @@ ExplosionResult Room::updateAllObjects(Player *p1, Player *p2)
     }
   }
 
+  for (int i = static_cast<int>(objects.size()) - 1; i >= 0; i--)
+  {
+    if (objects[i] && !objects[i]->isActive())
+    {
+      delete objects[i];
+      objects.erase(objects.begin() + i);
+    }
+  }
+
   return totalResult;
 }
 
@@ -911,20 +1236,23 @@ void Room::scanAndCreateSprings()
   if (baseLayout == nullptr)
     return;
 
+  const int width = baseLayout->getWidth();
+  const int height = baseLayout->getHeight();
+
   std::vector<Point> allSpringCells;
-  for (int y = 0; y < MAX_Y; y++)
-    for (int x = 0; x < MAX_X; x++)
+  for (int y = 0; y < height; y++)
+    for (int x = 0; x < width; x++)
       if (baseLayout->getCharAt(x, y) == '#') allSpringCells.push_back(Point(x, y));
 
-  bool processed[MAX_Y][MAX_X] = {{false}};
+  std::vector<char> processed(static_cast<size_t>(width) * height, 0);
 
   for (const Point &p : allSpringCells)
   {
-    if (processed[p.getY()][p.getX()]) continue;
+    if (processed[p.getY() * width + p.getX()]) continue;
 
     std::vector<Point> group;
     group.push_back(p);
-    processed[p.getY()][p.getX()] = true;
+    processed[p.getY() * width + p.getX()] = 1;
 
     for (size_t i = 0; i < group.size(); i++)
     {
@@ -936,12 +1264,12 @@ void Room::scanAndCreateSprings()
 
       for (const Point &neighbor : neighbors)
       {
-        if (neighbor.getX() >= 0 && neighbor.getX() < MAX_X && neighbor.getY() >= 0 &&
-            neighbor.getY() < MAX_Y && !processed[neighbor.getY()][neighbor.getX()] &&
+        if (neighbor.getX() >= 0 && neighbor.getX() < width && neighbor.getY() >= 0 &&
+            neighbor.getY() < height && !processed[neighbor.getY() * width + neighbor.getX()] &&
             baseLayout->getCharAt(neighbor.getX(), neighbor.getY()) == '#')
         {
           group.push_back(neighbor);
-          processed[neighbor.getY()][neighbor.getX()] = true;
+          processed[neighbor.getY() * width + neighbor.getX()] = 1;
         }
       }
     }
@@ -1013,16 +1341,46 @@ void Room::createMultiCellObject(const std::vector<Point> &allObjCells)
 
   char ch = baseLayout->getCharAt(allObjCells[0].getX(), allObjCells[0].getY());
 
-  bool processed[MAX_Y][MAX_X] = {{false}};
+  for (const std::vector<Point> &group : groupCells(baseLayout, allObjCells))
+  {
+    switch (ch)
+    {
+    case '#':
+      createSpringFromGroup(group);
+      break;
+    case '*':
+    {
+      std::unordered_map<Point, std::vector<Point>> edges = obstacleEdges(baseLayout, group);
+      createObstacleFromGroup(group, edges);
+      break;
+    }
+    default:
+      break;
+    }
+  }
+}
+
+///////////////////////////////////////////        groupCells             /////////////////////////////////////////////
+
+// Connected groups of same-char cells, each in BFS order from its first cell in scan order
+std::vector<std::vector<Point>> Room::groupCells(const Screen *layout, const std::vector<Point> &allObjCells)
+{
+  std::vector<std::vector<Point>> groups;
+  if (layout == nullptr || allObjCells.empty()) return groups;
+
+  char ch = layout->getCharAt(allObjCells[0].getX(), allObjCells[0].getY());
+
+  const int width = layout->getWidth();
+  const int height = layout->getHeight();
+  std::vector<char> processed(static_cast<size_t>(width) * height, 0);
 
   for (const Point &p : allObjCells)
   {
-    if (processed[p.getY()][p.getX()]) continue;
+    if (processed[p.getY() * width + p.getX()]) continue;
 
     std::vector<Point> group;
-    std::unordered_map<Point, std::vector<Point>> edges;
     group.push_back(p);
-    processed[p.getY()][p.getX()] = true;
+    processed[p.getY() * width + p.getX()] = 1;
 
     for (size_t i = 0; i < group.size(); i++)
     {
@@ -1034,35 +1392,49 @@ void Room::createMultiCellObject(const std::vector<Point> &allObjCells)
 
       for (const Point &neighbor : neighbors)
       {
-        if (neighbor.getX() >= 0 && neighbor.getX() < MAX_X && neighbor.getY() >= 0 &&
-            neighbor.getY() < MAX_Y && !processed[neighbor.getY()][neighbor.getX()])
+        if (neighbor.getX() >= 0 && neighbor.getX() < width && neighbor.getY() >= 0 &&
+            neighbor.getY() < height && !processed[neighbor.getY() * width + neighbor.getX()] &&
+            layout->getCharAt(neighbor.getX(), neighbor.getY()) == ch)
         {
-          if (baseLayout->getCharAt(neighbor.getX(), neighbor.getY()) != ch)
-          {
-            if (ch == '*') edges[group[i]].push_back(neighbor);
-          }
-
-          else
-          {
-            group.push_back(neighbor);
-            processed[neighbor.getY()][neighbor.getX()] = true;
-          }
+          group.push_back(neighbor);
+          processed[neighbor.getY() * width + neighbor.getX()] = 1;
         }
       }
     }
 
-    switch (ch)
+    groups.push_back(group);
+  }
+
+  return groups;
+}
+
+///////////////////////////////////////////       obstacleEdges           /////////////////////////////////////////////
+
+// In-bounds neighbours of each group cell that are not part of the obstacle
+std::unordered_map<Point, std::vector<Point>> Room::obstacleEdges(const Screen *layout, const std::vector<Point> &group)
+{
+  std::unordered_map<Point, std::vector<Point>> edges;
+  if (layout == nullptr || group.empty()) return edges;
+
+  char ch = layout->getCharAt(group[0].getX(), group[0].getY());
+
+  for (const Point &cell : group)
+  {
+    int x = cell.getX();
+    int y = cell.getY();
+
+    Point neighbors[] = {Point(x + 1, y), Point(x - 1, y), Point(x, y + 1),
+                         Point(x, y - 1)};
+
+    for (const Point &neighbor : neighbors)
     {
-    case '#':
-      createSpringFromGroup(group);
-      break;
-    case '*':
-      createObstacleFromGroup(group, edges);
-      break;
-    default:
-      break;
+      if (neighbor.getX() >= 0 && neighbor.getX() < layout->getWidth() && neighbor.getY() >= 0 &&
+          neighbor.getY() < layout->getHeight() && layout->getCharAt(neighbor.getX(), neighbor.getY()) != ch)
+        edges[cell].push_back(neighbor);
     }
   }
+
+  return edges;
 }
 
 ///////////////////////////////////////////    createSpringFromGroup       /////////////////////////////////////////////
@@ -1157,6 +1529,8 @@ void Room::createObstacleFromGroup(
 
 void Room::drawLegend(Player *p1, Player *p2)
 {
+  if (!Renderer::shouldRender()) return;
+
   drawEmptyLegend();
   drawLegendInfo(p1, p2);
 }
@@ -1166,7 +1540,7 @@ void Room::drawEmptyLegend()
   int startX = legendTopLeft.getX() - 1;
   int startY = legendTopLeft.getY() - 1;
 
-  for (int i = 0; i < 5; i++) Renderer::printAt(startX, startY + i, legendData[i]);
+  for (int i = 0; i < 5; i++) Renderer::printCell(startX, startY + i, legendData[i]);
 }
 
 void Room::drawLegendInfo(Player *p1, Player *p2)
@@ -1181,12 +1555,11 @@ void Room::drawPlayerStats(Player *p)
   int lineY = legendTopLeft.getY() + p->getId();
   int startX = legendTopLeft.getX();
 
-  Renderer::gotoxy(startX + 3, lineY);
-  Renderer::print(p->getScore());
+  if (Renderer::gotoCell(startX + 3, lineY)) Renderer::print(p->getScore());
 
   DrawLives(p);
 
-  Renderer::gotoxy(startX + 17, lineY);
+  if (!Renderer::gotoCell(startX + 17, lineY)) return;
   if (p->hasItem()) 
   {
     const GameObject* inv = p->getInventory();
@@ -1207,16 +1580,16 @@ void Room::DrawLives(Player *p)
   switch (p->getLives())
   {
   case 3:
-    Renderer::printAt(offset, lineY, "<3 <3 <3");
+    Renderer::printCell(offset, lineY, "<3 <3 <3");
     break;
   case 2:
-    Renderer::printAt(offset + 1, lineY, "<3 <3");
+    Renderer::printCell(offset + 1, lineY, "<3 <3");
     break;
   case 1:
-    Renderer::printAt(offset + 3, lineY, "<3");
+    Renderer::printCell(offset + 3, lineY, "<3");
     break;
   default:
-    Renderer::printAt(offset, lineY, "        ");
+    Renderer::printCell(offset, lineY, "        ");
     break;
   }
   
@@ -1227,7 +1600,7 @@ void Room::DrawLives(Player *p)
 
 bool Room::isVacantSpot(int x, int y)
 {
-  if (x < 0 || x >= MAX_X || y < 0 || y >= MAX_Y) return false;
+  if (!isInside(x, y)) return false;
 
   if (isWallAt(x, y)) return false;
 
@@ -1243,7 +1616,7 @@ Point Room::findSmartSpawn(Point base)
     Point target(base.getX(), base.getY() + 2);
 
     auto isValid = [&](Point p) {
-        if (p.getX() < 0 || p.getX() >= MAX_X || p.getY() < 0 || p.getY() >= MAX_Y) return false;
+        if (!isInside(p.getX(), p.getY())) return false;
         if (isWallAt(p.getX(), p.getY())) return false;
         return true;
     };
@@ -1290,29 +1663,353 @@ void Room::addExplosion(const PostExplosion& explosion)
 }
 
 
+// Also ticks the explosion timers, so it runs even when nothing is rendered
 void Room::drawExplosions()
 {
+  const bool render = Renderer::shouldRender();
+
   for (auto it = explosions.begin(); it != explosions.end(); )
   {
     PostExplosion& explosion = *it;
     
-    if (explosion.shouldShowWave())
+    if (render && explosion.shouldShowWave())
     {
       set_color(Color::Yellow);
-      for (const Point& cell : explosion.cells) Renderer::printAt(cell.getX(), cell.getY(), '~');
+      for (const Point& cell : explosion.cells) Renderer::printCell(cell.getX(), cell.getY(), '~');
       reset_color();
     }
 
-    else for (const Point& cell : explosion.cells) Renderer::printAt(cell.getX(), cell.getY(), ' ');
+    else if (render) for (const Point& cell : explosion.cells) Renderer::printCell(cell.getX(), cell.getY(), ' ');
     
     explosion.timer--;
     
     if (explosion.isFinished())
     {
-      for (const Point& cell : explosion.cells) Renderer::printAt(cell.getX(), cell.getY(), ' ');
+      if (render)
+        for (const Point& cell : explosion.cells) Renderer::printCell(cell.getX(), cell.getY(), ' ');
       it = explosions.erase(it);
     }
     
     else ++it;
   }
-}
\ No newline at end of file
+}
+
+//////////////////////////////////////////      saveState / loadState       /////////////////////////////////////////////
+
+void Room::saveState(StateWriter &out) const
+{
+  saveProgress(out);
+  saveObjects(out);
+  saveGrid(out);
+}
+
+bool Room::loadState(StateReader &in)
+{
+  return loadProgress(in) && loadObjects(in) && loadGrid(in);
+}
+
+//////////////////////////////////////////         digestState              /////////////////////////////////////////////
+
+void Room::digestState(StateDigest &digest, const std::string &prefix) const
+{
+  digestImage(saveImage(), digest, prefix);
+}
+
+void Room::digestImage(const RoomImage &image, StateDigest &digest, const std::string &prefix)
+{
+  digest.add(prefix + ".progress", image.progress);
+  digest.add(prefix + ".objects", image.objects);
+  digest.add(prefix + ".grid", image.grid);
+}
+
+//////////////////////////////////////////     saveImage / loadImage        /////////////////////////////////////////////
+
+RoomImage Room::saveImage() const
+{
+  StateWriter progress, objectState, grid;
+  saveProgress(progress);
+  saveObjects(objectState);
+  saveGrid(grid);
+
+  RoomImage image;
+  image.progress = progress.data();
+  image.objects = objectState.data();
+  image.grid = grid.data();
+  return image;
+}
+
+bool Room::loadImage(const RoomImage &image)
+{
+  StateReader progress(image.progress), objectState(image.objects), grid(image.grid);
+  return loadProgress(progress) && loadObjects(objectState) && loadGrid(grid);
+}
+
+//////////////////////////////////////////            release               /////////////////////////////////////////////
+
+void Room::release()
+{
+  deleteLevelObjects();
+  objects.shrink_to_fit();
+  springs.shrink_to_fit();
+  obstacles.shrink_to_fit();
+
+  mods.clear();
+  invalidateNavigation();
+  mods.shrink_to_fit();
+  explosions.clear();
+  explosions.shrink_to_fit();
+
+  initVisibility();
+}
+
+void Room::resetToShell()
+{
+  release();
+  active = false;
+  completed = false;
+  totalKeysInRoom = keysCollected = activeSwitches = totalSwitches = 0;
+  for (DoorRequirements &req : doorReqs) req.isUnlocked = false;
+}
+
+void Room::digestUntouched(StateDigest &digest, const std::string &prefix)
+{
+  digest.add(prefix + ".progress", std::string("untouched"));
+  digest.add(prefix + ".objects", std::string());
+  digest.add(prefix + ".grid", std::string());
+}
+
+//////////////////////////////////////////    saveProgress / loadProgress   /////////////////////////////////////////////
+
+void Room::saveProgress(StateWriter &out) const
+{
+  out.writeBool(active);
+  out.writeBool(completed);
+  out.writeInt(totalKeysInRoom);
+  out.writeInt(keysCollected);
+  out.writeInt(activeSwitches);
+  out.writeInt(totalSwitches);
+
+  out.writeUInt(doorReqs.size());
+  for (const DoorRequirements &req : doorReqs) out.writeBool(req.isUnlocked);
+}
+
+bool Room::loadProgress(StateReader &in)
+{
+  active = in.readBool();
+  completed = in.readBool();
+  totalKeysInRoom = static_cast<int>(in.readInt());
+  keysCollected = static_cast<int>(in.readInt());
+  activeSwitches = static_cast<int>(in.readInt());
+  totalSwitches = static_cast<int>(in.readInt());
+
+  size_t doorCount = in.readCount();
+  if (doorCount != doorReqs.size()) return false;
+  for (DoorRequirements &req : doorReqs) req.isUnlocked = in.readBool();
+
+  return in.ok();
+}
+
+//////////////////////////////////////////    saveObjects / loadObjects     /////////////////////////////////////////////
+
+// liveOnly (search states) leaves out what is gone from play, picked up or blown up, so the
+// history of drops and pickups does not tell equal rooms apart; spring links and obstacle
+// blocks stay, their groups still list them
+void Room::saveObjects(StateWriter &out, bool liveOnly) const
+{
+  std::vector<const GameObject *> saved;
+  for (const GameObject *obj : objects)
+    if (!liveOnly || obj->isActive() || obj->getType() == ObjectType::SPRING_LINK || obj->getType() == ObjectType::OBSTACLE_BLOCK)
+      saved.push_back(obj);
+
+  ObjectIndex indexOf;
+  out.writeUInt(saved.size());
+  for (size_t i = 0; i < saved.size(); i++)
+  {
+    indexOf[saved[i]] = static_cast<long>(i);
+    writeObject(out, *saved[i]);
+  }
+
+  out.writeUInt(springs.size());
+  for (const Spring *spring : springs) spring->saveState(out, indexOf);
+
+  out.writeUInt(obstacles.size());
+  for (const Obstacle *obstacle : obstacles) obstacle->saveState(out, indexOf);
+}
+
+bool Room::loadObjects(StateReader &in)
+{
+  deleteAllObjects();
+  for (Spring *spring : springs) delete spring;
+  springs.clear();
+  for (Obstacle *obstacle : obstacles) delete obstacle;
+  obstacles.clear();
+
+  size_t objectCount = in.readCount();
+  for (size_t i = 0; i < objectCount && in.ok(); i++)
+  {
+    GameObject *obj = readObject(in);
+    if (obj == nullptr) return false;
+
+    if (obj->getType() == ObjectType::BOMB && static_cast<Bomb *>(obj)->getState() == BombState::TICKING)
+      static_cast<Bomb *>(obj)->attachRoom(this);
+
+    objects.push_back(obj);
+  }
+
+  size_t springCount = in.readCount();
+  for (size_t i = 0; i < springCount && in.ok(); i++)
+  {
+    Spring *spring = new Spring();
+    springs.push_back(spring);
+    if (!spring->loadState(in, objects)) return false;
+  }
+
+  size_t obstacleCount = in.readCount();
+  for (size_t i = 0; i < obstacleCount && in.ok(); i++)
+  {
+    Obstacle *obstacle = new Obstacle();
+    obstacles.push_back(obstacle);
+    if (!obstacle->loadState(in, objects)) return false;
+  }
+
+  return in.ok();
+}
+
+//////////////////////////////////////////      saveGrid / loadGrid         /////////////////////////////////////////////
+
+void Room::saveGrid(StateWriter &out) const
+{
+  saveOverlays(out, mods);
+
+  // Visibility is mostly long runs of one state, so it is run-length encoded
+  const int width = getWidth();
+  const size_t cellCount = static_cast<size_t>(width) * getHeight();
+  auto cellAt = [this, width](size_t i) { return getVisibility(static_cast<int>(i % width), static_cast<int>(i / width)); };
+  for (size_t i = 0; i < cellCount;)
+  {
+    VisibilityState state = cellAt(i);
+    size_t run = 1;
+    while (i + run < cellCount && cellAt(i + run) == state) run++;
+    out.writeEnum(state);
+    out.writeUInt(run);
+    i += run;
+  }
+}
+
+bool Room::loadGrid(StateReader &in)
+{
+  if (!loadOverlays(in)) return false;
+
+  initVisibility();
+
+  const int width = getWidth();
+  const size_t cellCount = static_cast<size_t>(width) * getHeight();
+  for (size_t i = 0; i < cellCount && in.ok();)
+  {
+    VisibilityState state = in.readEnum<VisibilityState>();
+    size_t run = in.readUInt();
+    if (run == 0 || run > cellCount - i) return false;
+    if (state != VisibilityState::INNER)
+      for (size_t r = i; r < i + run; r++) setVisibility(static_cast<int>(r % width), static_cast<int>(r / width), state);
+    i += run;
+  }
+
+  return in.ok();
+}
+
+//////////////////////////////////////////   saveOverlays / loadOverlays    /////////////////////////////////////////////
+
+void Room::saveOverlays(StateWriter &out, const std::vector<Modification> &cells) const
+{
+  out.writeUInt(cells.size());
+  for (const Modification &mod : cells)
+  {
+    out.writeInt(mod.x);
+    out.writeInt(mod.y);
+    out.writeChar(mod.newChar);
+  }
+
+  out.writeUInt(explosions.size());
+  for (const PostExplosion &explosion : explosions)
+  {
+    out.writeInt(explosion.timer);
+    out.writeUInt(explosion.cells.size());
+    for (const Point &cell : explosion.cells) out.writePoint(cell);
+  }
+}
+
+bool Room::loadOverlays(StateReader &in)
+{
+  mods.clear();
+  invalidateNavigation();
+  size_t modCount = in.readCount();
+  for (size_t i = 0; i < modCount && in.ok(); i++)
+  {
+    int x = static_cast<int>(in.readInt());
+    int y = static_cast<int>(in.readInt());
+    mods.push_back(Modification(x, y, in.readChar()));
+  }
+
+  explosions.clear();
+  size_t explosionCount = in.readCount();
+  for (size_t i = 0; i < explosionCount && in.ok(); i++)
+  {
+    PostExplosion explosion;
+    explosion.timer = static_cast<int>(in.readInt());
+    size_t cellCount = in.readCount();
+    for (size_t c = 0; c < cellCount && in.ok(); c++) explosion.cells.push_back(in.readPoint());
+    explosions.push_back(explosion);
+  }
+
+  return in.ok();
+}
+
+//////////////////////////////////////////   saveSearchState / loadSearchState   /////////////////////////////////////////////
+
+void Room::saveSearchState(StateWriter &out) const
+{
+  saveProgress(out);
+  saveObjects(out, true);
+
+  // Overlays that put back the layout's own char are history, not state
+  std::vector<Modification> sorted;
+  for (const Modification &mod : mods)
+    if (baseLayout == nullptr || baseLayout->getCharAt(mod.x, mod.y) != mod.newChar) sorted.push_back(mod);
+  std::sort(sorted.begin(), sorted.end(), [](const Modification &a, const Modification &b)
+            { return a.y != b.y ? a.y < b.y : a.x < b.x; });
+  saveOverlays(out, sorted);
+}
+
+bool Room::loadSearchState(StateReader &in)
+{
+  return loadProgress(in) && loadObjects(in) && loadOverlays(in);
+}
+
+//////////////////////////////////////////         checkInvariants          /////////////////////////////////////////////
+
+std::string Room::checkInvariants() const
+{
+  std::unordered_map<int, const GameObject *> blockingAt;
+
+  for (const GameObject *obj : objects)
+  {
+    if (obj == nullptr || !obj->isActive()) continue;
+
+    int x = obj->getX();
+    int y = obj->getY();
+    std::string where = std::string(obj->getName()) + " at (" + std::to_string(x) + "," + std::to_string(y) + ")";
+
+    if (!isInside(x, y)) return where + " is out of bounds";
+
+    char shown = getCharAt(x, y);
+    if (shown != obj->getSprite())
+      return where + " shows '" + std::string(1, shown) + "' in the grid instead of '" + std::string(1, obj->getSprite()) + "'";
+
+    if (!obj->isBlocking()) continue;
+
+    auto placed = blockingAt.emplace(y * getWidth() + x, obj);
+    if (!placed.second) return where + " overlaps " + placed.first->second->getName();
+  }
+
+  return "";
+}
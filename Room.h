@@ -4,9 +4,13 @@
 //////////////////////////////////////////       INCLUDES & FORWARDS       /////////////////////////////////////////////
 
 #include "Constants.h"
+#include "DistanceField.h"
 #include "GameObject.h"
 #include "Screen.h"
 #include "Bomb.h"
+#include <algorithm>
+#include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -14,6 +18,9 @@ class Player;
 class Spring;
 class Obstacle;
 class ObstacleBlock;
+class StateWriter;
+class StateReader;
+struct StateDigest;
 
 //////////////////////////////////////////        Modification       /////////////////////////////////////////////
 
@@ -44,6 +51,35 @@ struct DarkZone
   }
 };
 
+//////////////////////////////////////////          CellRect       /////////////////////////////////////////////
+
+// Room cells from (x1, y1) to (x2, y2), inclusive
+struct CellRect
+{
+  int x1, y1;
+  int x2, y2;
+
+  CellRect() : x1(0), y1(0), x2(-1), y2(-1) {}
+  CellRect(int _x1, int _y1, int _x2, int _y2)
+      : x1(_x1), y1(_y1), x2(_x2), y2(_y2) {}
+
+  bool contains(int x, int y) const
+  {
+    return x >= x1 && x <= x2 && y >= y1 && y <= y2;
+  }
+
+  bool overlaps(const CellRect &other) const
+  {
+    return x1 <= other.x2 && other.x1 <= x2 && y1 <= other.y2 && other.y1 <= y2;
+  }
+
+  // Empty (x2 < x1 or y2 < y1) when the two do not overlap
+  CellRect clippedTo(const CellRect &other) const
+  {
+    return CellRect(std::max(x1, other.x1), std::max(y1, other.y1), std::min(x2, other.x2), std::min(y2, other.y2));
+  }
+};
+
 //////////////////////////////////////////      ExplosionResult       /////////////////////////////////////////////
 
 struct ExplosionResult
@@ -75,6 +111,16 @@ struct DoorRequirements
         isUnlocked(false) {}
 };
 
+//////////////////////////////////////////         RoomImage       /////////////////////////////////////////////
+
+// The play state of a released room: its three keyframe sections, kept as bytes
+struct RoomImage
+{
+  std::string progress;
+  std::string objects;
+  std::string grid;
+};
+
 //////////////////////////////////////////           Room       /////////////////////////////////////////////
 
 // Represents a single game room
@@ -111,12 +157,38 @@ class Room
   Point spawnPointFromNext;
   std::vector<DarkZone> darkZones;
   std::vector<PostExplosion> explosions;
-  VisibilityState visibilityMap[MAX_Y][MAX_X];
+
+  // Visibility in CHUNK_SIZE tiles, allocated where a dark zone reaches; a missing
+  // tile is all INNER
+  struct VisibilityChunk
+  {
+    VisibilityState cells[CHUNK_SIZE][CHUNK_SIZE];
+  };
+  std::vector<std::unique_ptr<VisibilityChunk>> visibility;
+
+  // Cells simulated this tick, aligned to chunks: a view around each player and the
+  // camera's view, plus ACTIVE_MARGIN (rooms no larger than the view are all active)
+  CellRect activeAreas[3];
+
+  // BFS fields per NavTarget, built on first query and patched by setCharAt. A cache
+  // only: never copied, saved or hashed
+  DistanceField navFields[static_cast<int>(NavTarget::COUNT)];
 
   void copyObjectsFrom(const Room &other);
   void deleteAllObjects();
+  void deleteLevelObjects();
   void initVisibility();
+  void copyVisibilityFrom(const Room &other);
+  VisibilityState getVisibility(int x, int y) const;
+  void setVisibility(int x, int y, VisibilityState state);
+  CellRect activeAreaAround(Point origin) const;
+  CellRect viewArea() const;
   void setColorForChar(char c);
+  bool isNavPassable(int x, int y) const;
+  bool isNavSource(NavTarget target, char c) const;
+  std::vector<Point> navSources(NavTarget target) const;
+  void invalidateNavigation();
+  void updateNavigation(int x, int y, char before, char after);
 
   char getCharAt(int x, int y) const;
 
@@ -129,11 +201,22 @@ class Room
                                      Direction orientation);
   void scanAndCreateSprings();
   void createMultiCellObject(const std::vector<Point> &allObjCells);
+  void addObjectFromCell(int x, int y, char ch, const std::vector<int> *riddleIds, int *riddleIndex);
   void createSpringFromGroup(const std::vector<Point> &group);
   void createObstacleFromGroup(
       const std::vector<Point> &group,
       std::unordered_map<Point, std::vector<Point>> &neighbors);
 
+  // Keyframe sections, hashed separately by digestState
+  void saveProgress(StateWriter &out) const; // flags, counters, door locks
+  void saveObjects(StateWriter &out, bool liveOnly = false) const; // objects, springs, obstacles
+  void saveGrid(StateWriter &out) const;     // overlays, explosions, visibility
+  bool loadProgress(StateReader &in);
+  bool loadObjects(StateReader &in);
+  bool loadGrid(StateReader &in);
+  void saveOverlays(StateWriter &out, const std::vector<Modification> &cells) const;
+  bool loadOverlays(StateReader &in);
+
 
 public:
   Room();
@@ -147,6 +230,11 @@ public:
   bool isActive() const { return active; }
   bool isCompleted() const { return completed; }
   const Screen* getBaseLayout() const { return baseLayout; }
+  // Cells changed from the base layout, one entry per cell with its current char
+  const std::vector<Modification> &getModifications() const { return mods; }
+  int getWidth() const { return baseLayout != nullptr ? baseLayout->getWidth() : MAX_X; }
+  int getHeight() const { return baseLayout != nullptr ? baseLayout->getHeight() : MAX_Y; }
+  bool isInside(int x, int y) const { return x >= 0 && x < getWidth() && y >= 0 && y < getHeight(); }
   int getNextRoomId() const { return nextRoomId; }
   int getPrevRoomId() const { return prevRoomId; }
   int getTotalKeysInRoom() const { return totalKeysInRoom; }
@@ -172,6 +260,7 @@ public:
   void setSpawnPointFromNext(const Point& p) { spawnPointFromNext = p; }
   void setNextRoomId(int id) { nextRoomId = id; }
   void setPrevRoomId(int id) { prevRoomId = id; }
+  void setBaseLayout(const Screen *layout) { baseLayout = layout; }
   
   // Obstacle access (for iteration)
   const std::vector<Obstacle*>& getObstacles() const { return obstacles; }
@@ -180,7 +269,14 @@ public:
   // Initialization
   void initFromLayout(const Screen *layout, const std::vector<int> *riddleIds = nullptr, int *riddleIndex = nullptr);
   void loadObjects(const std::vector<int> *riddleIds = nullptr, int *riddleIndex = nullptr);
+  void initFromCells(const Screen *layout, const std::vector<Point> &objectCells,
+                     const std::vector<std::vector<Point>> &springGroups,
+                     const std::vector<std::vector<Point>> &obstacleGroups,
+                     const std::vector<int> *riddleIds = nullptr, int *riddleIndex = nullptr);
+  static std::vector<std::vector<Point>> groupCells(const Screen *layout, const std::vector<Point> &allObjCells);
+  static std::unordered_map<Point, std::vector<Point>> obstacleEdges(const Screen *layout, const std::vector<Point> &group);
   void setDoorRequirements(int doorId, int keys, int switches = 0, int targetRoomId = -1);
+  void clearDoorRequirements() { doorReqs.clear(); }
   void setLegendPoint(int x, int y) { legendTopLeft = Point(x, y); };
 
   // Drawing
@@ -202,6 +298,8 @@ public:
 
   // Query methods
   ObjectType getObjectTypeAt(int x, int y) const;
+  // Every cell's char (layout + overlays), row-major, in one pass
+  void copyGrid(std::string &cells) const;
   bool isWallAt(int x, int y) const;
 
   // Object management
@@ -232,6 +330,11 @@ public:
   bool isBlocked(int x, int y);
   bool hasLineOfSight(int x1, int y1, int x2, int y2);
 
+  // Navigation: steps from (x, y) to the nearest target (DistanceField::UNREACHABLE if
+  // none), and the first step of such a path
+  int distanceTo(NavTarget target, int x, int y);
+  Direction directionTo(NavTarget target, int x, int y);
+
   // Puzzle & door system
   void updatePuzzleState();
   int countActiveSwitches() const;
@@ -248,6 +351,43 @@ public:
   void lightRadius(int centerX, int centerY, int radius);
   bool isVisible(int x, int y) const;
 
+  // Large rooms: the console shows a MAX_X x MAX_Y view of the room, and each tick
+  // simulates only the chunks near the players (set at the start of the tick)
+  Point viewOrigin(int focusX, int focusY) const;
+  Point cameraFor(const Player *p1, const Player *p2) const;
+  void updateActiveArea(const Player *p1, const Player *p2);
+  bool isActiveCell(int x, int y) const
+  {
+    return activeAreas[0].contains(x, y) || activeAreas[1].contains(x, y) || activeAreas[2].contains(x, y);
+  }
+
   // Explosion animations
   void addExplosion(const PostExplosion& explosion);
+
+  // Keyframes: everything that changes during play. Layout, doors, spawns and
+  // dark zones come from the level files and are rebuilt by initializeRooms.
+  void saveState(StateWriter &out) const;
+  bool loadState(StateReader &in);
+  void digestState(StateDigest &digest, const std::string &prefix) const;
+
+  // -solve: the keyframe sections minus visibility (drawing only), overlays in cell
+  // order, so two rooms that play the same save the same bytes
+  void saveSearchState(StateWriter &out) const;
+  bool loadSearchState(StateReader &in);
+
+  // Residency: release() drops everything saveImage() records, leaving the layout and
+  // metadata; loadImage() brings the room back exactly as it was
+  RoomImage saveImage() const;
+  bool loadImage(const RoomImage &image);
+  void release();
+  static void digestImage(const RoomImage &image, StateDigest &digest, const std::string &prefix);
+
+  // A room not yet entered: release() plus the progress, as initializeRooms left it.
+  // Its digest is a constant, the same sections as digestImage.
+  void resetToShell();
+  static void digestUntouched(StateDigest &digest, const std::string &prefix);
+
+  // Consistency checks for fuzzing: every active object in bounds and drawn in the
+  // grid (base layout + mods), no two blocking objects on one cell. "" when all hold.
+  std::string checkInvariants() const;
 };
@@ -5,32 +5,27 @@
 
 //////////////////////////////////////////         constructors         //////////////////////////////////////////
 
-Screen::Screen()
-{
-    for (int i = 0; i < MAX_Y; i++)
-      screen[i] = nullptr;
-}
+Screen::Screen() : width(MAX_X), height(MAX_Y), screen(MAX_Y, nullptr) {}
 
-Screen::Screen(const char *layout[MAX_Y])
-{
-    for (int i = 0; i < MAX_Y; i++)
-      screen[i] = layout[i];
-}
+Screen::Screen(const char *layout[MAX_Y]) : width(MAX_X), height(MAX_Y), screen(layout, layout + MAX_Y) {}
 
-Screen::Screen(const std::string layout[MAX_Y])
+// Rows are expected padded to one width, as LevelLoader reads them
+Screen::Screen(const std::vector<std::string> &layout)
+    : width(layout.empty() ? 0 : static_cast<int>(layout[0].size())), height(static_cast<int>(layout.size())),
+      screen(), ownedData(layout)
 {
-    for (int i = 0; i < MAX_Y; i++)
-    {
-      ownedData[i] = layout[i];
-      screen[i] = ownedData[i].c_str();
-    }
+    for (const std::string &row : ownedData)
+      screen.push_back(row.c_str());
 }
 
+Screen::Screen(const std::vector<const char *> &rows, int rowWidth)
+    : width(rowWidth), height(static_cast<int>(rows.size())), screen(rows) {}
+
 //////////////////////////////////////////         getCharAt          //////////////////////////////////////////
 
 char Screen::getCharAt(int x, int y) const
 {
-    if (x >= 0 && x < MAX_X && y >= 0 && y < MAX_Y && screen[y] != nullptr)
+    if (x >= 0 && x < width && y >= 0 && y < height && screen[y] != nullptr)
       return screen[y][x];
     return 'W';
 }
@@ -97,35 +92,30 @@ static void colorMenuChar(char c)
     set_color(Color::White);
 }
 
-void Screen::draw() const
+void Screen::draw() const { drawView(0, 0); }
+
+void Screen::drawView(int originX, int originY) const
 {
+    if (!Renderer::shouldRender()) return;
+
     Renderer::clrscr();
     Renderer::gotoxy(0, 0);
 
-    for (int i = 0; i < MAX_Y - 1; ++i)
+    for (int i = 0; i < MAX_Y; ++i)
     {
-      if (screen[i] != nullptr)
+      int y = originY + i;
+      if (y < 0 || y >= height || screen[y] == nullptr) continue;
+
+      for (int j = 0; screen[y][j] != '\0' && j < originX + MAX_X; ++j)
       {
-        for (int j = 0; screen[i][j] != '\0'; ++j)
-        {
-            char c = screen[i][j];
-            colorMenuChar(c);
-            Renderer::print(c);
-            reset_color();
-        }
-        Renderer::print('\n');
-      }
-    }
+          if (j < originX) continue;
 
-    if (screen[MAX_Y - 1] != nullptr)
-    {
-        for (int j = 0; screen[MAX_Y - 1][j] != '\0'; ++j)
-        {
-            char c = screen[MAX_Y - 1][j];
-            colorMenuChar(c);
-            Renderer::print(c);
-            reset_color();
-        }
+          char c = screen[y][j];
+          colorMenuChar(c);
+          Renderer::print(c);
+          reset_color();
+      }
+      if (i < MAX_Y - 1) Renderer::print('\n');
     }
     Renderer::flush();
 }
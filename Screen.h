@@ -7,21 +7,30 @@
 #include "Renderer.h"
 #include <iostream>
 #include <string>
+#include <vector>
 
 class Point;
 
 //////////////////////////////////////////          Screen       /////////////////////////////////////////////
 
+// A grid of characters: a menu the size of the console, or a room layout of any size
+// (rows either owned or borrowed, e.g. from a mapped level pack)
 class Screen
 {
-  const char *screen[MAX_Y];
-  std::string ownedData[MAX_Y];
+  int width;
+  int height;
+  std::vector<const char *> screen;
+  std::vector<std::string> ownedData;
 
 public:
   Screen();
   Screen(const char *layout[MAX_Y]);
-  Screen(const std::string layout[MAX_Y]);
-  
+  Screen(const std::vector<std::string> &layout);
+  Screen(const std::vector<const char *> &rows, int rowWidth);
+
+  int getWidth() const { return width; }
+  int getHeight() const { return height; }
+
   char getCharAt(int x, int y) const;
   char getCharAt(const Point &p) const;
 
@@ -33,4 +42,6 @@ public:
   ObjectType objectIs(const Point &p) const;
 
   void draw() const;
+  // Clears the console and draws the MAX_X x MAX_Y cells from (originX, originY)
+  void drawView(int originX, int originY) const;
 };
@@ -0,0 +1,204 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "ShadowChecker.h"
+#include "HeadlessGame.h"
+
+//////////////////////////////////////////        ReplicaGame         //////////////////////////////////////////
+
+// Headless copy of the live game, driven like LoadedGame: actions are applied at the
+// cycle they were recorded on and riddles take the recorded answer or are escaped.
+// Every method binds the replica's own context, so it never touches the live screen.
+class ReplicaGame : public HeadlessGame
+{
+    RecordedSteps steps;
+
+protected:
+    int getRiddleInput(unsigned long cycle) override
+    {
+        for (const ActionRecord &action : steps.getActionsForCycle(cycle))
+            if (action.action == Action::ANSWER_RIDDLE) return action.answer;
+        return -1;
+    }
+
+public:
+    // Records no events: nothing reads them, and the replica runs as long as the game
+    ReplicaGame(unsigned int seed, const std::string &dataDir, bool colorMode) : HeadlessGame(dataDir, false), steps()
+    {
+        context.colorMode = colorMode;
+        begin(seed);
+    }
+
+    void handleInput() override
+    {
+        const ActionRecord *curr = steps.getCurrentAction();
+
+        while (curr != nullptr && curr->cycle == cycleCount)
+        {
+            if (curr->action != Action::ANSWER_RIDDLE)
+            {
+                Player &player = (curr->playerId == 1) ? player1 : player2;
+                player.performAction(curr->action, getCurrentRoom());
+            }
+
+            steps.advanceToNextAction();
+            curr = steps.getCurrentAction();
+        }
+    }
+
+    void addAction(const ActionRecord &action) { steps.addAction(action); }
+
+    // Simulates up to the top of cycle; false when the replica stopped before it
+    bool advanceTo(unsigned long cycle)
+    {
+        GameContext::Scope bind(context);
+
+        while (currentState == GameState::inGame && cycleCount < cycle)
+        {
+            handleInput();
+            update();
+        }
+        return currentState == GameState::inGame && cycleCount == cycle;
+    }
+
+    StateDigest digest() { return digestState(); }
+};
+
+//////////////////////////////////////////     Constructor / Dtor     //////////////////////////////////////////
+
+ShadowChecker::ShadowChecker() : diverged(false) {}
+
+ShadowChecker::~ShadowChecker() { stop(); }
+
+//////////////////////////////////////////          start             //////////////////////////////////////////
+
+void ShadowChecker::start(unsigned int seed, const std::string &dataDir, bool colorMode, const std::string &logName)
+{
+    stop();
+
+    queue.clear();
+    diverged = false;
+    log.open(logName, std::ios::out | std::ios::app);
+
+    worker = std::thread(&ShadowChecker::run, this, seed, dataDir, colorMode);
+}
+
+//////////////////////////////////////////           stop             //////////////////////////////////////////
+
+void ShadowChecker::stop()
+{
+    if (!worker.joinable()) return;
+
+    Message message;
+    message.kind = Message::Kind::STOP;
+    message.cycle = 0;
+    push(message);
+
+    worker.join();
+    log.close();
+}
+
+//////////////////////////////////////////         feeding            //////////////////////////////////////////
+
+void ShadowChecker::push(Message message)
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push_back(std::move(message));
+    }
+    wake.notify_one();
+}
+
+void ShadowChecker::feedAction(const ActionRecord &action)
+{
+    if (!worker.joinable()) return;
+
+    Message message;
+    message.kind = Message::Kind::ACTION;
+    message.action = action;
+    message.cycle = action.cycle;
+    push(std::move(message));
+}
+
+void ShadowChecker::feedDigest(unsigned long cycle, const StateDigest &digest)
+{
+    if (!worker.joinable() || diverged) return;
+
+    Message message;
+    message.kind = Message::Kind::CHECK;
+    message.cycle = cycle;
+    message.names = digest.names;
+    message.parts = digest.parts;
+    push(std::move(message));
+}
+
+//////////////////////////////////////////          report            //////////////////////////////////////////
+
+void ShadowChecker::report(const std::string &line)
+{
+    if (!log.is_open()) return;
+    log << line << std::endl;
+}
+
+//////////////////////////////////////////            run             //////////////////////////////////////////
+
+void ShadowChecker::run(unsigned int seed, std::string dataDir, bool colorMode)
+{
+    ReplicaGame replica(seed, dataDir, colorMode);
+
+    std::string session = "Shadow of seed " + std::to_string(seed) + ": ";
+    bool checking = replica.getCurrentState() == GameState::inGame;
+    if (!checking) report(session + "could not build the replica from " + dataDir);
+
+    unsigned long lastChecked = 0;
+
+    while (true)
+    {
+        Message message;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            wake.wait(lock, [this] { return !queue.empty(); });
+            message = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        if (message.kind == Message::Kind::STOP) break;
+
+        if (message.kind == Message::Kind::ACTION)
+        {
+            replica.addAction(message.action);
+            continue;
+        }
+
+        if (!checking) continue;
+
+        if (!replica.advanceTo(message.cycle))
+        {
+            report(session + "replay stopped at cycle " + std::to_string(replica.getCycleCount()) +
+                   " while live play went on to " + std::to_string(message.cycle));
+            checking = false;
+            continue;
+        }
+
+        StateDigest replicaDigest = replica.digest();
+        std::string differing;
+        for (size_t i = 0; i < message.parts.size(); i++)
+        {
+            if (i < replicaDigest.parts.size() && replicaDigest.parts[i] == message.parts[i]) continue;
+            differing += (differing.empty() ? "" : ", ") + message.names[i];
+        }
+        if (replicaDigest.parts.size() != message.parts.size()) differing += differing.empty() ? "part count" : ", part count";
+
+        if (!differing.empty())
+        {
+            report(session + "diverged between cycles " + std::to_string(lastChecked) + " and " +
+                   std::to_string(message.cycle) + " (" + differing + ")");
+            diverged = true;
+            checking = false;
+            continue;
+        }
+
+        lastChecked = message.cycle;
+    }
+
+    if (checking) report(session + "matched through cycle " + std::to_string(lastChecked));
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Recorder.h"
+#include "Snapshot.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//////////////////////////////////////////       ShadowChecker        //////////////////////////////////////////
+
+// -shadow: replays a live session on a background thread while it is being played.
+// The live game feeds every recorded action and, every few cycles, its state digest;
+// the worker runs a headless replica from the same seed exactly the way -load would,
+// and logs the first cycle where the two states disagree. The game thread only
+// queues messages; all simulation and hashing of the replica happens on the worker.
+class ShadowChecker
+{
+    struct Message
+    {
+        enum class Kind { ACTION, CHECK, STOP };
+
+        Kind kind;
+        ActionRecord action;
+        unsigned long cycle;
+        std::vector<std::string> names;
+        std::vector<std::uint64_t> parts;
+    };
+
+    std::thread worker;
+    std::mutex queueMutex;
+    std::condition_variable wake;
+    std::deque<Message> queue;
+
+    std::ofstream log;
+    std::atomic<bool> diverged;
+
+    void push(Message message);
+    void run(unsigned int seed, std::string dataDir, bool colorMode);
+    void report(const std::string &line);
+
+public:
+    ShadowChecker();
+    ~ShadowChecker();
+    ShadowChecker(const ShadowChecker &) = delete;
+    ShadowChecker &operator=(const ShadowChecker &) = delete;
+
+    // Starts a replica of a game built by initializeRooms(seed) from dataDir; findings are
+    // appended to logName
+    void start(unsigned int seed, const std::string &dataDir, bool colorMode, const std::string &logName);
+
+    // Lets the replica catch up with everything queued so far, then ends it
+    void stop();
+    bool isRunning() const { return worker.joinable(); }
+
+    void feedAction(const ActionRecord &action);
+    // Live state at the top of cycle, before that cycle's input
+    void feedDigest(unsigned long cycle, const StateDigest &digest);
+
+    bool hasDiverged() const { return diverged; }
+};
@@ -0,0 +1,207 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Simulation.h"
+#include "HeadlessGame.h"
+#include "Riddle.h"
+#include "RiddleDatabase.h"
+
+//////////////////////////////////////////       SimulationGame       //////////////////////////////////////////
+
+// The game loop turned inside out: Simulation calls tick() once per cycle, with the keys
+// NormalGame::handleInput would have read
+class SimulationGame : public HeadlessGame
+{
+    const Simulation::RiddleAnswerer &answerer;
+
+protected:
+    int getRiddleInput(unsigned long cycle) override
+    {
+        (void)cycle;
+        if (!answerer || aRiddle.riddle == nullptr) return -1;
+
+        const RiddleData *data = context.riddles.getRiddle(aRiddle.riddle->getRiddleId());
+        if (data == nullptr) return -1;
+        return answerer(*data, aRiddle.player != nullptr ? aRiddle.player->getId() : 1);
+    }
+
+public:
+    SimulationGame(const std::string &dataDir, const Simulation::RiddleAnswerer &riddleAnswerer)
+        : HeadlessGame(dataDir), answerer(riddleAnswerer)
+    {
+    }
+
+    void tick(std::optional<Action> action1, std::optional<Action> action2)
+    {
+        GameContext::Scope bind(context);
+
+        events.clear();
+        Room *room = getCurrentRoom();
+        if (action1) player1.performAction(*action1, room);
+        if (action2) player2.performAction(*action2, room);
+        update();
+
+        // An escaped riddle pauses the game; nobody is at a pause menu, so play goes on
+        if (currentState == GameState::paused) currentState = GameState::inGame;
+    }
+
+    std::string save()
+    {
+        GameContext::Scope bind(context);
+        return captureKeyframe();
+    }
+
+    // Keyframes are taken in play, so a restored game is in play again
+    bool load(const std::string &state)
+    {
+        GameContext::Scope bind(context);
+
+        events.clear();
+        if (!restoreKeyframe(state)) return false;
+        currentState = GameState::inGame;
+        return true;
+    }
+
+    void startOver(const std::string &state)
+    {
+        if (load(state)) reportScreenChange(currentRoomId);
+    }
+
+    size_t getRoomCount() const { return rooms.size(); }
+};
+
+//////////////////////////////////////////         Simulation         //////////////////////////////////////////
+
+Simulation::Simulation()
+    : game(), levelsDir(), seed(0), initialState(), observation(), gridObservation(true), answerer()
+{
+    observation.cycle = 0;
+    observation.roomId = -1;
+    observation.state = GameState::error;
+    observation.width = observation.height = 0;
+    observation.viewX = observation.viewY = 0;
+}
+
+Simulation::~Simulation() = default;
+
+//////////////////////////////////////////           reset            //////////////////////////////////////////
+
+bool Simulation::reset(unsigned int randomSeed, const std::string &levels)
+{
+    if (game != nullptr && !initialState.empty() && randomSeed == seed && levels == levelsDir)
+    {
+        game->startOver(initialState);
+        observe();
+        return true;
+    }
+
+    levelsDir = levels;
+    seed = randomSeed;
+    initialState.clear();
+
+    game = std::make_unique<SimulationGame>(levelsDir, answerer);
+    if (!game->begin(seed))
+    {
+        observe();
+        observation.state = GameState::error;
+        return false;
+    }
+
+    std::vector<GameEvent> started = game->getEvents();
+    initialState = game->save();
+    observe();
+    observation.events = started;
+    return true;
+}
+
+//////////////////////////////////////////            step            //////////////////////////////////////////
+
+const Observation &Simulation::step(std::optional<Action> player1, std::optional<Action> player2)
+{
+    if (game == nullptr || isOver()) return observation;
+
+    game->tick(player1, player2);
+    observe();
+    return observation;
+}
+
+//////////////////////////////////////////          observe           //////////////////////////////////////////
+
+void Simulation::observe()
+{
+    observation.cycle = game->getCycleCount();
+    observation.roomId = game->getCurrentRoomId();
+    observation.state = game->getCurrentState();
+    observation.events = game->getEvents();
+
+    const Player *players[] = {&game->getPlayer1(), &game->getPlayer2()};
+    for (int i = 0; i < 2; i++)
+    {
+        const Player &p = *players[i];
+        observation.players[i] = PlayerObservation{p.getX(), p.getY(), p.getCurrentDirection(), p.getLives(),
+                                                   p.getKeyCount(), p.getScore(), p.getInventoryType(),
+                                                   p.isAlive(), p.isAtDoor(), p.isLaunched()};
+    }
+
+    const std::vector<Room> &rooms = game->getRooms();
+    if (observation.roomId < 0 || observation.roomId >= static_cast<int>(rooms.size()))
+    {
+        observation.width = observation.height = 0;
+        observation.viewX = observation.viewY = 0;
+        observation.grid.clear();
+        return;
+    }
+
+    const Room &room = rooms[observation.roomId];
+    observation.width = room.getWidth();
+    observation.height = room.getHeight();
+    Point view = room.cameraFor(players[0], players[1]);
+    observation.viewX = view.getX();
+    observation.viewY = view.getY();
+    if (gridObservation) room.copyGrid(observation.grid);
+    else observation.grid.clear();
+}
+
+//////////////////////////////////////////          helpers           //////////////////////////////////////////
+
+const Room *Simulation::getCurrentRoom() const
+{
+    if (game == nullptr) return nullptr;
+
+    const std::vector<Room> &rooms = game->getRooms();
+    int roomId = game->getCurrentRoomId();
+    return roomId >= 0 && roomId < static_cast<int>(rooms.size()) ? &rooms[roomId] : nullptr;
+}
+
+size_t Simulation::getRoomCount() const
+{
+    return game != nullptr ? game->getRoomCount() : 0;
+}
+
+ErrorCode Simulation::getError() const
+{
+    return game != nullptr ? game->getInitError() : ErrorCode::NONE;
+}
+
+void Simulation::setGridObservation(bool on)
+{
+    gridObservation = on;
+    if (game != nullptr) observe();
+}
+
+int Simulation::answerCorrectly(const RiddleData &riddle, int playerId)
+{
+    (void)playerId;
+    return riddle.correctAnswerIndex;
+}
+
+std::string Simulation::saveState()
+{
+    return game != nullptr ? game->save() : std::string();
+}
+
+bool Simulation::loadState(const std::string &state)
+{
+    if (game == nullptr || !game->load(state)) return false;
+    observe();
+    return true;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Constants.h"
+#include "Recorder.h"
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+class Room;
+class SimulationGame;
+struct RiddleData;
+
+//////////////////////////////////////////        Observation         //////////////////////////////////////////
+
+struct PlayerObservation
+{
+    int x, y;
+    Direction moving;
+    int lives;
+    int keys;
+    int score;
+    ObjectType item; // AIR when empty-handed
+    bool alive;
+    bool atDoor;
+    bool launched;
+};
+
+// What a step leaves behind. Players are not drawn into the grid.
+struct Observation
+{
+    unsigned long cycle;
+    int roomId;
+    GameState state; // inGame, victory, gameOver (error before a successful reset)
+    int width, height;
+    int viewX, viewY; // room cell at the console's top-left (rooms may be larger than the console)
+    std::string grid; // row-major room cells; empty while grid observation is off
+    PlayerObservation players[2];
+    std::vector<GameEvent> events; // reported during the last step (or reset)
+};
+
+//////////////////////////////////////////         Simulation         //////////////////////////////////////////
+
+// The game as a library: reset, then one step() per tick with each player's key (nullopt
+// when a player presses nothing). Each step is exactly a pass of the game loop, input then
+// Game::update, with no console, no sleeping and no shared state: the game's context is
+// bound to the calling thread only for the call, so simulations can run side by side.
+// Riddles are answered by the answerer (escaped when there is none, which resumes play
+// the way the pause menu would).
+class Simulation
+{
+public:
+    using RiddleAnswerer = std::function<int(const RiddleData &riddle, int playerId)>;
+
+private:
+    std::unique_ptr<SimulationGame> game;
+    std::string levelsDir;
+    unsigned int seed;
+    std::string initialState; // keyframe of the last reset, so resets of the same game skip loading
+    Observation observation;
+    bool gridObservation;
+    RiddleAnswerer answerer;
+
+    void observe();
+
+public:
+    Simulation();
+    ~Simulation();
+    Simulation(const Simulation &) = delete;
+    Simulation &operator=(const Simulation &) = delete;
+
+    // Starts a new game on the level files of levelsDir; false when they do not load (getError())
+    bool reset(unsigned int randomSeed, const std::string &levels = ".");
+    const Observation &step(std::optional<Action> player1, std::optional<Action> player2);
+
+    const Observation &getObservation() const { return observation; }
+    // The room the players are in, for callers that read cells in place rather than
+    // through the grid copy; nullptr before a successful reset
+    const Room *getCurrentRoom() const;
+    size_t getRoomCount() const;
+    bool isOver() const { return observation.state != GameState::inGame; }
+    ErrorCode getError() const;
+
+    // Filling the grid costs a pass over the room every step; bots that only need the
+    // players can switch it off
+    void setGridObservation(bool on);
+    void setRiddleAnswerer(RiddleAnswerer riddleAnswerer) { answerer = std::move(riddleAnswerer); }
+    static int answerCorrectly(const RiddleData &riddle, int playerId);
+
+    // Keyframes of the whole simulation, to branch or rewind
+    std::string saveState();
+    bool loadState(const std::string &state);
+};
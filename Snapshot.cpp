@@ -0,0 +1,172 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Snapshot.h"
+
+//////////////////////////////////////////        StateWriter         //////////////////////////////////////////
+
+void StateWriter::writeUInt(unsigned long value)
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<char>(value));
+}
+
+void StateWriter::writeInt(long value)
+{
+    writeUInt((static_cast<unsigned long>(value) << 1) ^ static_cast<unsigned long>(value >> (sizeof(long) * 8 - 1)));
+}
+
+void StateWriter::writePoint(const Point &p)
+{
+    writeInt(p.getX());
+    writeInt(p.getY());
+    writeInt(p.getDiffX());
+    writeInt(p.getDiffY());
+    writeChar(p.getSprite());
+}
+
+//////////////////////////////////////////        StateReader         //////////////////////////////////////////
+
+unsigned long StateReader::readUInt()
+{
+    unsigned long value = 0;
+    for (size_t shift = 0; !failed && shift < sizeof(unsigned long) * 8; shift += 7)
+    {
+        if (pos >= bytes.size()) break;
+
+        unsigned char b = static_cast<unsigned char>(bytes[pos++]);
+        value |= static_cast<unsigned long>(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) return value;
+    }
+
+    failed = true;
+    return 0;
+}
+
+long StateReader::readInt()
+{
+    unsigned long raw = readUInt();
+    return static_cast<long>(raw >> 1) ^ -static_cast<long>(raw & 1);
+}
+
+char StateReader::readChar()
+{
+    if (failed || pos >= bytes.size())
+    {
+        failed = true;
+        return 0;
+    }
+    return bytes[pos++];
+}
+
+Point StateReader::readPoint()
+{
+    int x = static_cast<int>(readInt());
+    int y = static_cast<int>(readInt());
+    int dx = static_cast<int>(readInt());
+    int dy = static_cast<int>(readInt());
+    char sprite = readChar();
+    return Point(x, y, dx, dy, sprite);
+}
+
+size_t StateReader::readCount()
+{
+    unsigned long count = readUInt();
+    if (count > bytes.size() - pos)
+    {
+        failed = true;
+        return 0;
+    }
+    return static_cast<size_t>(count);
+}
+
+//////////////////////////////////////////        StateDigest         //////////////////////////////////////////
+
+std::uint64_t hashState(const std::string &bytes)
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (char c : bytes)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// splitmix64 finalizer: spreads a part's hash and its slot over all 64 bits
+static std::uint64_t mixHash(std::uint64_t value)
+{
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+std::uint64_t combineStateHashes(const std::vector<std::uint64_t> &parts)
+{
+    std::uint64_t combined = 0;
+    for (size_t i = 0; i < parts.size(); i++)
+        combined ^= mixHash(parts[i] ^ mixHash(i));
+    return combined;
+}
+
+//////////////////////////////////////////        Hex helpers         //////////////////////////////////////////
+
+std::string toHex(const std::string &bytes)
+{
+    static const char digits[] = "0123456789abcdef";
+
+    std::string hex;
+    hex.reserve(bytes.size() * 2);
+    for (char c : bytes)
+    {
+        unsigned char b = static_cast<unsigned char>(c);
+        hex.push_back(digits[b >> 4]);
+        hex.push_back(digits[b & 0x0F]);
+    }
+    return hex;
+}
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool fromHex(const std::string &hex, std::string &bytes)
+{
+    if (hex.size() % 2 != 0) return false;
+
+    bytes.clear();
+    bytes.reserve(hex.size() / 2);
+    for (size_t i = 0; i < hex.size(); i += 2)
+    {
+        int high = hexValue(hex[i]);
+        int low = hexValue(hex[i + 1]);
+        if (high < 0 || low < 0) return false;
+        bytes.push_back(static_cast<char>((high << 4) | low));
+    }
+    return true;
+}
+
+std::string toHex64(std::uint64_t value)
+{
+    std::string bytes(8, '\0');
+    for (int i = 7; i >= 0; i--, value >>= 8) bytes[i] = static_cast<char>(value & 0xFF);
+    return toHex(bytes);
+}
+
+bool fromHex64(const std::string &hex, std::uint64_t &value)
+{
+    std::string bytes;
+    if (hex.size() != 16 || !fromHex(hex, bytes)) return false;
+
+    value = 0;
+    for (char c : bytes) value = (value << 8) | static_cast<unsigned char>(c);
+    return true;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Point.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////        StateWriter         //////////////////////////////////////////
+
+// Append-only byte buffer used to serialize game state (keyframes).
+// Integers are zigzag varints, so coordinates, counters and flags take a byte each.
+class StateWriter
+{
+    std::string bytes;
+
+public:
+    void writeInt(long value);
+    void writeUInt(unsigned long value);
+    void writeBool(bool value) { writeUInt(value ? 1 : 0); }
+    void writeChar(char c) { bytes.push_back(c); }
+    void writePoint(const Point &p);
+    void writeBytes(const std::string &raw) { bytes += raw; } // another writer's output
+
+    template <typename Enum>
+    void writeEnum(Enum value) { writeInt(static_cast<long>(value)); }
+
+    const std::string &data() const { return bytes; }
+};
+
+//////////////////////////////////////////        StateReader         //////////////////////////////////////////
+
+// Bounds-checked cursor over a StateWriter buffer. The first short read marks the
+// reader as failed and every later read returns zero, so callers check ok() once.
+class StateReader
+{
+    const std::string &bytes;
+    size_t pos;
+    bool failed;
+
+public:
+    explicit StateReader(const std::string &data) : bytes(data), pos(0), failed(false) {}
+
+    long readInt();
+    unsigned long readUInt();
+    bool readBool() { return readUInt() != 0; }
+    char readChar();
+    Point readPoint();
+
+    // Element count for a following list; fails instead of returning counts the
+    // remaining bytes could not possibly hold
+    size_t readCount();
+
+    template <typename Enum>
+    Enum readEnum() { return static_cast<Enum>(readInt()); }
+
+    bool ok() const { return !failed; }
+    bool atEnd() const { return pos >= bytes.size(); }
+    void fail() { failed = true; }
+};
+
+//////////////////////////////////////////        StateDigest         //////////////////////////////////////////
+
+// FNV-1a over a serialized state buffer
+std::uint64_t hashState(const std::string &bytes);
+
+// XOR of every part mixed with its own Zobrist key: a change in any one part
+// changes the result, and equal digests need no part-by-part compare
+std::uint64_t combineStateHashes(const std::vector<std::uint64_t> &parts);
+
+// Per-subsystem hashes of the game state (players, each room's objects...), so a
+// mismatch can name the subsystem that differs. Names are not serialized.
+struct StateDigest
+{
+    std::vector<std::string> names;
+    std::vector<std::uint64_t> parts;
+
+    void add(const std::string &name, const StateWriter &state) { add(name, state.data()); }
+
+    void add(const std::string &name, const std::string &bytes)
+    {
+        names.push_back(name);
+        parts.push_back(hashState(bytes));
+    }
+
+    void add(const StateDigest &other)
+    {
+        names.insert(names.end(), other.names.begin(), other.names.end());
+        parts.insert(parts.end(), other.parts.begin(), other.parts.end());
+    }
+
+    std::uint64_t combined() const { return combineStateHashes(parts); }
+};
+
+//////////////////////////////////////////        Hex helpers         //////////////////////////////////////////
+
+// Keyframes travel inside text recordings as a single hex token
+std::string toHex(const std::string &bytes);
+bool fromHex(const std::string &hex, std::string &bytes);
+
+// State hashes are written as 16 fixed hex digits
+std::string toHex64(std::uint64_t value);
+bool fromHex64(const std::string &hex, std::uint64_t &value);
@@ -4,6 +4,7 @@
 #include "SpringLink.h"
 #include "Room.h"
 #include "Player.h"
+#include "Snapshot.h"
 
 //////////////////////////////////////////      Constructor          //////////////////////////////////////////
 
@@ -67,78 +68,11 @@ void Spring::compressLink(int linkIndex, Room *room)
 
 bool Spring::isFullyCompressed() const { return compressedCount >= static_cast<int>(links.size()); }
 
-//////////////////////////////////////////   calculateLaunch        //////////////////////////////////////////
-
-Spring::LaunchData Spring::calculateLaunch() const
-{
-    LaunchData launch;
-    launch.shouldLaunch = (compressedCount > 0);
-    launch.frames = compressedCount * compressedCount;
-
-    switch (compressionDir)
-    {
-    case Direction::UP:
-        launch.velocityX = 0;
-        launch.velocityY = compressedCount;
-        launch.direction = Direction::DOWN;
-        break;
-    case Direction::DOWN:
-        launch.velocityX = 0;
-        launch.velocityY = -compressedCount;
-        launch.direction = Direction::UP;
-        break;
-    case Direction::LEFT:
-        launch.velocityX = compressedCount;
-        launch.velocityY = 0;
-        launch.direction = Direction::RIGHT;
-        break;
-    case Direction::RIGHT:
-        launch.velocityX = -compressedCount;
-        launch.velocityY = 0;
-        launch.direction = Direction::LEFT;
-        break;
-    default:
-        launch.shouldLaunch = false;
-        launch.velocityX = 0;
-        launch.velocityY = 0;
-        launch.direction = Direction::STAY;
-        break;
-    }
-
-    return launch;
-}
-
 //////////////////////////////////////////  calculateLaunchMomentum //////////////////////////////////////////
 
 Momentum Spring::calculateLaunchMomentum() const
 {
-    Momentum momentum;
-    momentum.setActive(true);
-    momentum.setLaunchFramesRemaining(compressedCount * compressedCount);
-
-    switch (compressionDir)
-    {
-    case Direction::UP:
-        momentum.setDY(compressedCount);
-        momentum.setLaunchDir(Direction::DOWN);
-        break;
-    case Direction::DOWN:
-        momentum.setDY(-compressedCount);
-        momentum.setLaunchDir(Direction::UP);
-        break;
-    case Direction::LEFT:
-        momentum.setDX(compressedCount);
-        momentum.setLaunchDir(Direction::RIGHT);
-        break;
-    case Direction::RIGHT:
-        momentum.setDX(-compressedCount);
-        momentum.setLaunchDir(Direction::LEFT);
-        break;
-    default:
-        break;
-    }
-
-    return momentum;
+    return Physics::launch(compressionDir, compressedCount);
 }
 
 //////////////////////////////////////////  resetCompression        //////////////////////////////////////////
@@ -217,3 +151,41 @@ bool Spring::allLinksInactive() const
         if (link && link->isActive()) return false;
     return true;
 }
+
+//////////////////////////////////////////    saveState / loadState   //////////////////////////////////////////
+
+void Spring::saveState(StateWriter &out, const ObjectIndex &indexOf) const
+{
+    out.writeUInt(links.size());
+    for (SpringLink *link : links)
+    {
+        auto it = indexOf.find(link);
+        out.writeInt(it != indexOf.end() ? it->second : -1);
+    }
+
+    out.writePoint(anchorPosition);
+    out.writeEnum(compressionDir);
+    out.writeInt(compressedCount);
+}
+
+bool Spring::loadState(StateReader &in, const std::vector<GameObject *> &objects)
+{
+    links.clear();
+    size_t count = in.readCount();
+    for (size_t i = 0; i < count && in.ok(); i++)
+    {
+        long index = in.readInt();
+        if (index < 0 || index >= static_cast<long>(objects.size())) return false;
+
+        SpringLink *link = dynamic_cast<SpringLink *>(objects[index]);
+        if (link == nullptr) return false;
+
+        link->setParentSpring(this);
+        links.push_back(link);
+    }
+
+    anchorPosition = in.readPoint();
+    compressionDir = in.readEnum<Direction>();
+    compressedCount = static_cast<int>(in.readInt());
+    return in.ok();
+}
@@ -5,11 +5,14 @@
 #include "Point.h"
 #include "Constants.h"
 #include "Momentum.h"
+#include "GameObject.h"
 #include <vector>
 
 class SpringLink;
 class Room;
 class Player;
+class StateWriter;
+class StateReader;
 
 //////////////////////////////////////////          Spring            //////////////////////////////////////////
 
@@ -37,15 +40,6 @@ class Spring
     SpringLink *getPrevLink(const SpringLink *current) const;
 
 public:
-    struct LaunchData
-    {
-        bool shouldLaunch;
-        int velocityX;
-        int velocityY;
-        int frames;
-        Direction direction;
-    };
-
     struct InteractionResult
     {
         bool compressed;
@@ -72,6 +66,7 @@ public:
     void destroyAllLinks();
     bool allLinksInactive() const;
 
-private:
-    LaunchData calculateLaunch() const;
+    // Links are stored as indices into the room's objects (see Room::saveState)
+    void saveState(StateWriter &out, const ObjectIndex &indexOf) const;
+    bool loadState(StateReader &in, const std::vector<GameObject *> &objects);
 };
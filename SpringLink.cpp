@@ -4,6 +4,7 @@
 #include "Spring.h"
 #include "Room.h"
 #include "Renderer.h"
+#include "Snapshot.h"
 
 //////////////////////////////////////////       Constructor       /////////////////////////////////////////////
 
@@ -33,7 +34,7 @@ void SpringLink::collapse(Room *room) {
     if (room != nullptr)
     {
         room->setCharAt(getX(), getY(), sprite);
-        Renderer::printAt(getX(), getY(), sprite);
+        Renderer::printCell(getX(), getY(), sprite);
         Renderer::flush();
     }
 }
@@ -50,7 +51,23 @@ void SpringLink::reset(Room *room)
     if (room != nullptr)
     {
         room->setCharAt(getX(), getY(), sprite);
-        Renderer::printAt(getX(), getY(), sprite);
+        Renderer::printCell(getX(), getY(), sprite);
         Renderer::flush();
     }
 }
+
+//////////////////////////////////////////    saveState / loadState    /////////////////////////////////////////////
+
+void SpringLink::saveState(StateWriter &out) const
+{
+    GameObject::saveState(out);
+    out.writeInt(linkIndex);
+    out.writeBool(collapsed);
+}
+
+void SpringLink::loadState(StateReader &in)
+{
+    GameObject::loadState(in);
+    linkIndex = static_cast<int>(in.readInt());
+    collapsed = in.readBool();
+}
@@ -19,6 +19,7 @@ class SpringLink : public StaticObject
 
 public:
     SpringLink(const Point &pos, Spring *parent, int index);
+    SpringLink() : SpringLink(Point(-1, -1), nullptr, 0) {}
 
     GameObject *clone() const override;
     const char *getName() const override { return "SpringLink"; }
@@ -32,4 +33,7 @@ public:
     void collapse(Room *room);
     void reset(Room *room);
     bool isStartLink() const { return linkIndex == 0; }
+
+    void saveState(StateWriter &out) const override;
+    void loadState(StateReader &in) override;
 };
@@ -84,6 +84,9 @@ public:
 
     bool isRemovedBySwitch() const { return removedBySwitch; }
     void setRemovedBySwitch(bool removable) { removedBySwitch = removable; }
+
+    void saveState(StateWriter &out) const override;
+    void loadState(StateReader &in) override;
 };
 
 class Air : public StaticObject
@@ -2,6 +2,7 @@
 
 #include "Switch.h"
 #include "Room.h"
+#include "Snapshot.h"
 
 //////////////////////////////////////////         toggle         //////////////////////////////////////////
 
@@ -40,4 +41,18 @@ bool Switch::onInteract(Player *player, Room *room)
     room->updatePuzzleState();
 
     return true;
-}
\ No newline at end of file
+}
+
+//////////////////////////////////////////    saveState / loadState    //////////////////////////////////////////
+
+void Switch::saveState(StateWriter &out) const
+{
+    InteractableObject::saveState(out);
+    out.writeBool(isOn);
+}
+
+void Switch::loadState(StateReader &in)
+{
+    InteractableObject::loadState(in);
+    isOn = in.readBool();
+}
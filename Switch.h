@@ -34,4 +34,7 @@ public:
     bool getIsOn() const { return isOn; }
     void setIsOn(bool on);
     bool onInteract(Player *player, Room *room) override;
+
+    void saveState(StateWriter &out) const override;
+    void loadState(StateReader &in) override;
 };
@@ -0,0 +1,130 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "ThreadPool.h"
+
+//////////////////////////////////////////        Constructor         //////////////////////////////////////////
+
+WorkStealingPool::WorkStealingPool(size_t threads)
+    : workerCount(threads), queues(), workers(), runMutex(), wake(), done(), current(nullptr),
+      generation(0), busy(0), stopping(false)
+{
+    if (workerCount == 0) workerCount = std::thread::hardware_concurrency();
+    if (workerCount == 0) workerCount = 1;
+
+    queues = std::vector<WorkQueue>(workerCount);
+
+    workers.reserve(workerCount - 1);
+    for (size_t w = 1; w < workerCount; w++)
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, w);
+}
+
+//////////////////////////////////////////         Destructor         //////////////////////////////////////////
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(runMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (std::thread &t : workers) t.join();
+}
+
+//////////////////////////////////////////          popLocal          //////////////////////////////////////////
+
+bool WorkStealingPool::popLocal(size_t worker, size_t &task)
+{
+    WorkQueue &queue = queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (queue.tasks.empty()) return false;
+
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+    return true;
+}
+
+//////////////////////////////////////////           steal            //////////////////////////////////////////
+
+bool WorkStealingPool::steal(size_t thief, size_t &task)
+{
+    for (size_t offset = 1; offset < workerCount; offset++)
+    {
+        WorkQueue &victim = queues[(thief + offset) % workerCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+
+        if (victim.tasks.empty()) continue;
+
+        task = victim.tasks.front();
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+//////////////////////////////////////////            work            //////////////////////////////////////////
+
+// No task is ever added while running, so once every deque is empty the worker is done
+void WorkStealingPool::work(size_t worker, const std::function<void(size_t)> &task)
+{
+    size_t index = 0;
+    while (popLocal(worker, index) || steal(worker, index))
+        task(index);
+}
+
+//////////////////////////////////////////         workerLoop         //////////////////////////////////////////
+
+void WorkStealingPool::workerLoop(size_t worker)
+{
+    unsigned long seen = 0;
+
+    while (true)
+    {
+        const std::function<void(size_t)> *task = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(runMutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            task = current;
+        }
+
+        work(worker, *task);
+
+        std::lock_guard<std::mutex> lock(runMutex);
+        if (--busy == 0) done.notify_one();
+    }
+}
+
+//////////////////////////////////////////            run             //////////////////////////////////////////
+
+void WorkStealingPool::run(size_t taskCount, const std::function<void(size_t)> &task)
+{
+    if (taskCount == 0) return;
+
+    // The workers are all asleep, so the deques are ours until they are woken
+    for (size_t i = 0; i < taskCount; i++)
+        queues[i % workerCount].tasks.push_back(i);
+
+    if (workers.empty())
+    {
+        work(0, task);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(runMutex);
+        current = &task;
+        busy = workers.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    // The calling thread is worker 0
+    work(0, task);
+
+    std::unique_lock<std::mutex> lock(runMutex);
+    done.wait(lock, [&] { return busy == 0; });
+    current = nullptr;
+}
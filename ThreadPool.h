@@ -0,0 +1,59 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//////////////////////////////////////////     WorkStealingPool       //////////////////////////////////////////
+
+// Runs a batch of independent tasks (identified by index) on a fixed set of workers.
+// Tasks are dealt round-robin into per-worker deques: a worker takes from the back
+// of its own deque and, once empty, steals from the front of the others, so a few
+// long tasks do not leave the remaining workers idle. The workers are started once
+// and sleep between runs, so a pool called every tick (-solve, -host) spawns nothing.
+class WorkStealingPool
+{
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    size_t workerCount;
+    std::vector<WorkQueue> queues;
+
+    // Workers 1..workerCount-1; the thread calling run() is worker 0
+    std::vector<std::thread> workers;
+    std::mutex runMutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(size_t)> *current;
+    unsigned long generation; // bumped by every run
+    size_t busy;              // workers still on the current run
+    bool stopping;
+
+    bool popLocal(size_t worker, size_t &task);
+    bool steal(size_t thief, size_t &task);
+    void work(size_t worker, const std::function<void(size_t)> &task);
+    void workerLoop(size_t worker);
+
+public:
+    // threads == 0 picks the hardware concurrency
+    explicit WorkStealingPool(size_t threads = 0);
+    ~WorkStealingPool();
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    size_t getWorkerCount() const { return workerCount; }
+
+    // Calls task(i) for every i in [0, taskCount) and returns once all are done.
+    // task must be safe to call concurrently for different indices. Runs do not overlap:
+    // one thread at a time calls run().
+    void run(size_t taskCount, const std::function<void(size_t)> &task);
+};
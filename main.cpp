@@ -6,12 +6,13 @@
 
 int main(int argc, char* argv[])
 {
-    Game* game = Game::createFromArgs(argc, argv);
+    int exitStatus = 0;
+    Game* game = Game::createFromArgs(argc, argv, exitStatus);
 
     if (game) {
         game->run();
         delete game;
     }
 
-    return 0;
+    return exitStatus;
 }
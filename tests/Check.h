@@ -0,0 +1,43 @@
+#pragma once
+
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+
+//////////////////////////////////////////           Check            //////////////////////////////////////////
+
+// What the tests/*Check programs run by `make check` share. A failed CHECK prints where and
+// carries on; main returns Check::result(), nonzero once anything failed.
+namespace Check
+{
+    inline int &failures()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    inline void fail(const char *expression, const char *file, int line)
+    {
+        std::cout << file << ":" << line << ": CHECK(" << expression << ") failed" << std::endl;
+        failures()++;
+    }
+
+    inline int result(const char *program)
+    {
+        if (failures() == 0) std::cout << program << ": ok" << std::endl;
+        else std::cout << program << ": " << failures() << " failed" << std::endl;
+        return failures() == 0 ? 0 : 1;
+    }
+
+    // A path in the temp directory no other check run uses; the caller removes it
+    inline std::string tempPath(const std::string &name)
+    {
+        std::string unique = std::to_string(std::random_device{}());
+        return (std::filesystem::temp_directory_path() / (unique + "-" + name)).string();
+    }
+}
+
+#define CHECK(expression) ((expression) ? (void)0 : Check::fail(#expression, __FILE__, __LINE__))
@@ -0,0 +1,139 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Check.h"
+#include "DistanceField.h"
+#include <random>
+#include <vector>
+
+//////////////////////////////////////////          helpers           //////////////////////////////////////////
+
+namespace
+{
+    const int WIDTH = 40;
+    const int HEIGHT = 15;
+
+    struct Grid
+    {
+        std::vector<bool> open = std::vector<bool>(WIDTH * HEIGHT, false);
+        std::vector<bool> source = std::vector<bool>(WIDTH * HEIGHT, false);
+
+        bool walkable(int x, int y) const
+        {
+            return x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT && open[y * WIDTH + x];
+        }
+    };
+
+    bool sameField(const DistanceField &a, const DistanceField &b)
+    {
+        for (int y = 0; y < HEIGHT; y++)
+            for (int x = 0; x < WIDTH; x++)
+                if (a.at(x, y) != b.at(x, y)) return false;
+        return true;
+    }
+
+    // Every reachable non-source cell has a step to a neighbour exactly one closer
+    bool stepsDescend(const DistanceField &field)
+    {
+        for (int y = 0; y < HEIGHT; y++)
+            for (int x = 0; x < WIDTH; x++)
+            {
+                int here = field.at(x, y);
+                if (here == DistanceField::UNREACHABLE || here == 0) continue;
+
+                int nx = x, ny = y;
+                switch (field.stepFrom(x, y))
+                {
+                case Direction::UP: ny--; break;
+                case Direction::DOWN: ny++; break;
+                case Direction::LEFT: nx--; break;
+                case Direction::RIGHT: nx++; break;
+                default: return false;
+                }
+                if (field.at(nx, ny) != here - 1) return false;
+            }
+        return true;
+    }
+}
+
+//////////////////////////////////////////     incremental updates    //////////////////////////////////////////
+
+// Random walls opened and closed one at a time: after each patch the field equals a
+// full recompute over the same grid
+static void checkIncrementalMatchesRecompute(unsigned int seed)
+{
+    std::mt19937 random(seed);
+    Grid grid;
+    std::vector<Point> sources;
+
+    for (int i = 0; i < WIDTH * HEIGHT; i++) grid.open[i] = random() % 100 < 65;
+    for (int i = 0; i < 3; i++)
+    {
+        int x = static_cast<int>(random() % WIDTH), y = static_cast<int>(random() % HEIGHT);
+        sources.push_back(Point(x, y));
+        grid.source[y * WIDTH + x] = true;
+    }
+
+    DistanceField::Passable passable = [&grid](int x, int y) { return grid.walkable(x, y); };
+    DistanceField patched;
+    patched.compute(WIDTH, HEIGHT, sources, passable);
+    CHECK(stepsDescend(patched));
+
+    for (int step = 0; step < 400; step++)
+    {
+        int x = static_cast<int>(random() % WIDTH), y = static_cast<int>(random() % HEIGHT);
+        size_t cell = static_cast<size_t>(y) * WIDTH + x;
+        if (grid.source[cell]) continue;
+
+        grid.open[cell] = !grid.open[cell];
+        if (grid.open[cell]) patched.openCell(x, y, passable);
+        else patched.closeCell(x, y, passable);
+
+        DistanceField fresh;
+        fresh.compute(WIDTH, HEIGHT, sources, passable);
+        if (!sameField(patched, fresh))
+        {
+            CHECK(sameField(patched, fresh));
+            return;
+        }
+    }
+    CHECK(stepsDescend(patched));
+}
+
+//////////////////////////////////////////       edge behaviour       //////////////////////////////////////////
+
+static void checkEdges()
+{
+    Grid grid;
+    DistanceField::Passable passable = [&grid](int x, int y) { return grid.walkable(x, y); };
+
+    DistanceField field;
+    CHECK(!field.isValid());
+    CHECK(field.at(0, 0) == DistanceField::UNREACHABLE);
+
+    // A source on a wall still counts; with nothing walkable around it nothing else is reached
+    field.compute(WIDTH, HEIGHT, {Point(5, 5)}, passable);
+    CHECK(field.isValid());
+    CHECK(field.at(5, 5) == 0);
+    CHECK(field.at(6, 5) == DistanceField::UNREACHABLE);
+    CHECK(field.stepFrom(5, 5) == Direction::STAY);
+
+    grid.open[5 * WIDTH + 6] = true;
+    field.openCell(6, 5, passable);
+    CHECK(field.at(6, 5) == 1);
+    CHECK(field.stepFrom(6, 5) == Direction::LEFT);
+
+    CHECK(field.at(-1, 0) == DistanceField::UNREACHABLE);
+    CHECK(field.at(WIDTH, 0) == DistanceField::UNREACHABLE);
+
+    field.invalidate();
+    CHECK(field.at(5, 5) == DistanceField::UNREACHABLE);
+}
+
+//////////////////////////////////////////            main            //////////////////////////////////////////
+
+int main()
+{
+    for (unsigned int seed = 1; seed <= 20; seed++) checkIncrementalMatchesRecompute(seed);
+    checkEdges();
+    return Check::result("DistanceFieldCheck");
+}
@@ -0,0 +1,148 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Check.h"
+#include "HeadlessGame.h"
+#include <cstdint>
+#include <vector>
+
+//////////////////////////////////////////         CheckGame          //////////////////////////////////////////
+
+namespace
+{
+    const char *const LEVELS = "tests/recordings/autoplay-11";
+    const unsigned long SAMPLE_EVERY = 50;
+
+    // Replays a bundled recording the way FuzzGame plays a stream, sampling the combined
+    // digest as it goes
+    class CheckGame : public HeadlessGame
+    {
+        const RecordedSteps &steps;
+
+    protected:
+        int getRiddleInput(unsigned long cycle) override
+        {
+            for (const ActionRecord &action : steps.getActionsForCycle(cycle))
+                if (action.action == Action::ANSWER_RIDDLE) return action.answer;
+            return -1;
+        }
+
+    public:
+        CheckGame(const RecordedSteps &input, size_t resident, bool prefetch)
+            : HeadlessGame(LEVELS, false), steps(input)
+        {
+            residentLimit = resident;
+            prefetchEnabled = prefetch;
+        }
+
+        void handleInput() override
+        {
+            for (const ActionRecord &action : steps.getActionsForCycle(cycleCount))
+            {
+                if (action.action == Action::ANSWER_RIDDLE) continue;
+                Player &player = (action.playerId == 1) ? player1 : player2;
+                player.performAction(action.action, getCurrentRoom());
+            }
+        }
+
+        // Plays up to cycle `until`, sampling a digest every SAMPLE_EVERY cycles
+        std::vector<std::uint64_t> play(unsigned long until)
+        {
+            GameContext::Scope bind(context);
+            std::vector<std::uint64_t> digests;
+
+            while (currentState == GameState::inGame && cycleCount < until)
+            {
+                if (cycleCount % SAMPLE_EVERY == 0) digests.push_back(digestState().combined());
+                handleInput();
+                update();
+                if (currentState == GameState::paused) currentState = GameState::inGame;
+            }
+            digests.push_back(digestState().combined());
+            return digests;
+        }
+
+        std::string save()
+        {
+            GameContext::Scope bind(context);
+            return captureKeyframe();
+        }
+
+        bool load(const std::string &state)
+        {
+            GameContext::Scope bind(context);
+            return restoreKeyframe(state);
+        }
+
+        int room() const { return currentRoomId; }
+    };
+
+    bool loadSteps(RecordedSteps &steps)
+    {
+        return steps.loadFromFile(std::string(LEVELS) + "/adv-world.steps.txt") == ErrorCode::NONE;
+    }
+}
+
+//////////////////////////////////////////      digest stability      //////////////////////////////////////////
+
+// Two games on the same seed and input agree at every sample, and the run leaves room 0
+static void checkDigestStability(const RecordedSteps &steps, unsigned long cycles)
+{
+    CheckGame first(steps, 0, false), second(steps, 0, false);
+    CHECK(first.begin(steps.getRandomSeed()) && second.begin(steps.getRandomSeed()));
+
+    std::vector<std::uint64_t> a = first.play(cycles);
+    CHECK(a == second.play(cycles));
+    CHECK(a.size() > 1 && a.front() != a.back());
+    CHECK(first.room() > 0);
+}
+
+//////////////////////////////////////////       room residency       //////////////////////////////////////////
+
+// Evicting every room but the current one, and restoring it on re-entry, changes nothing
+// a digest can see; neither does building neighbours ahead on the prefetch task
+static void checkResidency(const RecordedSteps &steps, unsigned long cycles)
+{
+    CheckGame unlimited(steps, 0, false), evicting(steps, 1, false), prefetching(steps, 1, true);
+    CHECK(unlimited.begin(steps.getRandomSeed()));
+    CHECK(evicting.begin(steps.getRandomSeed()));
+    CHECK(prefetching.begin(steps.getRandomSeed()));
+
+    std::vector<std::uint64_t> expected = unlimited.play(cycles);
+    CHECK(evicting.play(cycles) == expected);
+    CHECK(prefetching.play(cycles) == expected);
+}
+
+//////////////////////////////////////////         keyframes          //////////////////////////////////////////
+
+// A game restored from a keyframe taken mid-run, in a room past the first, plays on to
+// the same state as the game it was taken from
+static void checkKeyframeRestore(const RecordedSteps &steps, unsigned long cycles)
+{
+    CheckGame original(steps, 0, false);
+    CHECK(original.begin(steps.getRandomSeed()));
+    original.play(cycles / 2);
+    CHECK(original.room() > 0);
+    std::string keyframe = original.save();
+
+    CheckGame restored(steps, 1, false);
+    CHECK(restored.begin(steps.getRandomSeed()));
+    CHECK(restored.load(keyframe));
+    CHECK(restored.save() == keyframe);
+
+    CHECK(restored.play(cycles) == original.play(cycles));
+}
+
+//////////////////////////////////////////            main            //////////////////////////////////////////
+
+int main()
+{
+    RecordedSteps steps;
+    CHECK(loadSteps(steps));
+    if (steps.getActionCount() == 0) return Check::result("GameCheck");
+
+    unsigned long cycles = steps.getActionAt(steps.getActionCount() - 1).cycle + 1;
+    checkDigestStability(steps, cycles);
+    checkResidency(steps, cycles);
+    checkKeyframeRestore(steps, cycles);
+    return Check::result("GameCheck");
+}
@@ -0,0 +1,141 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Check.h"
+#include "LevelLoader.h"
+#include "LevelPack.h"
+#include "Simulation.h"
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+//////////////////////////////////////////          helpers           //////////////////////////////////////////
+
+namespace
+{
+    const char *const LEVELS = "tests/recordings/autoplay-11";
+
+    bool samePoint(const Point &a, const Point &b) { return a.getX() == b.getX() && a.getY() == b.getY(); }
+
+    bool sameMetadata(const RoomMetadata &a, const RoomMetadata &b)
+    {
+        if (a.darkZones.size() != b.darkZones.size()) return false;
+        for (size_t i = 0; i < a.darkZones.size(); i++)
+            if (a.darkZones[i].x1 != b.darkZones[i].x1 || a.darkZones[i].y1 != b.darkZones[i].y1 ||
+                a.darkZones[i].x2 != b.darkZones[i].x2 || a.darkZones[i].y2 != b.darkZones[i].y2)
+                return false;
+
+        return samePoint(a.spawnPoint, b.spawnPoint) && samePoint(a.spawnPointFromNext, b.spawnPointFromNext) &&
+               a.nextRoomId == b.nextRoomId && a.prevRoomId == b.prevRoomId && a.doorConfigs == b.doorConfigs;
+    }
+
+    bool sameScreen(const Screen &a, const Screen &b)
+    {
+        if (a.getWidth() != b.getWidth() || a.getHeight() != b.getHeight()) return false;
+        for (int y = 0; y < a.getHeight(); y++)
+            for (int x = 0; x < a.getWidth(); x++)
+                if (a.getCharAt(x, y) != b.getCharAt(x, y)) return false;
+        return true;
+    }
+
+    // Steps a simulation through the bundled recording's moves and returns where it ended
+    std::string playRecording(const std::string &dir)
+    {
+        RecordedSteps steps;
+        if (steps.loadFromFile(std::string(LEVELS) + "/adv-world.steps.txt") != ErrorCode::NONE) return "";
+
+        Simulation simulation;
+        simulation.setRiddleAnswerer(Simulation::answerCorrectly);
+        if (!simulation.reset(steps.getRandomSeed(), dir)) return "";
+
+        unsigned long last = steps.getActionCount() == 0 ? 0 : steps.getActionAt(steps.getActionCount() - 1).cycle;
+        for (unsigned long cycle = 0; cycle <= last && !simulation.isOver(); cycle++)
+        {
+            std::optional<Action> moves[2];
+            for (const ActionRecord &action : steps.getActionsForCycle(cycle))
+                if (action.action != Action::ANSWER_RIDDLE) moves[action.playerId == 1 ? 0 : 1] = action.action;
+            simulation.step(moves[0], moves[1]);
+        }
+        return simulation.saveState();
+    }
+}
+
+//////////////////////////////////////////         round trip         //////////////////////////////////////////
+
+// Every room of a compiled pack reads back as the loader reads its text file, and a game
+// played on the pack ends exactly where the same game on the text files does
+static void checkRoundTrip(const fs::path &dir)
+{
+    std::ostringstream report;
+    std::string packPath = LevelLoader::pathIn(dir.string(), LevelPack::FILE_NAME);
+    CHECK(LevelPack::compile(dir.string(), packPath, report) == ErrorCode::NONE);
+
+    std::shared_ptr<const LevelPack> pack = LevelPack::openCurrent(dir.string());
+    CHECK(pack != nullptr);
+    if (pack == nullptr) return;
+
+    std::vector<std::string> names = LevelLoader::discoverTextLevelFiles(dir.string());
+    CHECK(pack->getRoomNames() == names);
+    CHECK(pack->getRoomCount() == names.size());
+
+    for (size_t i = 0; i < names.size() && i < pack->getRoomCount(); i++)
+    {
+        std::string textPath = LevelLoader::pathIn(dir.string(), names[i]);
+        RoomMetadata textMetadata;
+        std::unique_ptr<Screen> text(LevelLoader::loadScreenFile(textPath, textMetadata));
+        std::unique_ptr<Screen> packed(pack->buildScreen(i));
+
+        CHECK(text != nullptr && packed != nullptr && sameScreen(*text, *packed));
+        CHECK(sameMetadata(textMetadata, pack->getMetadata(i)));
+        CHECK(pack->getContentHash(i) == LevelPack::hashFile(textPath));
+    }
+
+    std::string fromPack = playRecording(dir.string());
+    fs::remove(packPath);
+    std::string fromText = playRecording(dir.string());
+    CHECK(!fromText.empty() && fromPack == fromText);
+}
+
+//////////////////////////////////////////        stale packs         //////////////////////////////////////////
+
+// A level file edited after compiling makes the pack stale; one only touched does not.
+// A pack cut short does not open at all.
+static void checkStalePacks(const fs::path &dir)
+{
+    std::ostringstream report;
+    std::string packPath = LevelLoader::pathIn(dir.string(), LevelPack::FILE_NAME);
+    CHECK(LevelPack::compile(dir.string(), packPath, report) == ErrorCode::NONE);
+
+    std::string firstLevel = LevelLoader::pathIn(dir.string(), LevelLoader::discoverTextLevelFiles(dir.string())[0]);
+    fs::file_time_type later = fs::last_write_time(packPath) + std::chrono::hours(1);
+
+    fs::last_write_time(firstLevel, later);
+    CHECK(LevelPack::openCurrent(dir.string()) != nullptr);
+
+    std::ofstream(firstLevel, std::ios::app) << "\n";
+    fs::last_write_time(firstLevel, later);
+    CHECK(LevelPack::openCurrent(dir.string()) == nullptr);
+
+    CHECK(LevelPack::compile(dir.string(), packPath, report) == ErrorCode::NONE);
+    fs::resize_file(packPath, fs::file_size(packPath) / 2);
+    LevelPack cut;
+    CHECK(!cut.open(packPath));
+}
+
+//////////////////////////////////////////            main            //////////////////////////////////////////
+
+int main()
+{
+    fs::path dir = Check::tempPath("levels");
+    fs::create_directories(dir);
+    for (const fs::directory_entry &entry : fs::directory_iterator(LEVELS))
+        if (entry.path().extension() == ".txt") fs::copy_file(entry.path(), dir / entry.path().filename());
+
+    checkRoundTrip(dir);
+    checkStalePacks(dir);
+
+    fs::remove_all(dir);
+    return Check::result("LevelPackCheck");
+}
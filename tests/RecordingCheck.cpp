@@ -0,0 +1,191 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Check.h"
+#include "Recorder.h"
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <random>
+
+//////////////////////////////////////////          helpers           //////////////////////////////////////////
+
+namespace
+{
+    const RecordingFormat FORMATS[] = {RecordingFormat::TEXT, RecordingFormat::BINARY};
+
+    bool sameAction(const ActionRecord &a, const ActionRecord &b)
+    {
+        return a.cycle == b.cycle && a.playerId == b.playerId && a.action == b.action && a.answer == b.answer;
+    }
+
+    bool sameEvent(const GameEvent &a, const GameEvent &b)
+    {
+        return a.cycle == b.cycle && a.type == b.type && a.roomId == b.roomId && a.playerId == b.playerId &&
+               a.question == b.question && a.answerGiven == b.answerGiven && a.wasCorrect == b.wasCorrect &&
+               a.stateHashes == b.stateHashes;
+    }
+
+    // Cycles around the varint byte boundaries, every action of both players, riddle
+    // answers from escaped to large, and keyframes before, between and after the actions
+    // whose states hold the KEYFRAME tag byte, NULs and newlines
+    RecordedSteps makeSteps()
+    {
+        RecordedSteps steps;
+        steps.setRandomSeed(UINT_MAX);
+        steps.setColorMode(true);
+        steps.addScreenName("adv-world01.screen.txt");
+        steps.addScreenName("adv-world02.screen.txt");
+
+        const Action actions[] = {Action::MOVE_UP, Action::MOVE_DOWN, Action::MOVE_LEFT, Action::MOVE_RIGHT,
+                                  Action::STAY, Action::DROP_ITEM, Action::ESC};
+        const unsigned long cycles[] = {0, 0, 1, 127, 128, 16383, 16384, 2097152, 1UL << 31};
+
+        steps.addKeyframe(Keyframe(0, std::string("\x0f\0\n\x80\xff", 5)));
+        for (unsigned long cycle : cycles)
+        {
+            for (int player = 1; player <= 2; player++)
+                for (Action action : actions) steps.addAction(ActionRecord(cycle, PlayerKeyBinding{0, player, action}));
+            steps.addAction(ActionRecord(cycle, 1, -1));
+            steps.addAction(ActionRecord(cycle, 2, 3));
+            steps.addAction(ActionRecord(cycle, 2, INT_MAX));
+        }
+        steps.addKeyframe(Keyframe(16384, std::string(300, '\x0f')));
+        steps.addKeyframe(Keyframe((1UL << 31) + 5, ""));
+        return steps;
+    }
+
+    std::vector<GameEvent> makeEvents()
+    {
+        return {GameEvent(0, 0),
+                GameEvent(127, 1, 2),
+                GameEvent(128, 1, "What has keys but can't open locks?", 3, true),
+                GameEvent(16384, 2, "", 0, false),
+                GameEvent(16384, 2, std::vector<std::uint64_t>{0, 1, UINT64_MAX, 0x0f0f0f0f0f0f0f0fULL}),
+                GameEvent(1UL << 31, 2, GameEventType::QUIT)};
+    }
+}
+
+//////////////////////////////////////////      steps round trip      //////////////////////////////////////////
+
+// Both formats bring back the header, every action and every keyframe as written
+static void checkStepsRoundTrip()
+{
+    RecordedSteps steps = makeSteps();
+
+    for (RecordingFormat format : FORMATS)
+    {
+        std::string path = Check::tempPath("steps");
+        CHECK(steps.saveToFile(path, format) == ErrorCode::NONE);
+
+        RecordedSteps loaded;
+        CHECK(loaded.loadFromFile(path) == ErrorCode::NONE);
+        std::remove(path.c_str());
+
+        CHECK(loaded.getRandomSeed() == steps.getRandomSeed());
+        CHECK(loaded.getColorMode());
+        CHECK(loaded.getScreenNames() == steps.getScreenNames());
+
+        CHECK(loaded.getActionCount() == steps.getActionCount());
+        for (size_t i = 0; i < steps.getActionCount() && i < loaded.getActionCount(); i++)
+            CHECK(sameAction(loaded.getActionAt(i), steps.getActionAt(i)));
+
+        CHECK(loaded.getKeyframeCount() == 3);
+        for (unsigned long cycle : {0UL, 16384UL, (1UL << 31) + 5})
+        {
+            const Keyframe *want = steps.findKeyframe(cycle);
+            const Keyframe *got = loaded.findKeyframe(cycle);
+            CHECK(got != nullptr && want != nullptr && got->cycle == want->cycle && got->state == want->state);
+        }
+    }
+}
+
+//////////////////////////////////////////     results round trip     //////////////////////////////////////////
+
+static void checkResultsRoundTrip()
+{
+    std::vector<GameEvent> events = makeEvents();
+
+    for (RecordingFormat format : FORMATS)
+    {
+        std::string path = Check::tempPath("result");
+        CHECK(saveGameEvents(path, events, format) == ErrorCode::NONE);
+
+        std::vector<GameEvent> loaded;
+        CHECK(loadGameEvents(path, loaded) == ErrorCode::NONE);
+        std::remove(path.c_str());
+
+        CHECK(loaded.size() == events.size());
+        for (size_t i = 0; i < events.size() && i < loaded.size(); i++) CHECK(sameEvent(loaded[i], events[i]));
+    }
+}
+
+//////////////////////////////////////////      truncated files       //////////////////////////////////////////
+
+// A binary file cut anywhere inside its records fails to load instead of loading less
+static void checkTruncatedBinary()
+{
+    std::string path = Check::tempPath("steps");
+    CHECK(makeSteps().saveToFile(path, RecordingFormat::BINARY) == ErrorCode::NONE);
+
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    // The last record is the final keyframe: its delta, the tag and an empty state
+    for (size_t cut : {bytes.size() - 1, bytes.size() - 2})
+    {
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(cut));
+        }
+        RecordedSteps loaded;
+        CHECK(loaded.loadFromFile(path) != ErrorCode::NONE);
+    }
+    std::remove(path.c_str());
+}
+
+//////////////////////////////////////////    out-of-order actions    //////////////////////////////////////////
+
+// Actions added out of cycle order land in the per-cycle index exactly as if they had been
+// added sorted, keeping the order they were added in within a cycle
+static void checkOutOfOrderIndex()
+{
+    std::mt19937 random(28);
+    std::map<unsigned long, std::vector<int>> expected;
+    RecordedSteps steps;
+
+    for (int i = 0; i < 2000; i++)
+    {
+        unsigned long cycle = random() % 300;
+        steps.addAction(ActionRecord(cycle, 1, i));
+        expected[cycle].push_back(i);
+    }
+
+    CHECK(steps.getActionCount() == 2000);
+    for (unsigned long cycle = 0; cycle <= 300; cycle++)
+    {
+        std::vector<int> got;
+        for (const ActionRecord &record : steps.getActionsForCycle(cycle))
+        {
+            CHECK(record.cycle == cycle);
+            got.push_back(record.answer);
+        }
+        auto want = expected.find(cycle);
+        CHECK(got == (want == expected.end() ? std::vector<int>() : want->second));
+    }
+}
+
+//////////////////////////////////////////            main            //////////////////////////////////////////
+
+int main()
+{
+    checkStepsRoundTrip();
+    checkResultsRoundTrip();
+    checkTruncatedBinary();
+    checkOutOfOrderIndex();
+    return Check::result("RecordingCheck");
+}
@@ -0,0 +1,146 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Check.h"
+#include "Snapshot.h"
+#include <climits>
+#include <cstdint>
+
+//////////////////////////////////////////      varint round trip     //////////////////////////////////////////
+
+// Signed values around zero, the one/two byte boundaries and the type limits come back as
+// written, and small magnitudes of either sign take a single byte
+static void checkVarints()
+{
+    const long signedValues[] = {0, -1, 1, 63, -64, 64, -65, 8191, -8192, INT_MAX, INT_MIN, LONG_MAX, LONG_MIN};
+    const unsigned long unsignedValues[] = {0, 127, 128, 16383, 16384, UINT_MAX, ULONG_MAX};
+
+    StateWriter writer;
+    for (long value : signedValues) writer.writeInt(value);
+    for (unsigned long value : unsignedValues) writer.writeUInt(value);
+    writer.writeBool(true);
+    writer.writeChar('\0');
+    writer.writePoint(Point(-3, 200, -1, 1, '@'));
+
+    StateReader reader(writer.data());
+    for (long value : signedValues) CHECK(reader.readInt() == value);
+    for (unsigned long value : unsignedValues) CHECK(reader.readUInt() == value);
+    CHECK(reader.readBool());
+    CHECK(reader.readChar() == '\0');
+    Point p = reader.readPoint();
+    CHECK(p.getX() == -3 && p.getY() == 200 && p.getSprite() == '@');
+    CHECK(reader.ok() && reader.atEnd());
+
+    for (long value : {0L, -1L, 63L, -64L})
+    {
+        StateWriter one;
+        one.writeInt(value);
+        CHECK(one.data().size() == 1);
+    }
+    StateWriter two;
+    two.writeInt(64);
+    CHECK(two.data().size() == 2);
+}
+
+//////////////////////////////////////////         short reads        //////////////////////////////////////////
+
+// Reading past the end, or a varint whose continuation bit runs off the buffer, fails the
+// reader and every later read returns zero
+static void checkShortReads()
+{
+    std::string empty;
+    StateReader past(empty);
+    CHECK(past.readInt() == 0);
+    CHECK(!past.ok());
+
+    std::string unterminated("\x80\x80", 2);
+    StateReader cut(unterminated);
+    CHECK(cut.readUInt() == 0);
+    CHECK(!cut.ok());
+
+    StateWriter writer;
+    writer.writeUInt(5);
+    writer.writeChar('a');
+    std::string bytes = writer.data();
+    StateReader after(bytes);
+    CHECK(after.readUInt() == 5);
+    CHECK(after.readChar() == 'a');
+    CHECK(after.readChar() == 0);
+    CHECK(!after.ok());
+    CHECK(after.readUInt() == 0);
+}
+
+// A count larger than the bytes left cannot describe a real list
+static void checkReadCount()
+{
+    StateWriter fits;
+    fits.writeUInt(3);
+    fits.writeBytes("abc");
+    StateReader ok(fits.data());
+    CHECK(ok.readCount() == 3);
+    CHECK(ok.ok());
+
+    StateWriter tooMany;
+    tooMany.writeUInt(4);
+    tooMany.writeBytes("abc");
+    StateReader bad(tooMany.data());
+    CHECK(bad.readCount() == 0);
+    CHECK(!bad.ok());
+}
+
+//////////////////////////////////////////           digests          //////////////////////////////////////////
+
+static void checkDigests()
+{
+    // FNV-1a reference values
+    CHECK(hashState("") == 14695981039346656037ULL);
+    CHECK(hashState("a") == 0xaf63dc4c8601ec8cULL);
+
+    StateDigest digest;
+    digest.add("players", std::string("\x01\x02", 2));
+    digest.add("room0", std::string("\x03", 1));
+    StateDigest same;
+    same.add("a", std::string("\x01\x02", 2));
+    same.add("b", std::string("\x03", 1));
+    CHECK(digest.combined() == same.combined());
+
+    // Swapping the parts between subsystems is a different state
+    StateDigest swapped;
+    swapped.add("players", std::string("\x03", 1));
+    swapped.add("room0", std::string("\x01\x02", 2));
+    CHECK(digest.combined() != swapped.combined());
+
+    StateDigest changed;
+    changed.add("players", std::string("\x01\x02", 2));
+    changed.add("room0", std::string("\x04", 1));
+    CHECK(digest.combined() != changed.combined());
+}
+
+//////////////////////////////////////////         hex helpers        //////////////////////////////////////////
+
+static void checkHex()
+{
+    std::string bytes("\x00\x0f\xf0\xff\n", 5);
+    std::string back;
+    CHECK(toHex(bytes) == "000ff0ff0a");
+    CHECK(fromHex(toHex(bytes), back) && back == bytes);
+    CHECK(fromHex("", back) && back.empty());
+    CHECK(!fromHex("abc", back));
+    CHECK(!fromHex("zz", back));
+
+    std::uint64_t value = 0;
+    CHECK(toHex64(0) == "0000000000000000");
+    CHECK(fromHex64(toHex64(UINT64_MAX), value) && value == UINT64_MAX);
+    CHECK(fromHex64(toHex64(0x0123456789abcdefULL), value) && value == 0x0123456789abcdefULL);
+}
+
+//////////////////////////////////////////            main            //////////////////////////////////////////
+
+int main()
+{
+    checkVarints();
+    checkShortReads();
+    checkReadCount();
+    checkDigests();
+    checkHex();
+    return Check::result("SnapshotCheck");
+}
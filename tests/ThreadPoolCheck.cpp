@@ -0,0 +1,78 @@
+//////////////////////////////////////       INCLUDES & FORWARDS       //////////////////////////////////////////
+
+#include "Check.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+//////////////////////////////////////////        every task          //////////////////////////////////////////
+
+// Each index runs exactly once per run, for empty, tiny and large batches, and a pool
+// serves run after run
+static void checkEveryTaskOnce(size_t threads)
+{
+    WorkStealingPool pool(threads);
+    CHECK(pool.getWorkerCount() == threads);
+
+    for (size_t count : {0, 1, 2, 3, 7, 64, 1000, 5})
+    {
+        std::unique_ptr<std::atomic<int>[]> runs(new std::atomic<int>[count + 1]);
+        for (size_t i = 0; i <= count; i++) runs[i] = 0;
+
+        pool.run(count, [&runs](size_t i) { runs[i]++; });
+
+        bool once = true;
+        for (size_t i = 0; i < count; i++) once = once && runs[i] == 1;
+        CHECK(once);
+        CHECK(runs[count] == 0);
+    }
+}
+
+//////////////////////////////////////////          stealing          //////////////////////////////////////////
+
+// The first task to start holds its worker until every other task is done, so the
+// tasks dealt to that worker can only finish by being stolen
+static void checkStealing()
+{
+    const size_t count = 40;
+    WorkStealingPool pool(2);
+    std::atomic<bool> started(false);
+    std::atomic<size_t> finished(0);
+    std::atomic<bool> timedOut(false);
+
+    pool.run(count, [&](size_t)
+    {
+        if (!started.exchange(true))
+        {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (finished < count - 1)
+            {
+                if (std::chrono::steady_clock::now() > deadline)
+                {
+                    timedOut = true;
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+        finished++;
+    });
+
+    CHECK(!timedOut);
+    CHECK(finished == count);
+}
+
+//////////////////////////////////////////            main            //////////////////////////////////////////
+
+int main()
+{
+    for (size_t threads : {1, 2, 8}) checkEveryTaskOnce(threads);
+    checkStealing();
+
+    WorkStealingPool automatic;
+    CHECK(automatic.getWorkerCount() >= 1);
+    return Check::result("ThreadPoolCheck");
+}
@@ -0,0 +1,27 @@
+#!/bin/sh
+# Replays the recordings in tests/recordings with -batch, then converts every steps and
+# result file to binary and back: the text written back must match the original byte for
+# byte, and the binary copies must replay as well.
+# Usage: tests/recordings.sh <game binary>
+set -e
+
+GAME=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+HERE=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+"$GAME" -batch "$HERE/recordings" -report "$WORK/text.json"
+
+mkdir "$WORK/binary"
+for dir in "$HERE"/recordings/*/; do
+    name=$(basename "$dir")
+    cp -R "$dir" "$WORK/binary/$name"
+    for file in adv-world.steps.txt adv-world.result.txt; do
+        "$GAME" -convert "$dir$file" "$WORK/binary/$name/$file" > /dev/null
+        "$GAME" -convert "$WORK/binary/$name/$file" "$WORK/$name.$file" > /dev/null
+        cmp "$dir$file" "$WORK/$name.$file"
+    done
+done
+
+"$GAME" -batch "$WORK/binary" -report "$WORK/binary.json"
+echo "recordings: ok"